@@ -25,6 +25,7 @@
 #include "model/PlaylistModel.h"
 #include "model/LibraryModel.h"
 #include "player/RemotePlaylist.h"
+#include "player/SongsDecoder.h"
 
 #include <QTcpSocket>
 #include <QDataStream>
@@ -32,7 +33,10 @@
 #include <QDir>
 #include <QUrl>
 #include <QElapsedTimer>
+#include <QSet>
+#include <QDateTime>
 #include <QSqlQuery>
+#include <QGuiApplication>
 
 #if defined(Q_OS_ANDROID)
 #include <QtAndroid>
@@ -49,7 +53,7 @@ const QString ClementineRemote::sClementineReleaseURL = QStringLiteral("https://
 const QPair<ushort, ushort> ClementineRemote::sClemFilesSupportMinVersion = {1, 4};
 
 const QString ClementineRemote::sLibrarySQL =
-        QStringLiteral("select artist, album, title, track, filename from songs order by artist, album, track, title");
+        QStringLiteral("select artist, albumartist, album, genre, year, track, title, filename from songs order by artist, album, track, title");
 
 const QMap<pb::remote::RepeatMode, ushort> ClementineRemote::sQmlRepeatCodes = {
     {pb::remote::RepeatMode::Repeat_Off,      0},
@@ -76,6 +80,11 @@ const QMap<ClementineRemote::Settings, QString> ClementineRemote::sSettings = {
     {Settings::iconSize,              QStringLiteral("iconSize")},
     {Settings::dispArtistInTrackName, QStringLiteral("dispArtistInTrackName")},
     {Settings::delayLibraryLoading,   QStringLiteral("delayLibraryLoading")},
+    {Settings::playlistsCacheSizeMB,  QStringLiteral("playlistsCacheSizeMB")},
+    {Settings::trackPositionIntervalMs, QStringLiteral("trackPositionIntervalMs")},
+    {Settings::speculativeConnect,    QStringLiteral("speculativeConnect")},
+    {Settings::memoryThresholdMB,     QStringLiteral("memoryThresholdMB")},
+    {Settings::libraryHierarchy,      QStringLiteral("libraryHierarchy")},
 };
 
 
@@ -86,7 +95,7 @@ ClementineRemote::ClementineRemote(QObject *parent):
 #ifdef __USE_CONNECTION_THREAD__
     _thread(),
 #endif
-    _connection(new ConnectionWorker(this)),
+    _connection(nullptr),
     #if defined( Q_OS_WIN )
     _settings("clemRemote.ini", QSettings::Format::IniFormat),
     #else
@@ -96,21 +105,32 @@ ClementineRemote::ClementineRemote(QObject *parent):
     _musicExtensions(), _volume(0),
     _downloadsAllowed(true), _downloadPath(),
     _shuffleMode(pb::remote::Shuffle_Off), _repeatMode(pb::remote::Repeat_Off),
+    _pendingOps(), _pendingOpsTimer(),
     _playlistsOpened(), _playlistsClosed(),
 #ifdef __USE_CONNECTION_THREAD__
     _securePlaylists(), _playlistData(),
 #endif
-    _dispPlaylist(nullptr), _dispPlaylistId(0), _dispPlaylistIndex(0),
+    _dispPlaylistId(0), _dispPlaylistIndex(-1), _openedPlaylistRows(), _playingPlaylistId(-1),
     _plOpenedModel(new PlaylistModel(this, false)), _plClosedModel(new PlaylistModel(this, true)),
-    _songs(), _activeSong(), _activeSongIndex(0),
+    _songs(), _songsIndex(), _songsSorter(), _activeSong(), _activeSongIndex(0),
 #ifdef __USE_CONNECTION_THREAD__
     _secureSongs(), _songsData(),
 #endif
     _songsModel(new RemoteSongModel),
     _songsProxyModel(new RemoteSongProxyModel),
+    _playlistsCache(), _pagedSongs(),
+    _playlistsSearch(), _playlistsSearchModel(new PlaylistsSearchModel),
+    _searchHitPlaylistID(-1), _searchHitSongID(-1), _searchHitRow(-1),
+    _pagedSongsSupport(true),
+    _songDetailsPlaylistID(-1), _songDetailsIndex(-1), _dispSongsRevision(-1), _songsPlaylistId(-1),
     _activePlaylistId(-1), _requestSongsForPlaylistID(-1),
-    _trackPostition(0),
-    _initialized(false),
+    _trackPostition(0), _playbackClock(),
+    _lowPower(0x0), _powerModeTime(), _powerModeReadyReads(0),
+#ifdef __USE_CONNECTION_THREAD__
+    _secureDeferred(),
+#endif
+    _deferredPlaylists(), _deferredSongs(), _playlistsToResync(),
+    _initialized(0x0), _resuming(0x0), _resumeAccepted(0x0), _reconnectTime(),
     _clemFilesSupport(false),
     _remoteFilesPath("./"),
     _remoteFiles(),
@@ -130,20 +150,86 @@ ClementineRemote::ClementineRemote(QObject *parent):
     _libraryPath(QFileInfo(_settings.fileName()).absolutePath()),
 #endif
     _libDB(), _libModel(new LibraryModel), _libProxyModel(new LibraryProxyModel),
+    _globalSearchModel(new GlobalSearchModel),
+#ifdef __USE_CONNECTION_THREAD__
+    _secureGlobalSearch(), _globalSearchData(),
+#endif
 #ifdef __USE_CONNECTION_THREAD__
     _secureUserMsg(),
 #endif
     _userMsg(),
     _forceRePlayActiveSong(false),
-    _sessionsSaved(), _sessionSelected(0),
-    _libraryLoaded(false)
+    _sessionsSaved(), _sessionSelected(0), _discovery(),
+    _launchTime(), _connectTime(), _speculativeSession(nullptr), _uiAttached(false), _timeToInteractiveMs(-1),
+    _backgroundSessions(), _switchTime(),
+    _memoryLogTimer(), _memoryPressure(), _updates(),
+    _libraryLoaded(false), _libraryShed(false)
 {
+    _launchTime.start();
     setObjectName(sAppName);
+    _connection = newConnection();
 
     _songsModel->setRemote(this);
+    _playlistsSearchModel->setRemote(this);
     _songsProxyModel->setSourceModel(_songsModel);
+    _libModel->setHierarchy(static_cast<LibraryTable::Hierarchy>(
+                qBound(0, _settings.value(sSettings[Settings::libraryHierarchy], 0).toInt(),
+                       static_cast<int>(LibraryTable::Hierarchy::nbHierarchies) - 1)));
     _libProxyModel->setSourceModel(_libModel);
 
+    _playlistsCache.setMaxSizeMB(_settings.value(sSettings[Settings::playlistsCacheSizeMB],
+                                                 PlaylistSongsCache::sDefaultMaxSizeMB).toInt());
+    connect(this, &ClementineRemote::changePlaylist, this, &ClementineRemote::onChangePlaylist);
+
+    // optimistic display of the user requests (the ConnectionWorker sends them)
+    connect(this, &ClementineRemote::shuffle,      this, &ClementineRemote::onShuffleRequested);
+    connect(this, &ClementineRemote::repeat,       this, &ClementineRemote::onRepeatRequested);
+    connect(this, &ClementineRemote::nextSong,     this, &ClementineRemote::onNextSongRequested);
+    connect(this, &ClementineRemote::previousSong, this, &ClementineRemote::onPreviousSongRequested);
+    _pendingOpsTimer.setInterval(PendingOperations::sTimeoutMs / 4);
+    connect(&_pendingOpsTimer, &QTimer::timeout, this, &ClementineRemote::onCheckPendingOperations);
+
+    // the PlaybackClock lives in the GUI Thread (queued when emitted by the ConnectionWorker)
+    connect(this, &ClementineRemote::trackPositionReceived, this, &ClementineRemote::onTrackPositionReceived);
+    connect(this, &ClementineRemote::updateEngineState, this, [this](){
+        _playbackClock.setPlaying(isPlaying());
+    });
+    connect(this, &ClementineRemote::setTrackPostion, this, [this](qint32 newPos){
+        _playbackClock.reset(static_cast<qint64>(newPos) * 1000);
+    });
+
+    _powerModeTime.start();
+    if (qGuiApp)
+        connect(qGuiApp, &QGuiApplication::applicationStateChanged,
+                this, &ClementineRemote::onApplicationStateChanged);
+    // edited playlists will be sent back by the server, no need to keep them meanwhile
+    connect(this, &ClementineRemote::clearPlaylist, this, [this](qint32 playlistID){
+        _playlistsCache.remove(playlistID);
+        _playlistsSearch.remove(playlistID);
+    });
+    connect(this, &ClementineRemote::closePlaylist, this, [this](qint32 playlistID){
+        _playlistsCache.remove(playlistID);
+        _playlistsSearch.remove(playlistID);
+    });
+    connect(this, &ClementineRemote::insertUrls, this, [this](qint32 playlistID, const QString &){
+        _playlistsCache.remove(playlistID);
+    });
+
+    connect(this, &ClementineRemote::sessionResumed, this, &ClementineRemote::onSessionResumed);
+
+    connect(&_memoryLogTimer, &QTimer::timeout, this, [this](){
+        qInfo().noquote() << "[ClementineRemote::memoryReport]\n" << memoryReportStr();
+    });
+    connect(&_memoryPressure, &MemoryPressure::shed, this, &ClementineRemote::onShedMemory);
+    _memoryPressure.setThresholdMB(_settings.value(sSettings[Settings::memoryThresholdMB],
+                                                   sDefaultMemoryThresholdMB).toInt());
+
+    connect(&_discovery, &ServerDiscovery::serverFound, this, &ClementineRemote::onServerFound);
+    connect(&_discovery, &ServerDiscovery::finished, this, [this](int nbServers, qint64 elapsedMs){
+        qDebug() << "[ClementineRemote::discoverServers] " << nbServers << " server(s) found in " << elapsedMs << " ms";
+        emit discoveryFinished(nbServers);
+    });
+
 #ifdef __USE_CONNECTION_THREAD__
     connect(this, &ClementineRemote::initialized,
             this, &ClementineRemote::onInitialized, Qt::QueuedConnection);
@@ -151,9 +237,12 @@ ClementineRemote::ClementineRemote(QObject *parent):
             this, &ClementineRemote::onPlaylistsOpenedUpdatedByWorker, Qt::QueuedConnection);
     connect(this, &ClementineRemote::songsUpdatedByWorker,
             this, &ClementineRemote::onSongsUpdatedByWorker, Qt::QueuedConnection);
+    connect(this, &ClementineRemote::playlistDeltaByWorker,
+            this, &ClementineRemote::onPlaylistDeltaByWorker, Qt::QueuedConnection);
     connect(this, &ClementineRemote::remoteFilesUpdatedByWorker,
             this, &ClementineRemote::onRemoteFilesUpdatedByWorker, Qt::QueuedConnection);
-    _connection->moveToThread(&_thread);
+    connect(this, &ClementineRemote::globalSearchByWorker,
+            this, &ClementineRemote::onGlobalSearchByWorker, Qt::QueuedConnection);
     _thread.start();
     _thread.setObjectName("ConnectionWorkerThread");
 #endif
@@ -189,6 +278,47 @@ ClementineRemote::ClementineRemote(QObject *parent):
     if (!_settings.contains(sSettings[Settings::verticalVolume]))
         setVerticalVolumeSlider(true);
 #endif
+
+    if (speculativeConnect())
+        startSpeculativeConnection();
+}
+
+void ClementineRemote::startSpeculativeConnection()
+{
+    ClementineSession *session = _sessionsSaved.at(_sessionSelected);
+    if (session->host().isEmpty() || session->host().endsWith('.'))
+        return; // default Quick Session
+
+    qDebug() << "[ClementineRemote::startSpeculativeConnection] " << session->str()
+             << " after " << _launchTime.elapsed() << " ms";
+    _speculativeSession = session;
+    setRemotePathForHost();
+    _connectTime.start();
+    emit _connection->connectToServer(session);
+}
+
+void ClementineRemote::attachUI()
+{
+    qDebug() << "[ClementineRemote::attachUI] after " << _launchTime.elapsed() << " ms"
+             << (M_LoadAtomic(_initialized) ? " (already connected)" : "");
+    _uiAttached = true;
+    if (M_LoadAtomic(_initialized))
+        notifyConnected(); // speculative connection faster than QML
+}
+
+void ClementineRemote::notifyConnected()
+{
+    if (!_uiAttached)
+    {
+        qDebug() << "[ClementineRemote::notifyConnected] buffered until the UI is loaded";
+        return;
+    }
+
+    _timeToInteractiveMs = _speculativeSession ? _launchTime.elapsed() : _connectTime.elapsed();
+    qDebug() << "[ClementineRemote::notifyConnected] time to interactive: " << _timeToInteractiveMs
+             << " ms (" << (_speculativeSession ? "since launch, speculative connection" : "since connection request")
+             << ", launch: " << _launchTime.elapsed() << " ms)";
+    emit connected();
 }
 
 ClementineRemote::~ClementineRemote()
@@ -219,21 +349,24 @@ void ClementineRemote::close()
 {
     qDebug() << "[MB_TRACE] close ClementineRemote";
     saveSessions();
+    _memoryLogTimer.stop();
 
 #ifdef __USE_CONNECTION_THREAD__
     emit _connection->killSocket();
+    for (ConnectionWorker *worker : _backgroundSessions)
+        emit worker->killSocket();
     _thread.quit();
     _thread.wait();
 #endif
+    qDeleteAll(_backgroundSessions);
+    _backgroundSessions.clear();
 
-    qDeleteAll(_playlistsOpened);
     _playlistsOpened.clear();
     if (_plOpenedModel)
     {
         delete _plOpenedModel;
         _plOpenedModel = nullptr;
     }
-    qDeleteAll(_playlistsClosed);
     _playlistsClosed.clear();
     if (_plClosedModel)
     {
@@ -247,6 +380,11 @@ void ClementineRemote::close()
         delete _songsProxyModel;
         _songsProxyModel = nullptr;
     }
+    if (_playlistsSearchModel)
+    {
+        delete _playlistsSearchModel;
+        _playlistsSearchModel = nullptr;
+    }
     if (_libModel)
     {
         delete _libModel;
@@ -254,6 +392,11 @@ void ClementineRemote::close()
         delete _libProxyModel;
         _libProxyModel = nullptr;
     }
+    if (_globalSearchModel)
+    {
+        delete _globalSearchModel;
+        _globalSearchModel = nullptr;
+    }
     if (_connection)
     {
         delete _connection;
@@ -264,22 +407,50 @@ void ClementineRemote::close()
 void ClementineRemote::clearData(const QString &reason)
 {
     emit disconnected(reason); // Update QML view to Login Page
+    resetSessionData();
+}
 
-    _initialized = false;
+void ClementineRemote::resetSessionData()
+{
+    _initialized = 0x0;
+    _resuming = 0x0;
     _forceRePlayActiveSong = false;
 
-    qDeleteAll(_playlistsOpened);
     _playlistsOpened.clear();
-
-    qDeleteAll(_playlistsClosed);
     _playlistsClosed.clear();
+    _openedPlaylistRows.clear();
+    _playingPlaylistId = -1;
 
-
-    _dispPlaylist = nullptr;
     _dispPlaylistId = 0;
-    _dispPlaylistIndex = 0;
+    _dispPlaylistIndex = -1;
 
     _songs.clear();
+    invalidateSongsIndexes();
+    _playlistsCache.clear();
+    _playlistsSearch.clear();
+    _playlistsSearchModel->setHits({});
+    _searchHitPlaylistID = -1;
+    _searchHitSongID     = -1;
+    _searchHitRow        = -1;
+    _pagedSongs.clear();
+    _pagedSongsSupport = true;
+    _songDetailsPlaylistID = -1;
+    _songDetailsIndex = -1;
+    _dispSongsRevision = -1;
+    _songsPlaylistId = -1;
+
+    qDebug() << "[ClementineRemote::clearData] optimistic updates: " << _pendingOps.stats();
+    _pendingOps.clear();
+    _pendingOpsTimer.stop();
+    {
+#ifdef __USE_CONNECTION_THREAD__
+        QMutexLocker lock(&_secureDeferred);
+#endif
+        _deferredPlaylists.Clear();
+        _deferredSongs.clear();
+        _playlistsToResync.clear();
+    }
+    _songsProxyModel->showHiddenSongs();
 
     _activeSongIndex = 0;
     _activePlaylistId = 0;
@@ -290,6 +461,10 @@ void ClementineRemote::clearData(const QString &reason)
     _libModel->clear();
     _libDB.close();
     _libraryLoaded = false;
+    _libraryShed   = false;
+
+    _globalSearchModel->clear();
+    _globalSearchModel->forgetStaleIds();
 
     _isDownloading = 0x0;    
 }
@@ -401,13 +576,18 @@ void ClementineRemote::checkClementineVersion()
 }
 
 
-void ClementineRemote::parseMessage(const QByteArray &data)
+void ClementineRemote::parseMessage(const QByteArray &data, SessionStore *store)
 {
+    M_TRACE_SCOPE("ClementineRemote::parseMessage");
+    QElapsedTimer parseTime;
+    parseTime.start();
     pb::remote::Message msg;
     if (!msg.ParseFromArray(data.constData(), data.size())) {
         qCritical() << "Couldn't parse data";
         return;
     }
+    if (store)
+        store->record(msg, data); // to switch back instantly to this session (not via _connection: GUI thread)
 
     pb::remote::MsgType msgType = msg.type();
     switch (msgType) {
@@ -419,14 +599,15 @@ void ClementineRemote::parseMessage(const QByteArray &data)
     case pb::remote::DISCONNECT:
         _connection->setDisconnectReason(disconnectReason(msg.response_disconnect().reason_disconnect()));
         qDebug() << "[MsgType::DISCONNECT]" << _connection->disconnectReason();
+        _connection->setReconnectAllowed(false); // kicked or wrong auth code: no need to insist
         break;
 
     case pb::remote::INFO:
-        _clemVersion = msg.response_clementine_info().version().c_str();
+        _clemVersion = Utf8::toQString(msg.response_clementine_info().version());
         _clemState   = msg.response_clementine_info().state();
         _musicExtensions.clear();
         for (const auto& ext : msg.response_clementine_info().files_music_extensions())
-            _musicExtensions << QString(ext.c_str());
+            _musicExtensions << Utf8::toQString(ext);
 
         if (msg.response_clementine_info().has_allow_downloads())
             _downloadsAllowed = msg.response_clementine_info().allow_downloads();
@@ -445,18 +626,29 @@ void ClementineRemote::parseMessage(const QByteArray &data)
         break;
 
     case pb::remote::SET_VOLUME:
-        _volume = msg.request_set_volume().volume();
-        qDebug() << "[MsgType::SET_VOLUME] " << _volume;
-        emit updateVolume(_volume);
+    {
+        qint32 volume = msg.request_set_volume().volume();
+        PendingOperations::Echo echo = _pendingOps.reconcile(PendingOperations::Type::volume, volume);
+        qDebug() << "[MsgType::SET_VOLUME] " << volume << " (echo: " << static_cast<ushort>(echo) << ")";
+        if (echo == PendingOperations::Echo::unsolicited || echo == PendingOperations::Echo::diverged)
+        {
+            _volume = volume;
+            emit updateVolume(_volume);
+        }
         break;
+    }
 
     case pb::remote::UPDATE_TRACK_POSITION:
         _trackPostition = msg.response_update_track_position().position();
-        emit activeTrackPosition(_trackPostition);
+        if (M_LoadAtomic(_lowPower))
+            break; // nobody is watching
+        emit trackPositionReceived(_trackPostition);
         qDebug() << "[MsgType::UPDATE_TRACK_POSITION] " << _trackPostition;
         break;
 
     case pb::remote::PLAYLISTS:
+        if (deferInLowPower(msg))
+            break;
 #ifdef __USE_CONNECTION_THREAD__
         _securePlaylists.lock();
         _playlistData = std::move(msg);
@@ -467,40 +659,85 @@ void ClementineRemote::parseMessage(const QByteArray &data)
         break;
 
     case pb::remote::PLAYLIST_SONGS:
+        qDebug() << "[MsgType::PLAYLIST_SONGS] payload: " << data.size() << " bytes, parsed in "
+                 << parseTime.nsecsElapsed() / 1000 << " us";
+        if (deferInLowPower(msg))
+            break;
 #ifdef __USE_CONNECTION_THREAD__
         _secureSongs.lock();
         _songsData = std::move(msg);
-        emit songsUpdatedByWorker(_initialized);
+        emit songsUpdatedByWorker(M_LoadAtomic(_initialized));
 #else
         rcvPlaylistSongs(msg.response_playlist_songs());
-        if (!_initialized)
+        if (!M_LoadAtomic(_initialized))
             updateActivePlaylist();
 #endif
         break;
 
+    case pb::remote::PLAYLIST_DELTA:
+        if (deferInLowPower(msg))
+            break;
+#ifdef __USE_CONNECTION_THREAD__
+        _secureSongs.lock(); // keep the order with PLAYLIST_SONGS
+        _songsData = std::move(msg);
+        emit playlistDeltaByWorker();
+#else
+        rcvPlaylistDelta(msg.response_playlist_delta());
+#endif
+        break;
+
     case pb::remote::SHUFFLE:
-        _shuffleMode = msg.shuffle().shuffle_mode();
-        qDebug() << "[MsgType::SHUFFLE] " << _shuffleMode;
-        emit updateShuffle(sQmlShuffleCodes.value(_shuffleMode));
+    {
+        PendingOperations::Echo echo = _pendingOps.reconcile(
+                    PendingOperations::Type::shuffle, sQmlShuffleCodes.value(msg.shuffle().shuffle_mode()));
+        qDebug() << "[MsgType::SHUFFLE] " << msg.shuffle().shuffle_mode() << " (echo: " << static_cast<ushort>(echo) << ")";
+        if (echo == PendingOperations::Echo::unsolicited || echo == PendingOperations::Echo::diverged)
+        {
+            _shuffleMode = msg.shuffle().shuffle_mode();
+            emit updateShuffle(sQmlShuffleCodes.value(_shuffleMode));
+        }
         break;
+    }
 
     case pb::remote::REPEAT:
-        _repeatMode = msg.repeat().repeat_mode();
-        qDebug() << "[MsgType::REPEAT] " << _repeatMode;
-        emit updateRepeat(sQmlRepeatCodes.value(_repeatMode));
+    {
+        PendingOperations::Echo echo = _pendingOps.reconcile(
+                    PendingOperations::Type::repeat, sQmlRepeatCodes.value(msg.repeat().repeat_mode()));
+        qDebug() << "[MsgType::REPEAT] " << msg.repeat().repeat_mode() << " (echo: " << static_cast<ushort>(echo) << ")";
+        if (echo == PendingOperations::Echo::unsolicited || echo == PendingOperations::Echo::diverged)
+        {
+            _repeatMode = msg.repeat().repeat_mode();
+            emit updateRepeat(sQmlRepeatCodes.value(_repeatMode));
+        }
+        break;
+    }
+
+    case pb::remote::SESSION_TOKEN:
+        qDebug() << "[MsgType::SESSION_TOKEN] resumed: " << msg.response_session_token().resumed();
+        _connection->setResumeToken(msg.response_session_token().token());
+        _resumeAccepted = msg.response_session_token().resumed() ? 0x1 : 0x0;
+        _connection->resetReconnectAttempts();
         break;
 
     case pb::remote::FIRST_DATA_SENT_COMPLETE:
-        if (_initialized)
-            return; // it's for another remote        
+        _connection->resetReconnectAttempts();
+        if (M_LoadAtomic(_initialized))
+        {
+            if (M_LoadAtomic(_resuming))
+                emit sessionResumed();
+            return; // otherwise it's for another remote
+        }
+        _connection->setReconnectAllowed(true);
 #ifdef __USE_CONNECTION_THREAD__
         emit initialized();
 #else
-        _initialized = true;
+        _initialized = 0x1;
         qDebug() << "[MsgType::FIRST_DATA_SENT_COMPLETE] fully Initialized \\o/";
-        emit connected();
+        notifyConnected();
         if (!delayLibraryLoading())
             requestLibrary();
+        if (trackPositionIntervalMs() != sDefaultTrackPositionIntervalMs)
+            emit requestTrackPositionInterval(trackPositionIntervalMs());
 #endif
         if (_clemFilesSupport)
             _connection->requestSavedRadios();
@@ -508,8 +745,7 @@ void ClementineRemote::parseMessage(const QByteArray &data)
 
     case pb::remote::PLAY:
         qDebug() << "[MsgType::PLAY]";
-        _clemState = pb::remote::EngineState::Playing;
-        emit updateEngineState();
+        rcvEngineState(pb::remote::EngineState::Playing);
         if (_forceRePlayActiveSong)
         {
             // Hack to make sure last played song will be played
@@ -523,14 +759,12 @@ void ClementineRemote::parseMessage(const QByteArray &data)
         break;
     case pb::remote::PAUSE:
         qDebug() << "[MsgType::PAUSE]";
-        _clemState = pb::remote::EngineState::Paused;
-        emit updateEngineState();
+        rcvEngineState(pb::remote::EngineState::Paused);
         break;
 
     case pb::remote::STOP:
         qDebug() << "[MsgType::STOP]";
-        _clemState = pb::remote::EngineState::Idle;
-        emit updateEngineState();
+        rcvEngineState(pb::remote::EngineState::Idle);
         break;
 
     case pb::remote::ACTIVE_PLAYLIST_CHANGED:
@@ -567,6 +801,20 @@ void ClementineRemote::parseMessage(const QByteArray &data)
         _connection->downloadLibrary(msg.response_library_chunk());
         break;
 
+    case pb::remote::GLOBAL_SEARCH_RESULT:
+    case pb::remote::GLOBAL_SEARCH_STATUS:
+#ifdef __USE_CONNECTION_THREAD__
+        _secureGlobalSearch.lock();
+        _globalSearchData = std::move(msg);
+        emit globalSearchByWorker();
+#else
+        if (msgType == pb::remote::GLOBAL_SEARCH_RESULT)
+            rcvGlobalSearch(msg.response_global_search());
+        else
+            rcvGlobalSearchStatus(msg.response_global_search_status());
+#endif
+        break;
+
     default:
         qDebug() << "Msg type not yet implemented: " << msgType;
         break;
@@ -647,7 +895,7 @@ void ClementineRemote::downloadLibraryItem(const QModelIndex &proxyIndex)
         return;
     }
     int itemType = _libProxyModel->data(proxyIndex, LibraryModel::type).toInt();
-    if (itemType == LibraryModel::Artist)
+    if (itemType == LibraryModel::Artist || itemType == LibraryModel::Genre || itemType == LibraryModel::Year)
     {
         sendError("", tr("You can't add an Artist directly.<br/> Please select either a single Track or an Album"));
         return;
@@ -695,19 +943,78 @@ void ClementineRemote::requestLibrary()
 {
     if (_libraryLoaded)
         return;
-    if (_sessionSelected > 0 // We force redownload for Quick Session
+    if ((_sessionSelected > 0 || _libraryShed) // We force redownload for Quick Session
             && QFileInfo(QString("%1/%2.db").arg(_libraryPath).arg(sessionName())).exists())
         emit libraryDownloaded();
     else
         getLibrary();
 }
 
+void ClementineRemote::setLibraryHierarchy(int hierarchy)
+{
+    if (hierarchy < 0 || hierarchy >= static_cast<int>(LibraryTable::Hierarchy::nbHierarchies))
+        return;
+    M_TRACE_SCOPE("ClementineRemote::setLibraryHierarchy");
+    QElapsedTimer switchTime;
+    switchTime.start();
+    _libModel->setHierarchy(static_cast<LibraryTable::Hierarchy>(hierarchy));
+    _settings.setValue(sSettings[Settings::libraryHierarchy], hierarchy);
+    qDebug() << "[ClementineRemote::setLibraryHierarchy] " << hierarchy << " in " << switchTime.elapsed() << " ms";
+}
+
+
+////////////////////////////////
+/// Global Search methods
+////////////////////////////////
+
+void ClementineRemote::globalSearch(const QString &query)
+{
+    QString trimmedQuery = query.trimmed();
+    if (trimmedQuery == _globalSearchModel->query())
+        return;
+
+    // Clementine can't cancel a search: the results of the previous ones are dropped when received
+    if (trimmedQuery.size() < sGlobalSearchMinLength)
+    {
+        _globalSearchModel->clear();
+        emit globalSearchStatus(false);
+        return;
+    }
+    qDebug() << "[ClementineRemote::globalSearch] " << trimmedQuery;
+    _globalSearchModel->start(trimmedQuery);
+    emit requestGlobalSearch(trimmedQuery);
+    emit globalSearchStatus(true);
+}
+
+void ClementineRemote::appendGlobalSearchResult(int row, const QString &newPlaylistName)
+{
+    const RemoteSong *song = _globalSearchModel->song(row);
+    if (!song)
+    {
+        sendError(tr("Nothing selected"), tr("Select a search result"));
+        return;
+    }
+    lockUserMutex();
+    _userMsg.Clear();
+    _userMsg.set_type(pb::remote::INSERT_URLS);
+    pb::remote::RequestInsertUrls *req = _userMsg.mutable_request_insert_urls();
+    *req->add_urls() = song->url.toStdString();
+    qDebug() << "Global search result activated: " << song->url;
+    emit insertUrls(_dispPlaylistId, newPlaylistName);
+    sendInfo("", tr("the track %1 has been added to the playlist %2").arg(
+                 song->title).arg(
+                 newPlaylistName.isEmpty() ? playlistName() : newPlaylistName));
+}
+
 
 ////////////////////////////////
 /// QML getter/setters
 ////////////////////////////////
 
-bool ClementineRemote::isConnected() const { return _connection->isConnected(); }
+bool ClementineRemote::isConnected() const
+{
+    return _connection->isConnected() || _connection->isReconnecting();
+}
 void ClementineRemote::cancelDownload() const { _connection->cancelDownload(); }
 
 QString ClementineRemote::hostname() const
@@ -750,8 +1057,30 @@ ClementineSession *ClementineRemote::getSession(int index)
 
 void ClementineRemote::tryConnectToServer(int sessionIndex, const QString &host, ushort port, int auth_code)
 {
-    _sessionSelected = sessionIndex;
+    stopDiscovery(); // no more probes on the server port while we connect
+
+    if (_backgroundSessions.contains(_sessionsSaved.at(sessionIndex)))
+    {
+        switchToSession(sessionIndex); // still connected
+        return;
+    }
+
     ClementineSession *session = _sessionsSaved.at(sessionIndex);
+    if (_connection->isConnected())
+    {   // the speculative connection is still ongoing
+        if (session == _speculativeSession && (sessionIndex != 0 ||
+                (session->host() == host && session->port() == port && session->pass() == auth_code)))
+        {
+            qDebug() << "[ClementineRemote::tryConnectToServer] already connecting to " << session->str();
+            return;
+        }
+        emit _connection->killSocket();
+        _initialized = 0x0;
+    }
+    _speculativeSession = nullptr;
+    _connectTime.start();
+
+    _sessionSelected = sessionIndex;
     if (sessionIndex == 0)
     {
         session->setHost(host);
@@ -762,6 +1091,325 @@ void ClementineRemote::tryConnectToServer(int sessionIndex, const QString &host,
     emit _connection->connectToServer(session);
 }
 
+ConnectionWorker *ClementineRemote::newConnection()
+{
+    ConnectionWorker *worker = new ConnectionWorker(this);
+    connect(worker, &ConnectionWorker::backgroundSessionClosed, this, [this, worker](){
+        ClementineSession *session = _backgroundSessions.key(worker, nullptr);
+        qDebug() << "[ClementineRemote] background session closed: " << (session ? session->name() : QString());
+        if (session)
+            _backgroundSessions.remove(session);
+        if (worker != _connection) // else switched back to it in the meantime: activate connects it again
+            worker->deleteLater();
+    });
+#ifdef __USE_CONNECTION_THREAD__
+    worker->moveToThread(&_thread);
+#endif
+    return worker;
+}
+
+void ClementineRemote::switchToSession(int sessionIndex)
+{
+    if (sessionIndex < 0 || sessionIndex >= _sessionsSaved.size()
+            || (sessionIndex == _sessionSelected && M_LoadAtomic(_initialized)))
+        return;
+
+    ClementineSession *current = _sessionsSaved.at(_sessionSelected);
+    ClementineSession *target  = _sessionsSaved.at(sessionIndex);
+    ConnectionWorker  *worker  = _connection;
+    bool keepCurrent = M_LoadAtomic(_initialized) && !_backgroundSessions.contains(current);
+    qDebug() << "[ClementineRemote::switchToSession] from " << current->name() << " to " << target->name()
+             << (keepCurrent ? " (keeping the current one in background)" : "");
+
+    _switchTime.start();
+    worker->detachFromRemote();
+    if (keepCurrent)
+        _backgroundSessions.insert(current, worker);
+    _sessionSelected = sessionIndex;
+
+    // in the thread of the worker so it's not parsing anymore when we reset the data
+    QMetaObject::invokeMethod(worker, [this, worker, keepCurrent, target](){
+        ConnectionWorker *closedWorker = nullptr;
+        if (keepCurrent)
+            worker->park();
+        else
+        {
+            worker->setReconnectAllowed(false);
+            worker->onKillSocket();
+            closedWorker = worker; // deleted once _connection doesn't point to it anymore
+        }
+        QMetaObject::invokeMethod(this, [this, target, closedWorker](){
+            finishSwitchToSession(target, closedWorker);
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void ClementineRemote::finishSwitchToSession(ClementineSession *target, ConnectionWorker *closedWorker)
+{
+    // the Views are still there
+    int nbSongs = numberOfPlaylistSongs();
+    if (nbSongs)
+    {
+        emit preClearSongs(nbSongs - 1);
+        _songs.clear();
+        invalidateSongsIndexes();
+        _pagedSongs.clear();
+        emit postSongRemoved();
+    }
+    if (_playlistsOpened.size())
+    {
+        emit _plOpenedModel->preClearPlaylists(_playlistsOpened.size() - 1);
+        _playlistsOpened.clear();
+        _openedPlaylistRows.clear();
+        emit _plOpenedModel->postClearPlaylists();
+    }
+    if (_playlistsClosed.size())
+    {
+        emit _plClosedModel->preClearPlaylists(_playlistsClosed.size() - 1);
+        _playlistsClosed.clear();
+        emit _plClosedModel->postClearPlaylists();
+    }
+    resetSessionData();
+    setRemotePathForHost();
+
+    ConnectionWorker *worker = _backgroundSessions.take(target);
+    if (worker)
+    {
+        _connection = worker;
+        worker->attachToRemote();
+        int intervalMs = isLowPowerMode() ? 0 : trackPositionIntervalMs();
+        QMetaObject::invokeMethod(worker, [worker, intervalMs](){ worker->activate(intervalMs); },
+                                  Qt::QueuedConnection);
+    }
+    else
+    {
+        _connection = newConnection();
+        _connectTime.start();
+        emit _connection->connectToServer(target);
+    }
+    if (closedWorker)
+        closedWorker->deleteLater(); // in its thread
+    qDebug() << "[ClementineRemote::finishSwitchToSession] " << target->name() << " after "
+             << _switchTime.elapsed() << " ms (" << (worker ? "replay" : "connection") << " ongoing)";
+}
+
+QStringList ClementineRemote::connectedSessions() const
+{
+    QStringList sessions;
+    if (M_LoadAtomic(_initialized))
+        sessions << _sessionsSaved.at(_sessionSelected)->name();
+    for (ClementineSession *session : _backgroundSessions.keys())
+        sessions << session->name();
+    return sessions;
+}
+
+QString ClementineRemote::sessionsReport() const
+{
+    QString report = QString("%1 session(s) on 1 thread, ConnectionWorker: %2 bytes").arg(
+                _backgroundSessions.size() + (M_LoadAtomic(_initialized) ? 1 : 0)).arg(sizeof(ConnectionWorker));
+    if (M_LoadAtomic(_initialized))
+        report += QString("\n  - %1 (displayed): store of %2 kB").arg(
+                    _sessionsSaved.at(_sessionSelected)->name()).arg(_connection->store().memoryUsage() / 1024);
+    for (auto it = _backgroundSessions.cbegin(); it != _backgroundSessions.cend(); ++it)
+        report += QString("\n  - %1: store of %2 kB").arg(it.key()->name()).arg(it.value()->store().memoryUsage() / 1024);
+    return report;
+}
+
+QList<ClementineRemote::MemoryAccount> ClementineRemote::memoryAccounts()
+{
+    QList<MemoryAccount> accounts;
+
+    // album art apart from the rest of the songs
+    qint64 songsBytes = 0, artBytes = 0;
+    int nbArts = 0;
+    auto accountSong = [&songsBytes, &artBytes, &nbArts](const RemoteSong &song){
+        qint64 bytes = song.memoryUsage();
+        if (!song.artData.isEmpty())
+        {
+            qint64 songArtBytes = song.artData.capacity();
+            artBytes += songArtBytes;
+            bytes    -= songArtBytes;
+            ++nbArts;
+        }
+        songsBytes += bytes;
+    };
+    for (const RemoteSong &song : qAsConst(_songs))
+        accountSong(song);
+    accountSong(_activeSong);
+    accounts << MemoryAccount{"playlist songs", songsBytes, _songs.size()}
+             << MemoryAccount{"album art", artBytes, nbArts}
+             << MemoryAccount{"songs index", _songsIndex.memoryUsage(), _songsIndex.isValid() ? _songs.size() : 0}
+             << MemoryAccount{"songs sort", _songsSorter.memoryUsage(), _songsSorter.isSorted() ? _songs.size() : 0}
+             << MemoryAccount{"paged songs", _pagedSongs.memoryUsage(), _pagedSongs.isActive() ? _pagedSongs.totalCount() : 0}
+             << MemoryAccount{"playlists cache", _playlistsCache.sizeKB() * 1024LL, _playlistsCache.size()}
+             << MemoryAccount{"playlists search", _playlistsSearch.memoryUsage(), _playlistsSearch.nbSongs()};
+
+    int nbLibItems = 0;
+    qint64 libBytes = _libModel->memoryUsage(nbLibItems);
+    accounts << MemoryAccount{"library table", libBytes, nbLibItems}
+             << MemoryAccount{"global search", _globalSearchModel->memoryUsage(), _globalSearchModel->nbResults()};
+
+    // frame being received + messages handed over to the GUI Thread or deferred in low power
+    qint64 pbBytes = _connection->frameBytes();
+    int nbMessages = pbBytes ? 1 : 0;
+    auto accountMessage = [&pbBytes, &nbMessages](const pb::remote::Message &msg){
+        qint64 bytes = static_cast<qint64>(msg.SpaceUsedLong());
+        if (bytes > static_cast<qint64>(sizeof(pb::remote::Message)))
+        {
+            pbBytes += bytes;
+            ++nbMessages;
+        }
+    };
+#ifdef __USE_CONNECTION_THREAD__
+    // a locked one is being processed, no need to wait for it
+    const QList<QPair<QMutex*, const pb::remote::Message*>> handovers = {
+        {&_securePlaylists, &_playlistData}, {&_secureSongs, &_songsData},
+        {&_secureRemoteFilesData, &_remoteFilesData}, {&_secureRadioStreams, &_radioStreamsData},
+        {&_secureGlobalSearch, &_globalSearchData}
+    };
+    for (const auto &handover : handovers)
+    {
+        if (handover.first->tryLock())
+        {
+            accountMessage(*handover.second);
+            handover.first->unlock();
+        }
+    }
+    QMutexLocker lock(&_secureDeferred);
+#endif
+    accountMessage(_deferredPlaylists);
+    for (const pb::remote::Message &msg : qAsConst(_deferredSongs))
+        accountMessage(msg);
+#ifdef __USE_CONNECTION_THREAD__
+    lock.unlock();
+#endif
+    accounts << MemoryAccount{"protobuf messages", pbBytes, nbMessages};
+
+    qint64 filesBytes = 0;
+    for (const RemoteFile &file : qAsConst(_remoteFiles))
+        filesBytes += static_cast<qint64>(sizeof(RemoteFile)) + file.filename.capacity() * static_cast<qint64>(sizeof(QChar));
+    accounts << MemoryAccount{"remote files", filesBytes, _remoteFiles.size()};
+
+    qint64 radiosBytes = 0;
+    for (const Stream &radio : qAsConst(_radioStreams))
+        radiosBytes += static_cast<qint64>(sizeof(Stream))
+                + (radio.name.capacity() + radio.url.capacity() + radio.logoUrl.capacity()) * static_cast<qint64>(sizeof(QChar));
+    accounts << MemoryAccount{"radio streams", radiosBytes, _radioStreams.size()};
+
+    qint64 storesBytes = _connection->store().memoryUsage();
+    for (ConnectionWorker *worker : qAsConst(_backgroundSessions))
+        storesBytes += worker->store().memoryUsage();
+    accounts << MemoryAccount{"session stores", storesBytes, _backgroundSessions.size() + 1};
+
+    return accounts;
+}
+
+QVariantList ClementineRemote::memoryReport()
+{
+    QVariantList report;
+    qint64 total = 0;
+    for (const MemoryAccount &account : memoryAccounts())
+    {
+        report << QVariantMap{{"name", account.name}, {"bytes", account.bytes}, {"count", account.count}};
+        total += account.bytes;
+    }
+    report << QVariantMap{{"name", "total"}, {"bytes", total}, {"count", -1}};
+    return report;
+}
+
+QString ClementineRemote::memoryReportStr()
+{
+    QString report;
+    qint64 total = 0;
+    for (const MemoryAccount &account : memoryAccounts())
+    {
+        report += QString("  - %1: %2 kB (%3 objects)\n").arg(account.name).arg(account.bytes / 1024).arg(account.count);
+        total += account.bytes;
+    }
+    report += QString("  => total: %1 kB (peak frame received: %2 kB)").arg(total / 1024).arg(
+                _connection->peakFrameBytes() / 1024);
+    return report;
+}
+
+void ClementineRemote::setMemoryLogPeriod(int periodSec)
+{
+    qDebug() << "[ClementineRemote::setMemoryLogPeriod] " << periodSec << " sec";
+    if (periodSec > 0)
+        _memoryLogTimer.start(periodSec * 1000);
+    else
+        _memoryLogTimer.stop();
+}
+
+void ClementineRemote::lowMemoryWarning() { _memoryPressure.notifyLowMemory(); }
+
+void ClementineRemote::simulateMemoryPressure(int tier)
+{
+    _memoryPressure.simulate(static_cast<MemoryPressure::Tier>(
+                qBound(0, tier, static_cast<int>(MemoryPressure::Tier::library))));
+}
+
+void ClementineRemote::onShedMemory(MemoryPressure::Tier tier)
+{
+    M_TRACE_SCOPE("ClementineRemote::onShedMemory");
+    QElapsedTimer shedTime;
+    shedTime.start();
+
+    // collation keys of the sort (the ranks are kept, the keys are rebuilt on the next sort)
+    _songsSorter.dropCollationKeys();
+
+    // songs of the playlists not displayed (requested again when switching to them)
+    if (tier >= MemoryPressure::Tier::offscreenPlaylists)
+    {
+        _playlistsCache.clear();
+        retainStoredPlaylists();
+        _playlistsSearch.retain({_dispPlaylistId});
+    }
+
+    // library tree (reloaded from the DB by requestLibrary)
+    if (tier >= MemoryPressure::Tier::library && _libraryLoaded)
+    {
+        _libModel->clear();
+        _libDB.close();
+        _libraryLoaded = false;
+        _libraryShed   = true;
+        emit libraryShed();
+    }
+
+    qDebug() << "[ClementineRemote::onShedMemory] tier " << static_cast<ushort>(tier)
+             << " dropped in " << shedTime.nsecsElapsed() / 1000 << " us";
+}
+
+void ClementineRemote::discoverServers(ushort port)
+{
+    _discovery.start(port);
+}
+
+void ClementineRemote::stopDiscovery()
+{
+    if (!_discovery.isRunning())
+        return;
+    qDebug() << "[ClementineRemote::stopDiscovery] scan aborted";
+    _discovery.stop();
+}
+
+void ClementineRemote::onServerFound(const QString &host, ushort port, const QString &version, bool authRequired)
+{
+    qDebug() << "[ClementineRemote::onServerFound] " << host << ":" << port
+             << " version: " << version << " auth required: " << authRequired;
+    for (int i = 0; i < _sessionsSaved.size(); ++i)
+    {
+        ClementineSession *session = _sessionsSaved.at(i);
+        if (session->host() == host && session->port() == port)
+        {
+            emit serverDiscovered(i);
+            return;
+        }
+    }
+
+    QString sessionName = version.isEmpty() ? host : QString("%1 (%2)").arg(host).arg(version);
+    emit serverDiscovered(createNewSession(sessionName, host, port, -1));
+}
+
 int ClementineRemote::createNewSession(const QString &sessionName, const QString &host, int port, int pass)
 {
     _sessionsSaved << new ClementineSession(sessionName, this, host, static_cast<ushort>(port), pass);
@@ -775,6 +1423,15 @@ void ClementineRemote::deleteCurrentSession()
 
     ClementineSession *session = _sessionsSaved[_sessionSelected];
     _sessionsSaved.removeAt(_sessionSelected);
+    ConnectionWorker *worker = _backgroundSessions.take(session);
+    if (worker)
+    {
+        worker->setReconnectAllowed(false);
+        emit worker->killSocket();
+        worker->deleteLater();
+    }
+    if (session == _speculativeSession)
+        _speculativeSession = nullptr;
     delete session;
     _sessionSelected = 0;
 }
@@ -786,33 +1443,29 @@ void ClementineRemote::deleteCurrentSession()
 
 QString ClementineRemote::playlistName() const
 {
-    return _dispPlaylist ? _dispPlaylist->name : QString("Playlist #%1").arg(_dispPlaylistId);
+    const RemotePlaylist *p = dispPlaylist();
+    return p ? p->name : QString("Playlist #%1").arg(_dispPlaylistId);
 }
 
 bool ClementineRemote::isCurrentPlaylistSaved() const
 {
-    if (_dispPlaylist)
-        return _dispPlaylist->favorite;
+    const RemotePlaylist *p = dispPlaylist();
+    if (p)
+        return p->favorite;
     else
         return false;
 }
 
 int ClementineRemote::getAtivePlaylistIndex()
 {
-    int idx = 0;
-    for (RemotePlaylist *p : qAsConst(_playlistsOpened))
-    {
-        if (p->id == _activePlaylistId)
-            return idx;
-        ++idx;
-    }
-    return idx;
+    return _openedPlaylistRows.value(_activePlaylistId, _playlistsOpened.size());
 }
 
 qint32 ClementineRemote::displayedPlaylistID() const
 {
-    if (_dispPlaylist)
-        return _dispPlaylist->id;
+    const RemotePlaylist *p = dispPlaylist();
+    if (p)
+        return p->id;
     else
         return -1;
 }
@@ -824,50 +1477,44 @@ qint32 ClementineRemote::activePlaylistID() const
 
 bool ClementineRemote::isActivePlaylistDisplayed() const
 {
-    return _dispPlaylist ? _dispPlaylist->id == _activePlaylistId : false;
+    const RemotePlaylist *p = dispPlaylist();
+    return p ? p->id == _activePlaylistId : false;
 }
 
 void ClementineRemote::closingPlaylist(qint32 playlistID)
 {
     int idx = 0;
-    RemotePlaylist *newDispPlaylist = nullptr;
-    for (RemotePlaylist *p : _playlistsOpened)
+    _dispPlaylistIndex = -1;
+    for (const RemotePlaylist &p : qAsConst(_playlistsOpened))
     {
-        if (p->id != playlistID)
+        if (p.id != playlistID)
         {
-            newDispPlaylist = p;
+            _dispPlaylistIndex = idx;
+            if (_activePlaylistId == playlistID)
+                _activePlaylistId = p.id;
             break;
         }
         ++idx;
     }
-    _dispPlaylist      = newDispPlaylist;
-    _dispPlaylistIndex = idx;
-    if (newDispPlaylist && _activePlaylistId == playlistID)
-        _activePlaylistId = newDispPlaylist->id;
 }
 
 void ClementineRemote::updateActivePlaylist()
 {
-    int row = 0;
-    for (RemotePlaylist *p : _playlistsOpened)
+    // only the previous and the new active playlists can change
+    for (qint32 playlistID : {_playingPlaylistId, _activePlaylistId})
     {
-        if (p->id == _activePlaylistId)
-        {
-            if (!p->playing)
-            {
-                p->playing = true;
-                QModelIndex index = _plOpenedModel->index(row);
-                emit _plOpenedModel->dataChanged(index, index, {PlaylistModel::iconSrc});
-            }
-        }
-        else if (p->playing)
+        int row = _openedPlaylistRows.value(playlistID, -1);
+        if (row == -1)
+            continue;
+        RemotePlaylist &p = _playlistsOpened[row];
+        bool playing = p.id == _activePlaylistId;
+        if (p.playing != playing)
         {
-            p->playing = false;
-            QModelIndex index = _plOpenedModel->index(row);
-            emit _plOpenedModel->dataChanged(index, index, {PlaylistModel::iconSrc});
+            p.playing = playing;
+            _updates.dataChanged(_plOpenedModel, row, row, {PlaylistModel::iconSrc});
         }
-        ++row;
     }
+    _playingPlaylistId = _activePlaylistId;
 }
 
 void ClementineRemote::changeAndPlaySong(int songIndex, qint32 playlistID)
@@ -889,22 +1536,13 @@ void ClementineRemote::setRemotePathForHost()
 
 void ClementineRemote::updateCurrentPlaylist()
 {
-    _dispPlaylist       = nullptr;
-    _dispPlaylistIndex = 0;
-    int idx = 0;
-    for (RemotePlaylist *p : qAsConst(_playlistsOpened))
+    _dispPlaylistIndex = _openedPlaylistRows.value(_dispPlaylistId, -1);
+    if (_dispPlaylistIndex != -1)
     {
-        if (p->id == _dispPlaylistId)
-        {
-            _dispPlaylist       = p;
-            _dispPlaylistIndex = idx;
-            qDebug() << "[ClementineRemote::updateCurrentPlaylist] currentPlaylist: #" << idx
-                     << " : " << p->name;
+        qDebug() << "[ClementineRemote::updateCurrentPlaylist] currentPlaylist: #" << _dispPlaylistIndex
+                 << " : " << _playlistsOpened.at(_dispPlaylistIndex).name;
 
-            emit updatePlaylist(idx);
-            break;
-        }
-        ++idx;
+        emit updatePlaylist(_dispPlaylistIndex);
     }
 }
 
@@ -997,25 +1635,37 @@ void ClementineRemote::doSendFilesToAppend()
 int ClementineRemote::getActiveSongIndex() const
 {
     if (isActivePlaylistDisplayed())
-        return _songsProxyModel->mapFromSource(_songsModel->index(_activeSongIndex)).row();
+        return activeSongIndex();
     else
         return _activeSongIndex;
 }
 void ClementineRemote::updateActiveSong(RemoteSong &&activeSong)
 {
+    M_TRACE_SCOPE("ClementineRemote::updateActiveSong");
+    // the server is always right for the active song, it's just to close the pending request
+    _pendingOps.reconcile(PendingOperations::Type::activeSong, activeSong.index);
     _activeSong = activeSong;
 
-    int idx = 0;
-    for (const RemoteSong &s : qAsConst(_songs))
+    if (_pagedSongs.isActive())
     {
-        if (s.index == _activeSong.index)
+        // the rows are the indexes of the songs in the playlist
+        if (_activeSong.index >= 0 && _activeSong.index < _pagedSongs.totalCount())
         {
-            _activeSongIndex = idx;
+            _activeSongIndex = _activeSong.index;
             if (isActivePlaylistDisplayed())
-                emit activeSongIdx(_songsProxyModel->mapFromSource(_songsModel->index(idx)).row());
-            break;
+                emit activeSongIdx(activeSongIndex());
         }
-        ++idx;
+        emit activeSongDetails(_activeSong.name(), _activeSong.length, _activeSong.pretty_length);
+        qDebug() << "[MsgType::CURRENT_METAINFO] " << _activeSong.str();
+        return;
+    }
+
+    int row = _songsIndex.rowOfIndex(_songs, _activeSong.index);
+    if (row != -1)
+    {
+        _activeSongIndex = row;
+        if (isActivePlaylistDisplayed())
+            emit activeSongIdx(activeSongIndex());
     }
 
     emit activeSongDetails(_activeSong.name(), _activeSong.length, _activeSong.pretty_length);
@@ -1029,16 +1679,90 @@ void ClementineRemote::setSongsFilter(const QString &searchTxt)
                 QRegularExpression(searchTxt, QRegularExpression::CaseInsensitiveOption));
 }
 
-void ClementineRemote::deleteSelectedSongs()
+void ClementineRemote::searchPlaylists(const QString &query)
 {
-#ifdef __USE_CONNECTION_THREAD__
-    QMutexLocker lock(&_secureSongs);
-#endif
-    lockUserMutex();
-    _userMsg.Clear();
-    _userMsg.set_type(pb::remote::REMOVE_SONGS);
-    QList<int> selectedSongsIdexes = _songsProxyModel->selectedSongsIdexes();
-    if (selectedSongsIdexes.isEmpty())
+    M_TRACE_SCOPE("ClementineRemote::searchPlaylists");
+    if (query.trimmed().isEmpty())
+        _playlistsSearchModel->setHits({});
+    else
+    {
+        indexStalePlaylist();
+        _playlistsSearchModel->setHits(_playlistsSearch.search(query));
+    }
+}
+
+void ClementineRemote::indexStalePlaylist()
+{
+    qint32 playlistID = _playlistsSearch.stalePlaylistID();
+    if (playlistID == -1)
+        return;
+    if (playlistID == _songsPlaylistId)
+        _playlistsSearch.index(playlistID, _songs);
+    else
+        _playlistsSearch.remove(playlistID); // not displayed anymore: indexed again when its songs come back
+}
+
+void ClementineRemote::showPlaylistsSearchHit(int hitRow)
+{
+    const PlaylistsSearchIndex::Hit *hit = _playlistsSearchModel->hit(hitRow);
+    if (!hit)
+        return;
+    int pIdx = _openedPlaylistRows.value(hit->playlistID, -1);
+    if (pIdx == -1)
+    {
+        qDebug() << "[ClementineRemote::showPlaylistsSearchHit] playlist #" << hit->playlistID << " is not opened anymore";
+        return;
+    }
+
+    _searchHitPlaylistID = hit->playlistID;
+    _searchHitSongID     = hit->songID;
+    _searchHitRow        = hit->row;
+    if (hit->playlistID != _dispPlaylistId)
+        emit changePlaylist(pIdx); // displayed right away if it is in the cache (or by pages)
+    if (_searchHitPlaylistID == _dispPlaylistId)
+        showSearchHitSong();
+    // otherwise when its PLAYLIST_SONGS arrive
+}
+
+QString ClementineRemote::openedPlaylistName(qint32 playlistID) const
+{
+    int row = _openedPlaylistRows.value(playlistID, -1);
+    return row == -1 ? QString() : _playlistsOpened.at(row).name;
+}
+
+void ClementineRemote::showSearchHitSong()
+{
+    qint32 songID = _searchHitSongID;
+    int    row    = _searchHitRow;
+    _searchHitPlaylistID = -1;
+    _searchHitSongID     = -1;
+    _searchHitRow        = -1;
+
+    if (hasSongsIndex())
+        row = _songsIndex.rowOfId(_songs, songID); // it may have moved since it was indexed
+    if (row < 0 || row >= numberOfPlaylistSongs())
+    {
+        qDebug() << "[ClementineRemote::showSearchHitSong] song #" << songID << " not in the playlist anymore";
+        return;
+    }
+
+    QModelIndex proxyIndex = _songsProxyModel->mapFromSource(_songsModel->index(row, 0));
+    if (proxyIndex.isValid())
+        emit showSong(proxyIndex.row());
+    else
+        qDebug() << "[ClementineRemote::showSearchHitSong] song #" << songID << " is filtered";
+}
+
+void ClementineRemote::deleteSelectedSongs()
+{
+#ifdef __USE_CONNECTION_THREAD__
+    QMutexLocker lock(&_secureSongs);
+#endif
+    lockUserMutex();
+    _userMsg.Clear();
+    _userMsg.set_type(pb::remote::REMOVE_SONGS);
+    QList<int> selectedSongsIdexes = _songsProxyModel->selectedSongsIdexes();
+    if (selectedSongsIdexes.isEmpty())
     {
         releaseUserMutex();
         return ;
@@ -1051,6 +1775,12 @@ void ClementineRemote::deleteSelectedSongs()
             req->add_songs(songIndex);
 
         emit sendSongsToRemove();
+
+        // hide them until the server sends back the playlist
+        int nbSongs = numberOfPlaylistSongs();
+        addPendingOperation(PendingOperations::Type::removeSongs,
+                            nbSongs - selectedSongsIdexes.size(), nbSongs, _dispPlaylistId);
+        _songsProxyModel->hideSongs(selectedSongsIdexes);
     }
 }
 
@@ -1149,42 +1879,35 @@ void ClementineRemote::shallForceRePlayActiveSong()
 
 void ClementineRemote::rcvPlaylists(const pb::remote::ResponsePlaylists &playlists)
 {
+    M_TRACE_SCOPE("ClementineRemote::rcvPlaylists");
     bool includeClosedPlaylists = playlists.has_include_closed() && playlists.include_closed();
-    if (_playlistsOpened.size())
-    {
-        emit _plOpenedModel->preClearPlaylists(_playlistsOpened.size() - 1);
-        qDeleteAll(_playlistsOpened);
-        _playlistsOpened.clear();
-        emit _plOpenedModel->postClearPlaylists();
-    }
-    if (includeClosedPlaylists && _playlistsClosed.size())
+
+    QVector<RemotePlaylist> opened, closed;
+    opened.reserve(playlists.playlist_size());
+    if (includeClosedPlaylists)
+        closed.reserve(playlists.playlist_size());
+    for (const auto& pb_playlist : playlists.playlist())
     {
-        emit _plClosedModel->preClearPlaylists(_playlistsClosed.size() - 1);
-        qDeleteAll(_playlistsClosed);
-        _playlistsClosed.clear();
-        emit _plClosedModel->postClearPlaylists();
+        if (!pb_playlist.closed())
+            opened << RemotePlaylist(pb_playlist, _activePlaylistId);
+        else if (includeClosedPlaylists) // the closed ones are only complete with include_closed
+            closed << RemotePlaylist(pb_playlist, _activePlaylistId);
     }
+    int idxOpened = opened.size(), idxClosed = closed.size();
 
-    qint32 nbPlaylists = playlists.playlist_size();
-    int idxOpened = 0, idxClosed = 0;
-    if (nbPlaylists)
+    reconcilePlaylists(_plOpenedModel, _playlistsOpened, opened);
+    _openedPlaylistRows.clear();
+    _openedPlaylistRows.reserve(_playlistsOpened.size());
+    QSet<qint32> openedIDs;
+    for (int row = 0 ; row < _playlistsOpened.size() ; ++row)
     {
-        for (const auto& pb_playlist : playlists.playlist())
-        {
-            if(pb_playlist.closed())
-            {
-                emit _plClosedModel->preAddPlaylist(idxClosed);
-                _playlistsClosed << new RemotePlaylist(pb_playlist, _activePlaylistId);
-                emit _plClosedModel->postAddPlaylist(idxClosed++);
-            }
-            else
-            {
-                emit _plOpenedModel->preAddPlaylist(idxOpened);
-                _playlistsOpened << new RemotePlaylist(pb_playlist, _activePlaylistId);
-                emit _plOpenedModel->postAddPlaylist(idxOpened++);
-            }
-        }
+        _openedPlaylistRows.insert(_playlistsOpened.at(row).id, row);
+        openedIDs.insert(_playlistsOpened.at(row).id);
     }
+    _playlistsSearch.retain(openedIDs); // the closed ones would need to be fetched again
+    _playingPlaylistId = _activePlaylistId; // RemotePlaylist::playing is set from it
+    if (includeClosedPlaylists)
+        reconcilePlaylists(_plClosedModel, _playlistsClosed, closed);
 
     updateCurrentPlaylist();
 
@@ -1200,12 +1923,143 @@ void ClementineRemote::rcvPlaylists(const pb::remote::ResponsePlaylists &playlis
 
 
 
+void ClementineRemote::reconcilePlaylists(PlaylistModel *model, QVector<RemotePlaylist> &playlists,
+                                          const QVector<RemotePlaylist> &newPlaylists)
+{
+    QSet<qint32> newIDs;
+    newIDs.reserve(newPlaylists.size());
+    for (const RemotePlaylist &p : newPlaylists)
+        newIDs.insert(p.id);
+
+    // 1.: remove the ones that are gone (by blocks, from the end so the rows stay valid)
+    int nbRemoved = 0;
+    for (int last = playlists.size() - 1 ; last >= 0 ; )
+    {
+        if (newIDs.contains(playlists.at(last).id))
+        {
+            --last;
+            continue;
+        }
+        int first = last;
+        while (first > 0 && !newIDs.contains(playlists.at(first - 1).id))
+            --first;
+        emit model->preRemovePlaylists(first, last);
+        playlists.erase(playlists.begin() + first, playlists.begin() + last + 1);
+        emit model->postRemovePlaylists();
+        nbRemoved += last - first + 1;
+        last = first - 1;
+    }
+
+    QSet<qint32> oldIDs;
+    oldIDs.reserve(playlists.size());
+    for (const RemotePlaylist &p : qAsConst(playlists))
+        oldIDs.insert(p.id);
+
+    // 2.: follow the new order: updates in place, moves and insertions (by blocks)
+    int nbMoved = 0, nbInserted = 0, nbUpdated = 0;
+    for (int row = 0 ; row < newPlaylists.size() ; )
+    {
+        const RemotePlaylist &newPlaylist = newPlaylists.at(row);
+        if (row < playlists.size() && playlists.at(row).id == newPlaylist.id)
+        {
+            if (!playlists.at(row).sameData(newPlaylist))
+            {
+                playlists[row] = newPlaylist;
+                _updates.dataChanged(model, row, row);
+                ++nbUpdated;
+            }
+            ++row;
+        }
+        else if (oldIDs.contains(newPlaylist.id))
+        {
+            int oldRow = row + 1;
+            while (oldRow < playlists.size() && playlists.at(oldRow).id != newPlaylist.id)
+                ++oldRow;
+            if (oldRow < playlists.size())
+            {
+                emit model->preMovePlaylist(oldRow, row);
+                playlists.move(oldRow, row);
+                emit model->postMovePlaylist();
+                ++nbMoved; // updated at the next iteration
+            }
+            else
+            {   // ID sent twice by the server: its old row is already used above
+                emit model->preAddPlaylists(row, row);
+                playlists.insert(row, newPlaylist);
+                emit model->postAddPlaylists();
+                ++nbInserted;
+                ++row;
+            }
+        }
+        else
+        {
+            int last = row;
+            while (last + 1 < newPlaylists.size() && !oldIDs.contains(newPlaylists.at(last + 1).id))
+                ++last;
+            emit model->preAddPlaylists(row, last);
+            for (int i = row ; i <= last ; ++i)
+                playlists.insert(i, newPlaylists.at(i));
+            emit model->postAddPlaylists();
+            nbInserted += last - row + 1;
+            row = last + 1;
+        }
+    }
+    if (playlists.size() > newPlaylists.size())
+    {   // duplicated IDs in the old list that are not duplicated anymore
+        emit model->preRemovePlaylists(newPlaylists.size(), playlists.size() - 1);
+        nbRemoved += playlists.size() - newPlaylists.size();
+        playlists.resize(newPlaylists.size());
+        emit model->postRemovePlaylists();
+    }
+    qDebug() << "[ClementineRemote::reconcilePlaylists] " << playlists.size() << " playlists: "
+             << nbRemoved << " removed, " << nbMoved << " moved, " << nbInserted << " inserted, "
+             << nbUpdated << " updated";
+}
+
 void ClementineRemote::rcvPlaylistSongs(const pb::remote::ResponsePlaylistSongs &songs)
 {
-    qint32 playlistID = songs.requested_playlist().id();
-    qDebug() << "[MsgType::PLAYLIST_SONGS] playlist ID: " << playlistID;
+    M_TRACE_SCOPE("ClementineRemote::rcvPlaylistSongs");
+    const pb::remote::Playlist &pb_playlist = songs.requested_playlist();
+    qint32 playlistID = pb_playlist.id();
+    qint32 revision   = pb_playlist.has_revision() ? pb_playlist.revision() : -1;
+    qDebug() << "[MsgType::PLAYLIST_SONGS] playlist ID: " << playlistID << ", revision: " << revision;
+
+    if (songs.has_offset() && !songs.has_fields_mask() && songs.songs_size() == 1
+            && playlistID == _songDetailsPlaylistID && static_cast<int>(songs.offset()) == _songDetailsIndex)
+    {
+        rcvSongDetails(songs.songs(0));
+        return;
+    }
+    else if (songs.has_offset())
+    {
+        rcvPlaylistSongsPage(songs);
+        return;
+    }
+    else if (_pagedSongs.isActive() && _pagedSongs.playlistID() == playlistID
+             && playlistID == _requestSongsForPlaylistID.loadRelaxed())
+    {
+        qDebug() << "[MsgType::PLAYLIST_SONGS] the server doesn't support windowed requests";
+        _pagedSongsSupport = false;
+    }
+
+    // only decode what the View needs (even if the server didn't apply the projection)
+    QElapsedTimer decodeTime;
+    decodeTime.start();
+    // the big playlists are decoded in parallel, looking for the active song in the same pass
+    int activeRow = -1;
+    QList<RemoteSong> playlistSongs = SongsDecoder::decode(
+                songs.songs(), RemoteSong::sPlaylistFieldsMask, _activeSong.index, activeRow);
+    qDebug() << "[MsgType::PLAYLIST_SONGS] " << playlistSongs.size() << " songs decoded in "
+             << decodeTime.nsecsElapsed() / 1000 << " us (projection "
+             << (songs.has_fields_mask() ? "applied by the server" : "not supported by the server") << ")";
+
+    // even if not displayed, they're fresh: keep them for when the user will switch to that playlist
+    _playlistsCache.store(playlistID, playlistSongs, revision);
+    retainStoredPlaylists();
+    _playlistsSearch.index(playlistID, playlistSongs);
+
     if (playlistID != _dispPlaylistId && // always update displayed playlist
-            _initialized && playlistID != _requestSongsForPlaylistID.loadRelaxed())
+            M_LoadAtomic(_initialized) && playlistID != _requestSongsForPlaylistID.loadRelaxed())
     {
         qDebug() << "[MsgType::PLAYLIST_SONGS] ignoring msg, _dispPlaylistId: " << _dispPlaylistId
                  << ", _requestSongsForPlaylistID: " << _requestSongsForPlaylistID.loadRelaxed();
@@ -1215,41 +2069,769 @@ void ClementineRemote::rcvPlaylistSongs(const pb::remote::ResponsePlaylistSongs
         _requestSongsForPlaylistID = -1; // unset for next request
 
     _dispPlaylistId = playlistID;
+    _dispSongsRevision = revision;
     updateCurrentPlaylist();
 
+    reconcileRemovedSongs(playlistID, playlistSongs.size());
+    displaySongs(playlistID, playlistSongs);
+    if (activeRow != -1)
+        _activeSongIndex = activeRow;
+    if (_searchHitPlaylistID == playlistID)
+        showSearchHitSong();
+
+    // server without windowed requests: the details we asked come with the whole playlist
+    if (playlistID == _songDetailsPlaylistID)
+    {
+        if (_songDetailsIndex < songs.songs_size())
+            rcvSongDetails(songs.songs(_songDetailsIndex));
+        else
+        {
+            qDebug() << "[MsgType::PLAYLIST_SONGS] song #" << _songDetailsIndex << " for its details not in the playlist anymore";
+            _songDetailsPlaylistID = -1;
+            _songDetailsIndex      = -1;
+        }
+    }
+
+    qDebug() << "[MsgType::PLAYLIST_SONGS] Nb Songs: " << _songs.size();
+//    dumpCurrentPlaylist();
+}
+
+void ClementineRemote::rcvPlaylistSongsPage(const pb::remote::ResponsePlaylistSongs &songs)
+{
+    M_TRACE_SCOPE("ClementineRemote::rcvPlaylistSongsPage");
+    qint32 playlistID = songs.requested_playlist().id();
+    if (!_pagedSongs.isActive() || playlistID != _pagedSongs.playlistID())
+    {
+        qDebug() << "[MsgType::PLAYLIST_SONGS] ignoring page of playlist #" << playlistID
+                 << " (paged playlist: " << _pagedSongs.playlistID() << ")";
+        return;
+    }
+    else if (playlistID == _requestSongsForPlaylistID.loadRelaxed())
+        _requestSongsForPlaylistID = -1; // unset for next request
+
+    int totalCount = songs.has_total_count() ? songs.total_count() : _pagedSongs.totalCount();
+    if (totalCount != _pagedSongs.totalCount())
+    {
+        qDebug() << "[MsgType::PLAYLIST_SONGS] playlist #" << playlistID << " has now "
+                 << totalCount << " songs (instead of " << _pagedSongs.totalCount() << ")";
+        displayPagedSongs(playlistID, totalCount); // drops all the pages
+        updateActiveSongIndex();
+    }
+
+    QVector<RemoteSong> page;
+    page.reserve(songs.songs_size());
+    for (const auto& song : songs.songs())
+        page << RemoteSong(song, RemoteSong::sPlaylistFieldsMask);
+
+    int nbSongs = page.size();
+    int firstSongIdx = _pagedSongs.storePage(songs.offset(), std::move(page));
+    if (firstSongIdx != -1 && nbSongs)
+        emit songsUpdated(firstSongIdx, qMin(firstSongIdx + nbSongs, totalCount) - 1);
+
+    qDebug() << "[MsgType::PLAYLIST_SONGS] page of playlist #" << playlistID
+             << " offset: " << songs.offset() << ", nb songs: " << nbSongs << " / " << totalCount;
+}
+
+void ClementineRemote::rcvSongDetails(const pb::remote::SongMetadata &song)
+{
+    M_TRACE_SCOPE("ClementineRemote::rcvSongDetails");
+    qint32 playlistID = _songDetailsPlaylistID;
+    int songIndex     = _songDetailsIndex;
+    _songDetailsPlaylistID = -1;
+    _songDetailsIndex      = -1;
+
+    // a PLAYLIST_DELTA may have moved the song since the request
+    if (playlistID == _dispPlaylistId && hasSongsIndex() && song.has_id()
+            && (songIndex < 0 || songIndex >= _songs.size() || _songs.at(songIndex).id != song.id()))
+    {
+        int row = _songsIndex.rowOfId(_songs, song.id());
+        if (row != -1)
+            songIndex = row;
+    }
+
+    if (playlistID != _dispPlaylistId || songIndex >= numberOfPlaylistSongs()
+            || !isPlaylistSongLoaded(songIndex))
+    {
+        qDebug() << "[MsgType::PLAYLIST_SONGS] ignoring details of song #" << songIndex
+                 << " of playlist #" << playlistID << " (not displayed anymore)";
+        return;
+    }
+
+    RemoteSong &remoteSong = playlistSong(songIndex);
+    bool selected = remoteSong.selected;
+    remoteSong = song;
+    remoteSong.selected = selected;
+    qDebug() << "[MsgType::PLAYLIST_SONGS] details of " << remoteSong.str();
+
+    emit songsUpdated(songIndex, songIndex);
+    emit songDetailsReceived(songIndex);
+}
+
+void ClementineRemote::requestSongDetails(int songIndex)
+{
+    if (songIndex < 0 || songIndex >= numberOfPlaylistSongs())
+        return;
+
+    if (isPlaylistSongLoaded(songIndex) && playlistSong(songIndex).hasAllFields())
+    {
+        emit songDetailsReceived(songIndex);
+        return;
+    }
+
+    _songDetailsPlaylistID = _dispPlaylistId;
+    _songDetailsIndex      = songIndex;
+    emit requestSongMetadata(_dispPlaylistId, songIndex);
+}
+
+void ClementineRemote::rcvPlaylistDelta(const pb::remote::ResponsePlaylistDelta &delta)
+{
+    M_TRACE_SCOPE("ClementineRemote::rcvPlaylistDelta");
+    qint32 playlistID = delta.playlist_id();
+    qint32 revision   = delta.has_revision() ? delta.revision() : -1;
+    qDebug() << "[MsgType::PLAYLIST_DELTA] playlist ID: " << playlistID << ", revision: "
+             << delta.base_revision() << " -> " << revision << ", nb ops: " << delta.ops_size();
+
+    RemotePlaylist *p = openedPlaylistWithID(playlistID);
+    if (p)
+    {
+        p->revision = revision;
+        if (delta.has_item_count())
+            p->item_count = delta.item_count();
+    }
+
+    // the index of the active song is its row in the active playlist
+    if (playlistID == _activePlaylistId)
+    {
+        for (const pb::remote::PlaylistDeltaOp &op : delta.ops())
+            _activeSong.index = shiftedRow(_activeSong.index, op);
+    }
+
+    if (playlistID != _dispPlaylistId)
+    {
+        _playlistsCache.remove(playlistID); // it will be fetched again when displayed
+        _playlistsSearch.remove(playlistID);
+        return;
+    }
+
+    // (also avoids the deep copy of _songs that is shared with the cache)
+    _playlistsCache.remove(playlistID);
+
+    reconcileRemovedSongs(playlistID, deltaItemCount(delta, numberOfPlaylistSongs()));
+
+    if (_pagedSongs.isActive())
+    {
+        // drop the pages, the visible ones will be requested again
+        displayPagedSongs(playlistID, deltaItemCount(delta, _pagedSongs.totalCount()));
+        _dispSongsRevision = revision;
+    }
+    else if (_dispSongsRevision == -1 || delta.base_revision() != _dispSongsRevision
+            || !applyPlaylistDelta(delta))
+    {
+        qDebug() << "[MsgType::PLAYLIST_DELTA] can't apply the delta (displayed revision: "
+                 << _dispSongsRevision << "), fetching the whole playlist #" << playlistID;
+        _dispSongsRevision = -1;
+        setRequestSongsForPlaylistID(playlistID);
+        emit requestPlaylistSongs(playlistID);
+        return;
+    }
+    else
+    {
+        _dispSongsRevision = revision;
+        if (_playlistsSearch.stalePlaylistID() != playlistID)
+            indexStalePlaylist();
+        _playlistsSearch.markStale(playlistID); // indexed again on the next search, not at each edit
+    }
+
+    if (isActivePlaylistDisplayed() && _activeSong.index >= 0 && _activeSong.index < numberOfPlaylistSongs())
+    {
+        _activeSongIndex = _activeSong.index;
+        emit activeSongIdx(activeSongIndex());
+    }
+}
+
+bool ClementineRemote::isValidPlaylistDelta(const pb::remote::ResponsePlaylistDelta &delta, int nbSongs)
+{
+    for (const pb::remote::PlaylistDeltaOp &op : delta.ops())
+    {
+        int position = op.position(), count = op.count();
+        switch (op.type()) {
+        case pb::remote::PlaylistDeltaOp::INSERT:
+            if (position < 0 || position > nbSongs)
+                return false;
+            nbSongs += op.songs_size();
+            break;
+
+        case pb::remote::PlaylistDeltaOp::REMOVE:
+            if (count < 1 || position < 0 || position + count > nbSongs)
+                return false;
+            nbSongs -= count;
+            break;
+
+        case pb::remote::PlaylistDeltaOp::MOVE:
+            if (count < 1 || position < 0 || position + count > nbSongs
+                    || op.destination() < 0 || op.destination() + count > nbSongs)
+                return false;
+            break;
+
+        default:
+            return false;
+        }
+    }
+    return !delta.has_item_count() || delta.item_count() == nbSongs;
+}
+
+bool ClementineRemote::applyPlaylistDelta(const pb::remote::ResponsePlaylistDelta &delta)
+{
+    // all the ops are checked before touching _songs: a bad delta leaves them as they were (until the refetch)
+    if (!isValidPlaylistDelta(delta, _songs.size()))
+        return false;
+
+    invalidateSongsIndexes();
+    int firstChangedRow = _songs.size();
+    for (const pb::remote::PlaylistDeltaOp &op : delta.ops())
+    {
+        int position = op.position(), count = op.count();
+        switch (op.type()) {
+        case pb::remote::PlaylistDeltaOp::INSERT:
+            count = op.songs_size();
+            if (!count)
+                break;
+            emit preInsertSongs(position, position + count - 1);
+            for (int i = 0; i < count; ++i)
+                _songs.insert(position + i, RemoteSong(op.songs(i), RemoteSong::sPlaylistFieldsMask));
+            invalidateSongsIndexes(); // the sorted proxy asks the ranks of the new rows
+            emit postSongAppended();
+            firstChangedRow = qMin(firstChangedRow, position);
+            break;
+
+        case pb::remote::PlaylistDeltaOp::REMOVE:
+            emit preRemoveSongs(position, position + count - 1);
+            _songs.erase(_songs.begin() + position, _songs.begin() + position + count);
+            invalidateSongsIndexes();
+            emit postSongRemoved();
+            firstChangedRow = qMin(firstChangedRow, position);
+            break;
+
+        case pb::remote::PlaylistDeltaOp::MOVE:
+        {
+            int destination = op.destination();
+            if (destination == position)
+                break;
+            // for the View, the destination is the row before which the songs are inserted
+            emit preMoveSongs(position, position + count - 1,
+                              destination > position ? destination + count : destination);
+            QList<RemoteSong> movedSongs = _songs.mid(position, count);
+            _songs.erase(_songs.begin() + position, _songs.begin() + position + count);
+            for (int i = 0; i < count; ++i)
+                _songs.insert(destination + i, movedSongs.at(i));
+            invalidateSongsIndexes();
+            emit postSongsMoved();
+            firstChangedRow = qMin(firstChangedRow, qMin(position, destination));
+            break;
+        }
+        }
+    }
+
+    // the index of a song is its row in the playlist
+    for (int row = firstChangedRow; row < _songs.size(); ++row)
+        _songs[row].index = row;
+    invalidateSongsIndexes();
+    if (firstChangedRow < _songs.size())
+        emit songsUpdated(firstChangedRow, _songs.size() - 1);
+
+    qDebug() << "[MsgType::PLAYLIST_DELTA] applied, nb songs: " << _songs.size();
+    return true;
+}
+
+int ClementineRemote::shiftedRow(int row, const pb::remote::PlaylistDeltaOp &op)
+{
+    int position = op.position(), count = op.count();
+    switch (op.type()) {
+    case pb::remote::PlaylistDeltaOp::INSERT:
+        return row >= position ? row + op.songs_size() : row;
+
+    case pb::remote::PlaylistDeltaOp::REMOVE:
+        return row >= position + count ? row - count : row;
+
+    case pb::remote::PlaylistDeltaOp::MOVE:
+        if (row >= position && row < position + count)
+            return op.destination() + row - position;
+        if (row >= position + count)
+            row -= count;
+        if (row >= op.destination())
+            row += count;
+        return row;
+    }
+    return row;
+}
+
+int ClementineRemote::deltaItemCount(const pb::remote::ResponsePlaylistDelta &delta, int nbSongs)
+{
+    if (delta.has_item_count())
+        return delta.item_count();
+
+    for (const pb::remote::PlaylistDeltaOp &op : delta.ops())
+    {
+        if (op.type() == pb::remote::PlaylistDeltaOp::INSERT)
+            nbSongs += op.songs_size();
+        else if (op.type() == pb::remote::PlaylistDeltaOp::REMOVE)
+            nbSongs -= op.count();
+    }
+    return nbSongs;
+}
+
+RemotePlaylist *ClementineRemote::openedPlaylistWithID(qint32 playlistID)
+{
+    int row = _openedPlaylistRows.value(playlistID, -1);
+    return row == -1 ? nullptr : &_playlistsOpened[row];
+}
+
+void ClementineRemote::addPendingOperation(PendingOperations::Type type, qint32 expected, qint32 previous, qint32 key)
+{
+    quint32 opId = _pendingOps.add(type, expected, previous, key);
+    qDebug() << "[ClementineRemote::addPendingOperation] #" << opId << " type: " << static_cast<ushort>(type)
+             << ", expected: " << expected << ", previous: " << previous;
+    if (!_pendingOpsTimer.isActive())
+        _pendingOpsTimer.start();
+}
+
+void ClementineRemote::onCheckPendingOperations()
+{
+    for (const PendingOperations::Operation &op : _pendingOps.expired())
+        rollbackOperation(op);
+    if (_pendingOps.isEmpty())
+        _pendingOpsTimer.stop();
+}
+
+void ClementineRemote::rollbackOperation(const PendingOperations::Operation &op)
+{
+    qDebug() << "[ClementineRemote::rollbackOperation] no echo for #" << op.id
+             << " type: " << static_cast<ushort>(op.type) << ", back to: " << op.previous;
+    switch (op.type) {
+    case PendingOperations::Type::engineState:
+        _clemState = static_cast<pb::remote::EngineState>(op.previous);
+        emit updateEngineState();
+        break;
+    case PendingOperations::Type::volume:
+        _volume = op.previous;
+        emit updateVolume(_volume);
+        break;
+    case PendingOperations::Type::shuffle:
+        _shuffleMode = sQmlShuffleCodes.key(static_cast<ushort>(op.previous));
+        emit updateShuffle(static_cast<ushort>(op.previous));
+        break;
+    case PendingOperations::Type::repeat:
+        _repeatMode = sQmlRepeatCodes.key(static_cast<ushort>(op.previous));
+        emit updateRepeat(static_cast<ushort>(op.previous));
+        break;
+    case PendingOperations::Type::activeSong:
+        if (isActivePlaylistDisplayed())
+            emit activeSongIdx(activeSongIndex());
+        emit activeSongDetails(_activeSong.name(), _activeSong.length, _activeSong.pretty_length);
+        break;
+    case PendingOperations::Type::removeSongs:
+        // we can't know what the server did: show them back and ask for the playlist
+        _songsProxyModel->showHiddenSongs();
+        setRequestSongsForPlaylistID(op.key);
+        emit requestPlaylistSongs(op.key);
+        break;
+    case PendingOperations::Type::nbTypes:
+        break;
+    }
+}
+
+void ClementineRemote::rcvEngineState(pb::remote::EngineState state)
+{
+    M_TRACE_SCOPE("ClementineRemote::rcvEngineState");
+    PendingOperations::Echo echo = _pendingOps.reconcile(PendingOperations::Type::engineState, state);
+    if (echo == PendingOperations::Echo::unsolicited || echo == PendingOperations::Echo::diverged)
+    {
+        _clemState = state;
+        emit updateEngineState();
+    }
+}
+
+void ClementineRemote::reconcileRemovedSongs(qint32 playlistID, int nbSongs)
+{
+    if (!_songsProxyModel->hasHiddenSongs())
+        return;
+
+    PendingOperations::Echo echo = _pendingOps.reconcile(PendingOperations::Type::removeSongs, nbSongs, playlistID);
+    if (echo == PendingOperations::Echo::diverged)
+        qDebug() << "[ClementineRemote::reconcileRemovedSongs] playlist #" << playlistID
+                 << " has " << nbSongs << " songs, not the expected number";
+    // the rows are going to be replaced (and renumbered)
+    _songsProxyModel->showHiddenSongs();
+}
+
+void ClementineRemote::onShuffleRequested(ushort mode)
+{
+    addPendingOperation(PendingOperations::Type::shuffle, mode, sQmlShuffleCodes.value(_shuffleMode));
+    _shuffleMode = sQmlShuffleCodes.key(mode);
+    emit updateShuffle(mode);
+}
+
+void ClementineRemote::onRepeatRequested(ushort mode)
+{
+    addPendingOperation(PendingOperations::Type::repeat, mode, sQmlRepeatCodes.value(_repeatMode));
+    _repeatMode = sQmlRepeatCodes.key(mode);
+    emit updateRepeat(mode);
+}
+
+void ClementineRemote::onTrackPositionReceived(qint32 pos)
+{
+    _playbackClock.setPlaying(isPlaying()); // the engine state may come from INFO
+    _playbackClock.addSample(pos);
+    qDebug() << "[ClementineRemote::onTrackPositionReceived] " << pos << " (clock jitter: "
+             << _playbackClock.jitterMs() << " ms on " << _playbackClock.nbSamples() << " samples)";
+    if (!_playbackClock.isPlaying()) // otherwise the View polls trackPositionMs()
+        _updates.notify(UpdateScheduler::Notification::trackPosition, [this, pos](){ emit activeTrackPosition(pos); });
+}
+
+int ClementineRemote::trackPositionMs()
+{
+    qint64 posMs = _playbackClock.positionMs();
+    if (_activeSong.length > 0)
+        posMs = qMin(posMs, static_cast<qint64>(_activeSong.length) * 1000);
+    return static_cast<int>(posMs);
+}
+
+void ClementineRemote::setTrackPositionIntervalMs(int intervalMs)
+{
+    _settings.setValue(sSettings[Settings::trackPositionIntervalMs], intervalMs);
+    if (M_LoadAtomic(_initialized))
+        emit requestTrackPositionInterval(intervalMs);
+}
+
+void ClementineRemote::onApplicationStateChanged(Qt::ApplicationState state)
+{
+    // Inactive is only a loss of focus (the app is still visible)
+    setLowPowerMode(state == Qt::ApplicationSuspended || state == Qt::ApplicationHidden);
+}
+
+void ClementineRemote::setLowPowerMode(bool lowPower)
+{
+    if (lowPower == isLowPowerMode())
+        return;
+
+    qDebug() << "[ClementineRemote::setLowPowerMode] " << (lowPower ? "entering" : "leaving")
+             << " low power mode (" << readyReadsPerMinute() << " readyRead/min during "
+             << _powerModeTime.elapsed() / 1000 << " sec)";
+    _powerModeTime.restart();
+    _powerModeReadyReads = _connection->nbReadyReads();
+
+    _lowPower = lowPower ? 0x1 : 0x0;
+    if (lowPower)
+    {
+        if (M_LoadAtomic(_initialized))
+            emit requestTrackPositionInterval(0); // stop them
+    }
+    else
+        resyncAfterLowPower();
+
+    emit lowPowerModeChanged(lowPower);
+}
+
+double ClementineRemote::readyReadsPerMinute() const
+{
+    qint64 elapsedMs = _powerModeTime.elapsed();
+    if (elapsedMs <= 0)
+        return 0.;
+    return (_connection->nbReadyReads() - _powerModeReadyReads) * 60000. / elapsedMs;
+}
+
+void ClementineRemote::setTracing(bool enabled)
+{
+    TraceRecorder::setEnabled(enabled);
+}
+
+QString ClementineRemote::exportTrace()
+{
+    QString filePath = QString("%1/%2_trace_%3.json").arg(downloadPath()).arg(sAppName).arg(
+                QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
+    if (!TraceRecorder::exportChromeTrace(filePath))
+    {
+        sendError(tr("Trace export"), tr("Can't write %1").arg(filePath));
+        return QString();
+    }
+    sendInfo(tr("Trace export"), tr("Timeline saved in %1<br/>(to open in chrome://tracing)").arg(filePath));
+    return filePath;
+}
+
+bool ClementineRemote::deferInLowPower(pb::remote::Message &msg)
+{
+    if (!M_LoadAtomic(_lowPower) || !M_LoadAtomic(_initialized))
+        return false;
+
+    pb::remote::MsgType msgType = msg.type();
+#ifdef __USE_CONNECTION_THREAD__
+    QMutexLocker lock(&_secureDeferred);
+#endif
+    switch (msgType) {
+    case pb::remote::PLAYLISTS:
+        _deferredPlaylists = std::move(msg);
+        break;
+
+    case pb::remote::PLAYLIST_SONGS:
+    {
+        if (msg.response_playlist_songs().has_offset())
+            return false; // pages and song details are requested by the View
+        qint32 playlistID = msg.response_playlist_songs().requested_playlist().id();
+        _playlistsToResync.remove(playlistID);
+        _deferredSongs[playlistID] = std::move(msg);
+        break;
+    }
+
+    case pb::remote::PLAYLIST_DELTA:
+    {
+        qint32 playlistID = msg.response_playlist_delta().playlist_id();
+        _deferredSongs.remove(playlistID); // the snapshot is outdated
+        _playlistsToResync.insert(playlistID);
+        break;
+    }
+
+    default:
+        return false;
+    }
+
+    qDebug() << "[ClementineRemote::deferInLowPower] msg type: " << msgType;
+    return true;
+}
+
+void ClementineRemote::resyncAfterLowPower()
+{
+    pb::remote::Message playlists;
+    QHash<qint32, pb::remote::Message> songs;
+    QSet<qint32> playlistsToResync;
+    {
+#ifdef __USE_CONNECTION_THREAD__
+        QMutexLocker lock(&_secureDeferred);
+#endif
+        playlists.Swap(&_deferredPlaylists);
+        songs.swap(_deferredSongs);
+        playlistsToResync.swap(_playlistsToResync);
+    }
+    qDebug() << "[ClementineRemote::resyncAfterLowPower] playlists: " << playlists.has_response_playlists()
+             << ", playlist songs: " << songs.size() << ", playlists to fetch: " << playlistsToResync.size();
+
+    // no handover mutex: the snapshots are ours and the data belongs to the GUI Thread
+    // (the worker may hold _securePlaylists or _secureSongs until its queued slot runs here)
+    if (playlists.has_response_playlists())
+        rcvPlaylists(playlists.response_playlists());
+
+    if (songs.size())
+    {
+        // the displayed playlist last, the others only go in the cache
+        for (auto it = songs.cbegin(); it != songs.cend(); ++it)
+        {
+            if (it.key() != _dispPlaylistId)
+                rcvPlaylistSongs(it->response_playlist_songs());
+        }
+        auto itDisp = songs.constFind(_dispPlaylistId);
+        if (itDisp != songs.cend())
+            rcvPlaylistSongs(itDisp->response_playlist_songs());
+    }
+
+    for (qint32 playlistID : playlistsToResync)
+    {
+        if (playlistID == _dispPlaylistId)
+        {
+            setRequestSongsForPlaylistID(playlistID);
+            emit requestPlaylistSongs(playlistID);
+        }
+        else
+        {
+            _playlistsCache.remove(playlistID);
+            _playlistsSearch.remove(playlistID);
+        }
+    }
+
+    if (M_LoadAtomic(_initialized))
+        emit requestTrackPositionInterval(trackPositionIntervalMs());
+}
+
+void ClementineRemote::onNextSongRequested() { showOptimisticActiveSong(activeSongIndex() + 1); }
+
+void ClementineRemote::onPreviousSongRequested() { showOptimisticActiveSong(activeSongIndex() - 1); }
+
+void ClementineRemote::showOptimisticActiveSong(int proxyRow)
+{
+    // same computation than the ConnectionWorker but we don't touch _activeSongIndex
+    // (the request is built from it), only the View is updated
+    if (!isActivePlaylistDisplayed() || proxyRow < 0 || proxyRow >= _songsProxyModel->rowCount())
+        return;
+
+    int songIdx = modelRowFromProxyRow(proxyRow);
+    if (songIdx < 0 || !isPlaylistSongLoaded(songIdx))
+        return;
+
+    const RemoteSong &song = playlistSong(songIdx);
+    addPendingOperation(PendingOperations::Type::activeSong, song.index, _activeSong.index);
+    emit activeSongIdx(proxyRow);
+    emit activeSongDetails(song.name(), song.length, song.pretty_length);
+}
+
+void ClementineRemote::sortSongs(int column)
+{
+    M_TRACE_SCOPE("ClementineRemote::sortSongs");
+    if (column <= static_cast<int>(SongsSorter::Column::none)
+            || column > static_cast<int>(SongsSorter::Column::index))
+        return;
+    if (_pagedSongs.isActive())
+    {
+        qDebug() << "[ClementineRemote::sortSongs] playlist fetched by pages, can't sort it locally";
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    _songsSorter.sortBy(static_cast<SongsSorter::Column>(column));
+    _songsProxyModel->applySort(_songsSorter.isSorted());
+    qDebug() << "[ClementineRemote::sortSongs] column: " << column
+             << ", nb songs: " << _songs.size() << ", time: " << timer.elapsed() << " ms";
+}
+
+void ClementineRemote::clearSongsSort()
+{
+    if (!_songsSorter.isSorted())
+        return;
+    _songsSorter.clear();
+    _songsProxyModel->applySort(false);
+}
+
+void ClementineRemote::displaySongs(qint32 playlistID, const QList<RemoteSong> &songs)
+{
+    M_TRACE_SCOPE("ClementineRemote::displaySongs");
+    indexStalePlaylist(); // while _songs are still the edited ones
+    leavePagedSongs();
+
+    int nbSongs = songs.size();
+    bool samePlaylist = playlistID == _songsPlaylistId;
+    _songsPlaylistId = playlistID;
+    if (samePlaylist && nbSongs && nbSongs == _songs.size())
+    {
+        // refresh in place so the View keeps its position (background refresh of a cached playlist)
+        _songs = songs;
+        invalidateSongsIndexes();
+        emit songsUpdated(0, nbSongs - 1);
+        return;
+    }
+
     if (_songs.size())
     {
         emit preClearSongs(_songs.size() - 1);
         _songs.clear();
+        invalidateSongsIndexes();
         emit postSongRemoved();
     }
 
+    if (nbSongs)
+    {
+        emit preAddSongs(nbSongs - 1);
+        _songs = songs;
+        invalidateSongsIndexes();
+        emit postSongAppended();
+    }
+}
 
-    qint32 nbSongs = songs.songs_size();
-    if (nbSongs > 0)
+void ClementineRemote::displayPagedSongs(qint32 playlistID, int totalCount)
+{
+    M_TRACE_SCOPE("ClementineRemote::displayPagedSongs");
+    indexStalePlaylist();
+    _songsPlaylistId = -1;
+    if (_songs.size())
     {
-        emit preAddSongs(songs.songs_size() -1 );
-        _songs.reserve(songs.songs_size());
-        qint32 idx = 0;
-        for (const auto& song : songs.songs())
-        {
-            _songs << song;
-            if (song.index() == _activeSong.index)
-            {
-                qDebug() << "[MsgType::PLAYLIST_SONGS] current song id: " << _activeSongIndex;
-                _activeSongIndex = idx;
-            }
-            ++idx;
-        }
+        emit preClearSongs(_songs.size() - 1);
+        _songs.clear();
+        invalidateSongsIndexes();
+        emit postSongRemoved();
+    }
+
+    if (_pagedSongs.isActive() && _pagedSongs.playlistID() == playlistID && _pagedSongs.totalCount() == totalCount)
+    {
+        // refresh of the same size: reuse the rows, the View will request the pages it needs
+        _pagedSongs.reset(playlistID, totalCount);
+        if (totalCount)
+            emit songsUpdated(0, totalCount - 1);
+        return;
+    }
+
+    leavePagedSongs();
+    if (totalCount)
+    {
+        emit preAddSongs(totalCount - 1);
+        _pagedSongs.reset(playlistID, totalCount);
         emit postSongAppended();
     }
+    else
+        _pagedSongs.reset(playlistID, 0);
+}
 
-    qDebug() << "[MsgType::PLAYLIST_SONGS] Nb Songs: " << _songs.size();
-//    dumpCurrentPlaylist();
+void ClementineRemote::retainStoredPlaylists()
+{
+    QSet<qint32> playlistIDs = {_dispPlaylistId};
+    for (qint32 playlistID : _playlistsCache.playlistIDs())
+        playlistIDs.insert(playlistID);
+    _connection->store().retainPlaylistSongs(playlistIDs);
+}
+
+void ClementineRemote::leavePagedSongs()
+{
+    if (!_pagedSongs.isActive())
+        return;
+
+    int totalCount = _pagedSongs.totalCount();
+    if (totalCount)
+        emit preClearSongs(totalCount - 1);
+    _pagedSongs.clear();
+    if (totalCount)
+        emit postSongRemoved();
+}
+
+void ClementineRemote::fetchPlaylistSongs(int index)
+{
+    if (!_pagedSongs.isActive())
+        return;
+
+    for (int page : _pagedSongs.pagesToFetch(index))
+        emit requestPlaylistSongsWindow(_pagedSongs.playlistID(),
+                                        PagedPlaylistSongs::pageOffset(page),
+                                        PagedPlaylistSongs::sPageSize);
+}
+
+void ClementineRemote::fetchVisibleSongs(int firstProxyRow, int lastProxyRow)
+{
+    if (!_pagedSongs.isActive())
+        return;
+
+    for (int proxyRow : {firstProxyRow, lastProxyRow})
+    {
+        QModelIndex srcIndex = _songsProxyModel->mapToSource(_songsProxyModel->index(proxyRow, 0));
+        if (srcIndex.isValid())
+            fetchPlaylistSongs(srcIndex.row());
+    }
+}
+
+void ClementineRemote::updateActiveSongIndex()
+{
+    if (_pagedSongs.isActive())
+    {
+        if (_activeSong.index >= 0 && _activeSong.index < _pagedSongs.totalCount())
+            _activeSongIndex = _activeSong.index;
+        return;
+    }
+
+    int row = _songsIndex.rowOfIndex(_songs, _activeSong.index);
+    if (row != -1)
+    {
+        _activeSongIndex = row;
+        qDebug() << "[ClementineRemote::updateActiveSongIndex] current song id: " << _activeSongIndex;
+    }
 }
 
 void ClementineRemote::rcvListOfRemoteFiles(const pb::remote::ResponseListFiles &files)
 {
+    M_TRACE_SCOPE("ClementineRemote::rcvListOfRemoteFiles");
     if (files.has_error() && files.error() != pb::remote::ResponseListFiles::NONE)
         sendError("", _remoteFilesListError(files.error(), files.relative_path()));
     else
@@ -1274,7 +2856,7 @@ void ClementineRemote::rcvListOfRemoteFiles(const pb::remote::ResponseListFiles
         qDebug() << "[MsgType::LIST_FILES] Nb Files: " << _remoteFiles.size();
 
 
-        _remoteFilesPath = files.relative_path().c_str();
+        _remoteFilesPath = Utf8::toQString(files.relative_path());
         _sessionsSaved[_sessionSelected]->setRemotePath(_remoteFilesPath);
         emit updateRemoteFilesPath(_remoteFilesPath);
     }
@@ -1283,6 +2865,7 @@ void ClementineRemote::rcvListOfRemoteFiles(const pb::remote::ResponseListFiles
 
 void ClementineRemote::rcvSavedRadios(const pb::remote::ResponseSavedRadios &radios)
 {
+    M_TRACE_SCOPE("ClementineRemote::rcvSavedRadios");
     if (_radioStreams.size())
     {
         emit preClearRadioStreams(_radioStreams.size() - 1);
@@ -1303,10 +2886,26 @@ void ClementineRemote::rcvSavedRadios(const pb::remote::ResponseSavedRadios &rad
     qDebug() << "[MsgType::REQUEST_SAVED_RADIOS] Nb Radio Streams: " << _radioStreams.size();
 }
 
+void ClementineRemote::rcvGlobalSearch(const pb::remote::ResponseGlobalSearch &results)
+{
+    int nbNewResults = _globalSearchModel->merge(results);
+    qDebug() << "[MsgType::GLOBAL_SEARCH_RESULT] search #" << results.id() << " from "
+             << Utf8::toQString(results.search_provider()) << ": " << results.song_metadata_size()
+             << " results, " << nbNewResults << " new ones" << (nbNewResults == -1 ? " (stale)" : "");
+}
+
+void ClementineRemote::rcvGlobalSearchStatus(const pb::remote::ResponseGlobalSearchStatus &status)
+{
+    bool finished = status.status() == pb::remote::GlobalSearchFinished;
+    qDebug() << "[MsgType::GLOBAL_SEARCH_STATUS] search #" << status.id() << (finished ? " finished" : " started");
+    if (_globalSearchModel->setStatus(status.id(), Utf8::toQString(status.query()), finished) && finished)
+        emit globalSearchStatus(false);
+}
+
 void ClementineRemote::dumpPlaylists()
 {
-    for (RemotePlaylist *p : _playlistsOpened)
-        qDebug() << "  - " << p->str();
+    for (const RemotePlaylist &p : qAsConst(_playlistsOpened))
+        qDebug() << "  - " << p.str();
 }
 
 void ClementineRemote::dumpCurrentPlaylist()
@@ -1322,6 +2921,67 @@ void ClementineRemote::dumpCurrentPlaylist()
 /// slots
 ////////////////////////////////
 
+void ClementineRemote::onChangePlaylist(qint32 pIdx)
+{
+    const RemotePlaylist *p = playlist(pIdx);
+    if (!p)
+    {
+        qCritical() << "[ClementineRemote::onChangePlaylist] Can't find playlist with index: " << pIdx;
+        return ;
+    }
+
+    if (p->id != _dispPlaylistId) // requesting the displayed one is a refresh
+    {
+        const CachedPlaylistSongs *cached = _playlistsCache.find(p->id, p->item_count, p->revision);
+        if (cached)
+        {
+            qDebug() << "[ClementineRemote::onChangePlaylist] display cached playlist #" << p->id
+                     << " (" << cached->songs.size() << " songs)";
+            bool upToDate = p->revision != -1 && cached->revision == p->revision;
+
+            _dispPlaylistId = p->id;
+            _dispSongsRevision = cached->revision;
+            updateCurrentPlaylist();
+            displaySongs(p->id, cached->songs);
+            updateActiveSongIndex();
+            if (isActivePlaylistDisplayed())
+                emit activeSongIdx(activeSongIndex());
+
+            if (upToDate)
+                return; // same revision than the server, nothing to fetch
+        }
+        else if (_pagedSongsSupport && p->item_count >= sPagedPlaylistMinSongs)
+        {
+            qDebug() << "[ClementineRemote::onChangePlaylist] display playlist #" << p->id
+                     << " by pages (" << p->item_count << " songs)";
+            _dispPlaylistId = p->id;
+            _dispSongsRevision = p->revision;
+            updateCurrentPlaylist();
+            displayPagedSongs(p->id, p->item_count);
+            updateActiveSongIndex();
+            if (isActivePlaylistDisplayed())
+                emit activeSongIdx(activeSongIndex());
+            // first page(s), the View will then fetch the ones of its visible range
+            setRequestSongsForPlaylistID(p->id);
+            fetchPlaylistSongs(isActivePlaylistDisplayed() ? _activeSongIndex : 0);
+            return;
+        }
+    }
+    else if (_pagedSongs.isActive() && _pagedSongs.playlistID() == p->id)
+    {
+        // refresh: drop the pages, the visible ones will be fetched again
+        displayPagedSongs(p->id, p->item_count);
+        updateActiveSongIndex();
+        setRequestSongsForPlaylistID(p->id);
+        fetchPlaylistSongs(isActivePlaylistDisplayed() ? _activeSongIndex : 0);
+        return;
+    }
+
+    // refresh in background (the cached songs are replaced in place when received)
+    setRequestSongsForPlaylistID(p->id);
+    emit requestPlaylistSongs(p->id);
+}
+
 #ifdef __USE_CONNECTION_THREAD__
 void ClementineRemote::onPlaylistsOpenedUpdatedByWorker()
 {
@@ -1329,6 +2989,12 @@ void ClementineRemote::onPlaylistsOpenedUpdatedByWorker()
     _playlistData.clear_response_playlists();
     _securePlaylists.unlock();
 }
+void ClementineRemote::onPlaylistDeltaByWorker()
+{
+    rcvPlaylistDelta(_songsData.response_playlist_delta());
+    _songsData.clear_response_playlist_delta();
+    _secureSongs.unlock();
+}
 void ClementineRemote::onSongsUpdatedByWorker(bool initialized)
 {
     rcvPlaylistSongs(_songsData.response_playlist_songs());
@@ -1346,20 +3012,72 @@ void ClementineRemote::onRemoteFilesUpdatedByWorker()
     _remoteFilesData.clear_response_list_files();
     _secureRemoteFilesData.unlock();
 }
+void ClementineRemote::onGlobalSearchByWorker()
+{
+    if (_globalSearchData.type() == pb::remote::GLOBAL_SEARCH_RESULT)
+        rcvGlobalSearch(_globalSearchData.response_global_search());
+    else
+        rcvGlobalSearchStatus(_globalSearchData.response_global_search_status());
+    _globalSearchData.Clear();
+    _secureGlobalSearch.unlock();
+}
 
 void ClementineRemote::onInitialized()
 {
-    _initialized = true;
+    _initialized = 0x1;
     qDebug() << "[MsgType::FIRST_DATA_SENT_COMPLETE] fully Initialized \\o/";
-    emit connected();
+    notifyConnected();
 
     if (!delayLibraryLoading())
         requestLibrary();
+    if (trackPositionIntervalMs() != sDefaultTrackPositionIntervalMs)
+        emit requestTrackPositionInterval(trackPositionIntervalMs());
 }
 #endif
 
+void ClementineRemote::connectionLost()
+{
+    qDebug() << "[ClementineRemote::connectionLost] keeping the data while reconnecting";
+    _reconnectTime.start();
+    _resumeAccepted = 0x0;
+    _resuming = 0x1;
+}
+
+void ClementineRemote::onSessionResumed()
+{
+    bool resumeAccepted = M_LoadAtomic(_resumeAccepted);
+    _resuming = 0x0;
+    qDebug() << "[ClementineRemote::onSessionResumed] in " << _reconnectTime.elapsed() << " ms ("
+             << (resumeAccepted ? "only the changes" : "all the data") << " received)";
+
+    // the pages requested before the disconnection won't come
+    for (int page : _pagedSongs.takePending())
+        emit requestPlaylistSongsWindow(_pagedSongs.playlistID(),
+                                        PagedPlaylistSongs::pageOffset(page),
+                                        PagedPlaylistSongs::sPageSize);
+
+    if (!resumeAccepted)
+    {   // we've missed the edits of the playlists that are not active
+        _playlistsCache.clear();
+        _playlistsSearch.clear();
+        if (_dispPlaylistId)
+        {
+            setRequestSongsForPlaylistID(_dispPlaylistId);
+            emit requestPlaylistSongs(_dispPlaylistId);
+        }
+    }
+
+    if (isLowPowerMode())
+        emit requestTrackPositionInterval(0);
+    else if (trackPositionIntervalMs() != sDefaultTrackPositionIntervalMs)
+        emit requestTrackPositionInterval(trackPositionIntervalMs());
+
+    emit reconnected();
+}
+
 void ClementineRemote::onLibraryDownloaded()
 {
+    M_TRACE_SCOPE("ClementineRemote::onLibraryDownloaded");
     QString host = sessionName();
     if (QSqlDatabase::contains(host))
         _libDB = QSqlDatabase::database(host);
@@ -1371,66 +3089,29 @@ void ClementineRemote::onLibraryDownloaded()
         return;
     }
 
-    emit _libModel->beginReset();
-    _libModel->clear();
-
     QElapsedTimer timeStart;
     timeStart.start();
 
-    int nbArtists = 0, nbAlbums = 0, nbTracks = 0;
+    // the current tree stays usable while the table is filled
+    LibraryTable table;
     QSqlQuery query(_libDB);
+    query.setForwardOnly(true);
     if(!query.exec(sLibrarySQL))
         qDebug() << "Can't Execute Query !";
     else
     {
-        QStandardItem *rootItem = _libModel->invisibleRootItem(),
-                *artistItem = nullptr, *albumItem = nullptr;
-        QString currentArtist, currentAlbum;
         while(query.next())
-        {
-            QString artist   = query.value(0).toString();
-            QString album    = query.value(1).toString();
-            QString title    = query.value(2).toString();
-            int     track    = query.value(3).toInt();
-            QString filename = query.value(4).toString();
-            ++nbTracks;
-
-            if (!artistItem || artist != currentArtist)
-            {
-                artistItem = new QStandardItem();
-                artistItem->setData(artist.isEmpty() ? tr("unset artist") : artist,
-                                    LibraryModel::name);
-                artistItem->setData(LibraryModel::Artist, LibraryModel::type);
-                rootItem->appendRow(artistItem);
-                currentArtist = artist;
-                ++nbArtists;
-            }
-
-            if (!albumItem || album != currentAlbum)
-            {
-                albumItem = new QStandardItem();
-                albumItem->setData(album.isEmpty() ? tr("unset album") : album,
-                                    LibraryModel::name);
-                albumItem->setData(LibraryModel::Album, LibraryModel::type);
-                artistItem->appendRow(albumItem);
-                currentAlbum = album;
-                ++nbAlbums;
-            }
-
-            QStandardItem *trackItem = new QStandardItem();
-            if (track == -1)
-                trackItem->setData(title, LibraryModel::name);
-            else
-                trackItem->setData(QString("%1 - %2").arg(track, 2, 10, QChar('0')).arg(title),
-                                   LibraryModel::name);
-            trackItem->setData(filename.toLower().endsWith("m3u")?LibraryModel::Playlist:LibraryModel::Track,
-                               LibraryModel::type);
-            trackItem->setData(filename, LibraryModel::url);
-            albumItem->appendRow(trackItem);
-        }
+            table.append(query.value(0).toString(), query.value(1).toString(), query.value(2).toString(),
+                         query.value(3).toString(), query.value(4).toInt(), query.value(5).toInt(),
+                         query.value(6).toString(), query.value(7).toString());
+        table.squeeze();
     }
-    emit _libModel->endReset();
+    int nbArtists = table.nbValues(LibraryTable::Field::artist),
+        nbAlbums  = table.nbValues(LibraryTable::Field::album),
+        nbTracks  = table.size();
+    _libModel->setTable(std::move(table));
     _libraryLoaded = true;
+    _libraryShed   = false;
     emit libraryLoaded(); // warn QML for easy-loading
 
     qint64 durationMS = timeStart.elapsed();
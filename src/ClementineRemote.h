@@ -22,27 +22,47 @@
 
 #include "utils/Singleton.h"
 #include "model/RemoteSongModel.h"
+#include "model/GlobalSearchModel.h"
 #include "model/LibraryModel.h"
+#include "model/PlaylistsSearchModel.h"
+#include "model/UpdateScheduler.h"
 #include "player/RemoteSong.h"
 #include "player/RemoteFile.h"
+#include "player/RemotePlaylist.h"
 #include "player/Stream.h"
+#include "player/PlaylistSongsCache.h"
+#include "player/PagedPlaylistSongs.h"
+#include "player/PlaybackClock.h"
+#include "player/PlaylistsSearchIndex.h"
+#include "player/SongsIndex.h"
+#include "player/SongsSorter.h"
 #include "utils/Macro.h"
+#include "utils/MemoryPressure.h"
+#include "utils/PendingOperations.h"
+#include "utils/ServerDiscovery.h"
+#include "utils/TraceRecorder.h"
 #include <QSettings>
 #include <QUrl>
 #include <QSqlDatabase>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QTimer>
 #ifdef __USE_CONNECTION_THREAD__
 #include <QThread>
 #include <QMutex>
 #endif
 class ClementineSession;
 class ConnectionWorker;
-class RemotePlaylist;
+class SessionStore;
 class PlaylistModel;
 
 class ClementineRemote : public QObject, public Singleton<ClementineRemote>
 {
     Q_OBJECT
     friend class Singleton<ClementineRemote>;
+    friend class ClementineBench; //!< bench/ClementineBench.cpp
 
     static const QString sVersion;  //!< Version of the Application
     static const QString sAppName;  //!< Name of the Application
@@ -53,13 +73,25 @@ class ClementineRemote : public QObject, public Singleton<ClementineRemote>
     static const QString sClementineReleaseURL;
     static const int     sSockTimeoutMs = 2000;
     static const uint    sDefaultIconSize = 42;
+    static const int     sPagedPlaylistMinSongs = 5000; //!< bigger playlists are fetched by pages
+    static const int     sDefaultTrackPositionIntervalMs = 1000; //!< Clementine default
+#if defined(Q_OS_ANDROID)
+    static const int     sDefaultMemoryThresholdMB = 256; //!< polling of the resident memory (on top of onTrimMemory)
+#else
+    static const int     sDefaultMemoryThresholdMB = 0; //!< no polling of the resident memory
+#endif
 
     enum class Settings {
         session, host, port, pass, lastSession,
         downloadPath, remotePath,
         verticalVolume, iconSize,
         dispArtistInTrackName,
-        delayLibraryLoading
+        delayLibraryLoading,
+        playlistsCacheSizeMB,
+        trackPositionIntervalMs,
+        speculativeConnect,
+        memoryThresholdMB,
+        libraryHierarchy
     };
     static const QMap<Settings, QString> sSettings;
 
@@ -98,19 +130,25 @@ private:
     pb::remote::ShuffleMode _shuffleMode;       //!< server shuffle mode
     pb::remote::RepeatMode  _repeatMode;        //!< server repeat mode
 
-    QList<RemotePlaylist*>  _playlistsOpened;  //!< list of all the opened Playlists (both locally and on server)
-    QList<RemotePlaylist*>  _playlistsClosed;  //!< list of all the closed Playlists (available to open)
+    PendingOperations       _pendingOps;        //!< user requests displayed before the echo of the server
+    QTimer                  _pendingOpsTimer;   //!< to rollback the ones without echo
+
+    QVector<RemotePlaylist> _playlistsOpened;  //!< list of all the opened Playlists (both locally and on server)
+    QVector<RemotePlaylist> _playlistsClosed;  //!< list of all the closed Playlists (available to open)
 #ifdef __USE_CONNECTION_THREAD__
     QMutex                  _securePlaylists;
     pb::remote::Message     _playlistData;
 #endif
-    RemotePlaylist         *_dispPlaylist;      //!< Playlist displayed on the Remote
     qint32                  _dispPlaylistId;    //!< ID of the displayed Playlist
-    qint32                  _dispPlaylistIndex; //!< index in _playlistsOpened of the displayed Playlist
+    qint32                  _dispPlaylistIndex; //!< index in _playlistsOpened of the displayed Playlist (-1 if none)
+    QHash<qint32, int>      _openedPlaylistRows; //!< playlist ID -> index in _playlistsOpened
+    qint32                  _playingPlaylistId;  //!< the one flagged RemotePlaylist::playing
     PlaylistModel          *_plOpenedModel;
     PlaylistModel          *_plClosedModel;
 
     QList<RemoteSong>       _songs;             //!< list of Song of the Playlist displayed on the Remote
+    SongsIndex              _songsIndex;        //!< id/index -> row and selection of _songs
+    SongsSorter             _songsSorter;       //!< client side sort of _songs (ranks used by the proxy)
     RemoteSong              _activeSong;        //!< song played (or about to) on the server (pb::remote::CURRENT_METAINFO)
     qint32                  _activeSongIndex;   //!< active song index in _songs
 #ifdef __USE_CONNECTION_THREAD__
@@ -119,13 +157,39 @@ private:
 #endif
     RemoteSongModel        *_songsModel;     //!< Model used to expose the songs to the View
     RemoteSongProxyModel   *_songsProxyModel;//!< Proxy model used by QML ListView
+    PlaylistSongsCache      _playlistsCache; //!< LRU of the songs of the playlists recently received
+    PagedPlaylistSongs      _pagedSongs;     //!< songs of the displayed playlist when it is fetched by pages
+    PlaylistsSearchIndex    _playlistsSearch;      //!< words of the songs of all the playlists received
+    PlaylistsSearchModel   *_playlistsSearchModel; //!< hits of the last search across the playlists
+    qint32                  _searchHitPlaylistID;  //!< hit to show once its playlist is displayed
+    qint32                  _searchHitSongID;
+    int                     _searchHitRow;         //!< when indexed (for the paged playlists)
+    bool                    _pagedSongsSupport; //!< false once the server answered a windowed request with the whole playlist
+    qint32                  _songDetailsPlaylistID; //!< playlist of the song waiting for its full metadata
+    int                     _songDetailsIndex;      //!< row of the song waiting for its full metadata
+    qint32                  _dispSongsRevision;     //!< revision of the displayed songs (-1 if unknown)
+    qint32                  _songsPlaylistId;       //!< playlist of _songs (-1 if none)
 
     qint32                  _activePlaylistId;  //!<  ID of the playlist of the active song
     QAtomicInt              _requestSongsForPlaylistID;
 
     qint32                  _trackPostition;    //!< position in the track of the active song (pb::remote::UPDATE_TRACK_POSITION)
+    PlaybackClock           _playbackClock;     //!< extrapolation of the position between two UPDATE_TRACK_POSITION
+
+    AtomicBool              _lowPower;          //!< app in background: nothing is displayed
+    QElapsedTimer           _powerModeTime;     //!< since the last change of power mode
+    int                     _powerModeReadyReads; //!< readyRead handled by the ConnectionWorker at the last change of power mode
+#ifdef __USE_CONNECTION_THREAD__
+    QMutex                  _secureDeferred;
+#endif
+    pb::remote::Message     _deferredPlaylists; //!< latest PLAYLISTS received in low power
+    QHash<qint32, pb::remote::Message> _deferredSongs; //!< latest PLAYLIST_SONGS of each playlist received in low power
+    QSet<qint32>            _playlistsToResync; //!< playlists edited (PLAYLIST_DELTA) in low power
 
-    bool                    _initialized;       //!< did we receive pb::remote::FIRST_DATA_SENT_COMPLETE ?
+    AtomicBool              _initialized;       //!< did we receive pb::remote::FIRST_DATA_SENT_COMPLETE ? (read by the worker)
+    AtomicBool              _resuming;          //!< connection lost, all the data is kept until we're resynced
+    AtomicBool              _resumeAccepted;    //!< the server only sends what changed (SESSION_TOKEN)
+    QElapsedTimer           _reconnectTime;     //!< since the connection was lost
 
     bool                    _clemFilesSupport;
     QString                 _remoteFilesPath;
@@ -149,6 +213,12 @@ private:
     LibraryModel *_libModel;
     LibraryProxyModel *_libProxyModel;
 
+    GlobalSearchModel *_globalSearchModel; //!< results streamed by the GLOBAL_SEARCH of the server
+#ifdef __USE_CONNECTION_THREAD__
+    QMutex              _secureGlobalSearch; //!< results and status in the same handover to keep their order
+    pb::remote::Message _globalSearchData;
+#endif
+
 #ifdef __USE_CONNECTION_THREAD__
     QMutex _secureUserMsg;
 #endif
@@ -160,8 +230,23 @@ private:
     QList<ClementineSession*> _sessionsSaved;
     int                       _sessionSelected;
     static const QString sQuickSessionName;
+    ServerDiscovery           _discovery;
+
+    QElapsedTimer      _launchTime;          //!< since the construction (i.e. the start of the application)
+    QElapsedTimer      _connectTime;         //!< since the connection request
+    ClementineSession *_speculativeSession;  //!< connected at launch (before the UI is loaded)
+    bool               _uiAttached;          //!< QML is loaded: connected() can be emitted
+    qint64             _timeToInteractiveMs; //!< -1 until connected() is emitted
+
+    QHash<ClementineSession*, ConnectionWorker*> _backgroundSessions; //!< multi-room: connected but not displayed
+    QElapsedTimer      _switchTime;
+
+    QTimer             _memoryLogTimer;      //!< periodic log of the memoryReport (stopped by default)
+    MemoryPressure     _memoryPressure;
+    UpdateScheduler    _updates;             //!< dataChanged and notifications emitted once per frame
 
     bool _libraryLoaded;
+    bool _libraryShed;   //!< library tree dropped by a memory pressure (to reload from the DB)
 
 
 private:
@@ -175,13 +260,25 @@ public:
 
     Q_INVOKABLE void close();
     void clearData(const QString &reason);
+    void connectionLost(); //!< called by the ConnectionWorker before trying to reconnect
+
+private:
+    void startSpeculativeConnection();
+    void notifyConnected(); //!< or wait for the UI
+
+    void resetSessionData();
+    ConnectionWorker *newConnection();
+    void finishSwitchToSession(ClementineSession *target, ConnectionWorker *closedWorker);
+
+public:
 
     Q_INVOKABLE QString testDownloadPath();
     Q_INVOKABLE QString downloadPath();
     Q_INVOKABLE QUrl    downloadPathURL();
     Q_INVOKABLE void updateDownloadPath(const QString &newPath);
 
-    void parseMessage(const QByteArray& data);
+    //! store: the one of the worker that read the message (nullptr when it is replayed from it)
+    void parseMessage(const QByteArray& data, SessionStore *store = nullptr);
 
 
     ////////////////////////////////
@@ -200,6 +297,23 @@ public:
     Q_INVOKABLE void getLibrary();
     inline Q_INVOKABLE bool isLibraryLoaded() const;
     Q_INVOKABLE void requestLibrary();
+    //! LibraryTable::Hierarchy: artist/album, album artist/album, genre/artist/album, year/album (saved)
+    inline Q_INVOKABLE int libraryHierarchy() const;
+    Q_INVOKABLE void setLibraryHierarchy(int hierarchy);
+
+
+    ////////////////////////////////
+    /// Global Search methods
+    ////////////////////////////////
+
+    static const int sGlobalSearchMinLength = 2; //!< a single letter would match the whole collection
+
+    //! sends GLOBAL_SEARCH on each keystroke: the results of the previous query still coming are dropped
+    Q_INVOKABLE void globalSearch(const QString &query);
+    inline Q_INVOKABLE QAbstractItemModel *modelGlobalSearch() const;
+    inline Q_INVOKABLE bool isGlobalSearching() const;
+    inline Q_INVOKABLE QString globalSearchStats() const;
+    Q_INVOKABLE void appendGlobalSearchResult(int row, const QString &newPlaylistName);
 
 
     ////////////////////////////////
@@ -220,6 +334,20 @@ public:
     inline Q_INVOKABLE bool delayLibraryLoading() const;
     inline Q_INVOKABLE void setDelayLibraryLoading(bool delay);
 
+    inline Q_INVOKABLE bool speculativeConnect() const;
+    inline Q_INVOKABLE void setSpeculativeConnect(bool connectAtLaunch);
+
+    inline Q_INVOKABLE int playlistsCacheSizeMB() const;
+    inline Q_INVOKABLE void setPlaylistsCacheSizeMB(int sizeMB);
+
+    inline Q_INVOKABLE int memoryThresholdMB() const;
+    inline Q_INVOKABLE void setMemoryThresholdMB(int thresholdMB); //!< resident memory (0: no polling)
+    Q_INVOKABLE void lowMemoryWarning();               //!< from the OS: drops all the caches
+    Q_INVOKABLE void simulateMemoryPressure(int tier); //!< test hook (cf MemoryPressure::Tier)
+
+    inline Q_INVOKABLE int trackPositionIntervalMs() const;
+    Q_INVOKABLE void setTrackPositionIntervalMs(int intervalMs);
+
     inline Q_INVOKABLE uint iconSize() const;
     inline Q_INVOKABLE void setIconSize(uint size);        
     inline Q_INVOKABLE bool hideServerFilesPreviousNextNavButtons() const;
@@ -248,6 +376,19 @@ public:
     inline Q_INVOKABLE ushort repeatMode() const;
     inline Q_INVOKABLE ushort shuffleMode()const;
 
+    inline Q_INVOKABLE QString optimisticUpdatesStats() const;
+    inline Q_INVOKABLE QString modelUpdatesStats() const; //!< merges of the UpdateScheduler
+
+    Q_INVOKABLE int trackPositionMs(); //!< extrapolated (to be called at the display rate)
+
+    inline Q_INVOKABLE bool isLowPowerMode() const;
+    Q_INVOKABLE void setLowPowerMode(bool lowPower); //!< driven by the application state (or manually)
+    Q_INVOKABLE double readyReadsPerMinute() const; //!< readyRead of the ConnectionWorker (not CPU wakeups) since the last power mode change
+
+    Q_INVOKABLE void setTracing(bool enabled); //!< timeline of the GUI and ConnectionWorker threads
+    inline Q_INVOKABLE bool isTracing() const;
+    Q_INVOKABLE QString exportTrace();         //!< Chrome trace-event JSON in the download folder
+
     Q_INVOKABLE bool isConnected() const;
     Q_INVOKABLE void cancelDownload() const;
 
@@ -262,6 +403,29 @@ public:
     Q_INVOKABLE int createNewSession(const QString &sessionName, const QString &host, int port, int pass);
     Q_INVOKABLE void deleteCurrentSession();
     Q_INVOKABLE void saveSessions();
+    Q_INVOKABLE void discoverServers(ushort port); //!< the servers found are added to the sessions
+    Q_INVOKABLE void stopDiscovery();
+
+    Q_INVOKABLE void attachUI(); //!< when QML is loaded
+
+    //! multi-room: the current session stays connected in background (on the same thread)
+    Q_INVOKABLE void switchToSession(int sessionIndex);
+    Q_INVOKABLE QStringList connectedSessions() const;
+    Q_INVOKABLE QString sessionsReport() const; //!< memory used by each session
+
+    typedef struct MemoryAccount
+    {
+        QString name;
+        qint64  bytes; //!< estimation of the live bytes
+        int     count; //!< objects accounted
+    } MemoryAccount;
+
+    QList<MemoryAccount> memoryAccounts(); //!< by subsystem (GUI Thread)
+    Q_INVOKABLE QVariantList memoryReport(); //!< memoryAccounts + total (for the debug overlay)
+    Q_INVOKABLE QString memoryReportStr();
+    Q_INVOKABLE void setMemoryLogPeriod(int periodSec); //!< 0 to stop logging the memoryReport
+    inline UpdateScheduler *updateScheduler();
+    inline Q_INVOKABLE qint64 timeToInteractiveMs() const;
 
     ////////////////////////////////
     /// Playlist methods
@@ -272,8 +436,8 @@ public:
 
     inline int modelRowFromProxyRow(int proxyRow) const;
 
-    inline const QList<RemotePlaylist*> &playlists() const;
-    inline RemotePlaylist *playlist(int idx, bool closedPlaylists= false) const;
+    inline const QVector<RemotePlaylist> &playlists() const;
+    inline const RemotePlaylist *playlist(int idx, bool closedPlaylists= false) const; //!< valid until the next PLAYLISTS
     inline Q_INVOKABLE int playlistIndex() const;
     inline Q_INVOKABLE int playlistID() const;
     inline int numberOfPlaylists(bool closedPlaylists = false) const;
@@ -325,6 +489,20 @@ public:
     inline int numberOfPlaylistSongs() const;
     inline const RemoteSong &playlistSong(int index) const;
     inline RemoteSong &playlistSong(int index);
+    inline bool isPlaylistSongLoaded(int index) const;
+    inline void setSongSelected(int index, bool selected); //!< keeps the SongsIndex in sync
+    inline bool hasSongsIndex() const;  //!< false for the paged songs
+    inline QList<int> selectedSongRows(); //!< sorted (hidden or filtered ones included)
+    inline int songRank(int index);       //!< position of the song once sorted (RemoteSongProxyModel)
+
+    //! column of SongsSorter::Column: becomes the primary sort key (reversed if it already was)
+    Q_INVOKABLE void sortSongs(int column);
+    Q_INVOKABLE void clearSongsSort(); //!< back to the playlist order
+    inline Q_INVOKABLE int songsSortColumn() const; //!< primary key (0 when not sorted)
+    void fetchPlaylistSongs(int index);
+    //! paged playlist: requests the pages of the rows displayed (called by the View when it scrolls)
+    Q_INVOKABLE void fetchVisibleSongs(int firstProxyRow, int lastProxyRow);
+    Q_INVOKABLE void requestSongDetails(int songIndex); //!< playlist songs only have sPlaylistFieldsMask
 
     inline Q_INVOKABLE const QString activeTrackName() const;
     inline Q_INVOKABLE const QString activeTrackDuration() const;
@@ -335,6 +513,14 @@ public:
 
     Q_INVOKABLE void setSongsFilter(const QString &searchTxt);
 
+    //! search in all the playlists received (PlaylistsSearchIndex), cf modelPlaylistsSearch
+    Q_INVOKABLE void searchPlaylists(const QString &query);
+    inline Q_INVOKABLE QAbstractItemModel *modelPlaylistsSearch() const;
+    Q_INVOKABLE void showPlaylistsSearchHit(int hitRow); //!< switch to its playlist (from the cache if possible)
+    inline Q_INVOKABLE QString playlistsSearchStats() const; //!< index size and last query latency
+    inline const PlaylistsSearchIndex &playlistsSearchIndex() const;
+    QString openedPlaylistName(qint32 playlistID) const;
+
     Q_INVOKABLE void deleteSelectedSongs();
     Q_INVOKABLE void downloadSelectedSongs();
     Q_INVOKABLE bool appendSongsToOtherPlaylist();
@@ -364,10 +550,44 @@ private:
     void setRemotePathForHost();
     void updateCurrentPlaylist();
 
+    void displaySongs(qint32 playlistID, const QList<RemoteSong> &songs);
+    void displayPagedSongs(qint32 playlistID, int totalCount);
+    void leavePagedSongs();
+    void retainStoredPlaylists(); //!< the PLAYLIST_SONGS of the SessionStore follow _playlistsCache
+    void indexStalePlaylist();    //!< the displayed songs edited by PLAYLIST_DELTA in _playlistsSearch
+    void updateActiveSongIndex();
+
+    inline void invalidateSongsIndexes(); //!< on each structural change of _songs
     void rcvPlaylists(const pb::remote::ResponsePlaylists &playlists);
+    //! keyed by id: updates the rows in place and only emits the removals, moves and insertions needed
+    void reconcilePlaylists(PlaylistModel *model, QVector<RemotePlaylist> &playlists,
+                            const QVector<RemotePlaylist> &newPlaylists);
     void rcvPlaylistSongs(const pb::remote::ResponsePlaylistSongs &songs);
+    void rcvPlaylistSongsPage(const pb::remote::ResponsePlaylistSongs &songs);
+    void rcvSongDetails(const pb::remote::SongMetadata &song);
+    void rcvPlaylistDelta(const pb::remote::ResponsePlaylistDelta &delta);
+    //! every op fits the size of the playlist (as the previous ones left it) and item_count matches
+    static bool isValidPlaylistDelta(const pb::remote::ResponsePlaylistDelta &delta, int nbSongs);
+    bool applyPlaylistDelta(const pb::remote::ResponsePlaylistDelta &delta);
+    void showSearchHitSong(); //!< the playlist of the pending search hit is displayed
+    static int shiftedRow(int row, const pb::remote::PlaylistDeltaOp &op); //!< row once op is applied
+
+    RemotePlaylist *openedPlaylistWithID(qint32 playlistID);
+    inline const RemotePlaylist *dispPlaylist() const;
+    static int deltaItemCount(const pb::remote::ResponsePlaylistDelta &delta, int nbSongs);
+
+    void addPendingOperation(PendingOperations::Type type, qint32 expected, qint32 previous, qint32 key = -1);
+    void rollbackOperation(const PendingOperations::Operation &op);
+    void rcvEngineState(pb::remote::EngineState state);
+    void reconcileRemovedSongs(qint32 playlistID, int nbSongs);
+    void showOptimisticActiveSong(int proxyRow);
+
+    bool deferInLowPower(pb::remote::Message &msg); //!< keeps the latest snapshots (called by the ConnectionWorker)
+    void resyncAfterLowPower();
     void rcvListOfRemoteFiles(const pb::remote::ResponseListFiles &files);
     void rcvSavedRadios(const pb::remote::ResponseSavedRadios &radios);
+    void rcvGlobalSearch(const pb::remote::ResponseGlobalSearch &results);
+    void rcvGlobalSearchStatus(const pb::remote::ResponseGlobalSearchStatus &status);
 
     void dumpPlaylists();
     void dumpCurrentPlaylist();
@@ -382,6 +602,9 @@ signals:
 
     void changeToSong(int proxyRow);
     void setTrackPostion(qint32 newPos);
+    void requestTrackPositionInterval(qint32 intervalMs);
+    void trackPositionReceived(qint32 pos); //!< from the ConnectionWorker
+    void lowPowerModeChanged(bool lowPower);
     void setVolume(qint32 vol);
 
     void setEngineState(qint32 state);
@@ -411,9 +634,13 @@ signals:
 
     void libraryDownloaded();
     void libraryLoaded();
+    void libraryShed(); //!< the library has to be requested again
 
     void insertUrls(qint32 playlistID, const QString &newPlaylistName);
 
+    void requestGlobalSearch(const QString &query);
+    void globalSearchStatus(bool searching); //!< started or finished (results are appended to modelGlobalSearch)
+
 
     // signals sent from ConnectionWorker to QML
     void info(const QString &title, const QString &msg);
@@ -422,6 +649,11 @@ signals:
     void connected();
     void disconnected(QString reason);
     void connectionError(const QString &err);
+    void reconnecting(int attempt, int delayMs);
+    void reconnected();
+    void serverDiscovered(int sessionIndex);
+    void discoveryFinished(int nbServers);
+    void sessionResumed(); //!< FIRST_DATA_SENT_COMPLETE after a reconnection
 
     void activeSongIdx(qint32 idx);
     void activeSongDetails(const QString &name, qint32 length, const QString &pretty_length);
@@ -433,6 +665,11 @@ signals:
     void updateRepeat(ushort mode);
 
     void changePlaylist(qint32 idx);
+    void requestPlaylistSongs(qint32 playlistID);
+    void requestPlaylistSongsWindow(qint32 playlistID, qint32 offset, qint32 limit);
+    void requestSongMetadata(qint32 playlistID, qint32 songIndex);
+    void songDetailsReceived(int songIndex);
+    void showSong(int proxyRow); //!< hit of a search across the playlists
     void updatePlaylist(int idx);
     void updatePlaylists();
 
@@ -448,6 +685,11 @@ signals:
     void postSongAppended();
     void preClearSongs(int lastSongIdx);
     void postSongRemoved();
+    void preInsertSongs(int firstSongIdx, int lastSongIdx); //!< ended by postSongAppended
+    void preRemoveSongs(int firstSongIdx, int lastSongIdx); //!< ended by postSongRemoved
+    void preMoveSongs(int firstSongIdx, int lastSongIdx, int destinationIdx);
+    void postSongsMoved();
+    void songsUpdated(int firstSongIdx, int lastSongIdx);
 
     // signals for RemoteFileModel
     void preAddRemoteFiles(int lastIdx);
@@ -466,17 +708,33 @@ signals:
     void initialized();
     void playlistsOpenedUpdatedByWorker();
     void songsUpdatedByWorker(bool initialized);
+    void playlistDeltaByWorker();
     void remoteFilesUpdatedByWorker();
+    void globalSearchByWorker();
 
 private slots:
     void onPlaylistsOpenedUpdatedByWorker();
     void onSongsUpdatedByWorker(bool initialized);
+    void onPlaylistDeltaByWorker();
     void onRemoteFilesUpdatedByWorker();
+    void onGlobalSearchByWorker();
     void onInitialized();
 #endif
 
 private slots:
     void onLibraryDownloaded();
+    void onSessionResumed();
+    void onServerFound(const QString &host, ushort port, const QString &version, bool authRequired);
+    void onChangePlaylist(qint32 pIdx);
+
+    void onShuffleRequested(ushort mode);
+    void onRepeatRequested(ushort mode);
+    void onNextSongRequested();
+    void onTrackPositionReceived(qint32 pos);
+    void onApplicationStateChanged(Qt::ApplicationState state);
+    void onPreviousSongRequested();
+    void onCheckPendingOperations();
+    void onShedMemory(MemoryPressure::Tier tier);
 
 
 
@@ -566,6 +824,7 @@ QString ClementineRemote::disconnectReason(int reason) const
 
 const QString &ClementineRemote::libraryPath() const{ return _libraryPath; }
 QAbstractItemModel *ClementineRemote::libraryModel() const{ return _libProxyModel; }
+UpdateScheduler *ClementineRemote::updateScheduler() { return &_updates; }
 
 bool ClementineRemote::isLibraryItemTrack(const QModelIndex &index) const
 {
@@ -590,6 +849,10 @@ QString ClementineRemote::libraryItemIcon(const QModelIndex &index) const
         return "icons/x-clementine-artist.png";
     case LibraryModel::Album:
         return "icons/nocover.png";
+    case LibraryModel::Genre:
+        return "icons/library.png";
+    case LibraryModel::Year:
+        return "icons/folder.png";
     case LibraryModel::Track:
         return "icons/music.png";
     case LibraryModel::Playlist:
@@ -600,6 +863,11 @@ QString ClementineRemote::libraryItemIcon(const QModelIndex &index) const
 }
 
 bool ClementineRemote::isLibraryLoaded() const { return _libraryLoaded; }
+int ClementineRemote::libraryHierarchy() const { return static_cast<int>(_libModel->hierarchy()); }
+
+QAbstractItemModel *ClementineRemote::modelGlobalSearch() const { return _globalSearchModel; }
+bool ClementineRemote::isGlobalSearching() const { return _globalSearchModel->isSearching(); }
+QString ClementineRemote::globalSearchStats() const { return _globalSearchModel->stats(); }
 
 
 ////////////////////////////////
@@ -624,6 +892,30 @@ void ClementineRemote::setDispArtistInTrackName(bool display)
 bool ClementineRemote::delayLibraryLoading() const { return _settings.value(sSettings[Settings::delayLibraryLoading], true).toBool(); }
 void ClementineRemote::setDelayLibraryLoading(bool delay) { _settings.setValue(sSettings[Settings::delayLibraryLoading], delay);}
 
+bool ClementineRemote::speculativeConnect() const { return _settings.value(sSettings[Settings::speculativeConnect], false).toBool(); }
+void ClementineRemote::setSpeculativeConnect(bool connectAtLaunch) { _settings.setValue(sSettings[Settings::speculativeConnect], connectAtLaunch); }
+
+qint64 ClementineRemote::timeToInteractiveMs() const { return _timeToInteractiveMs; }
+
+int ClementineRemote::trackPositionIntervalMs() const
+{
+    return _settings.value(sSettings[Settings::trackPositionIntervalMs], sDefaultTrackPositionIntervalMs).toInt();
+}
+
+int ClementineRemote::playlistsCacheSizeMB() const { return _playlistsCache.maxSizeMB(); }
+void ClementineRemote::setPlaylistsCacheSizeMB(int sizeMB)
+{
+    _playlistsCache.setMaxSizeMB(sizeMB);
+    _settings.setValue(sSettings[Settings::playlistsCacheSizeMB], sizeMB);
+}
+
+int ClementineRemote::memoryThresholdMB() const { return _memoryPressure.thresholdMB(); }
+void ClementineRemote::setMemoryThresholdMB(int thresholdMB)
+{
+    _memoryPressure.setThresholdMB(thresholdMB);
+    _settings.setValue(sSettings[Settings::memoryThresholdMB], thresholdMB);
+}
+
 
 
 uint ClementineRemote::iconSize() const { return _settings.value(sSettings[Settings::iconSize], sDefaultIconSize).toUInt(); }
@@ -654,6 +946,7 @@ QString ClementineRemote::volumePct() const { return QString("%1%").arg(_volume)
 
 void ClementineRemote::setCurrentVolume(qint32 vol)
 {
+    addPendingOperation(PendingOperations::Type::volume, vol, _volume);
     _volume = vol;
     emit setVolume(vol);
 }
@@ -666,6 +959,8 @@ void ClementineRemote::playpause()
     else
         _clemState = pb::remote::EngineState::Playing;
 
+    addPendingOperation(PendingOperations::Type::engineState, _clemState, _previousClemState);
+    emit updateEngineState();
     emit setEngineState(_clemState);
 }
 
@@ -673,12 +968,29 @@ void ClementineRemote::stop()
 {
     _previousClemState = _clemState;
     _clemState         =  pb::remote::EngineState::Idle;
+    addPendingOperation(PendingOperations::Type::engineState, _clemState, _previousClemState);
+    emit updateEngineState();
     emit setEngineState(_clemState);
 }
 
 ushort ClementineRemote::repeatMode()  const { return sQmlRepeatCodes.value(_repeatMode); }
 ushort ClementineRemote::shuffleMode() const { return sQmlShuffleCodes.value(_shuffleMode); }
 
+QString ClementineRemote::optimisticUpdatesStats() const { return _pendingOps.stats(); }
+QString ClementineRemote::modelUpdatesStats() const { return _updates.stats(); }
+QAbstractItemModel *ClementineRemote::modelPlaylistsSearch() const { return _playlistsSearchModel; }
+const PlaylistsSearchIndex &ClementineRemote::playlistsSearchIndex() const { return _playlistsSearch; }
+QString ClementineRemote::playlistsSearchStats() const
+{
+    return QString("%1 playlists, %2 songs, %3 words, %4 KB, last query: %5 us").arg(
+                _playlistsSearch.nbPlaylists()).arg(_playlistsSearch.nbSongs()).arg(
+                _playlistsSearch.nbTokens()).arg(_playlistsSearch.memoryUsage() / 1024).arg(
+                _playlistsSearch.lastQueryUs());
+}
+
+bool ClementineRemote::isLowPowerMode() const { return M_LoadAtomic(_lowPower); }
+bool ClementineRemote::isTracing() const { return TraceRecorder::isEnabled(); }
+
 
 ////////////////////////////////
 /// Playlist methods
@@ -699,15 +1011,14 @@ int ClementineRemote::modelRowFromProxyRow(int proxyRow) const
     return -1;
 }
 
-const QList<RemotePlaylist *> &ClementineRemote::playlists() const { return _playlistsOpened; }
-RemotePlaylist *ClementineRemote::playlist(int idx, bool closedPlaylists) const
+const QVector<RemotePlaylist> &ClementineRemote::playlists() const { return _playlistsOpened; }
+const RemotePlaylist *ClementineRemote::playlist(int idx, bool closedPlaylists) const
 {
-    if ( closedPlaylists )
-        return idx < _playlistsClosed.size() ? _playlistsClosed.at(idx) : nullptr;
-    else
-        return idx < _playlistsOpened.size() ? _playlistsOpened.at(idx) : nullptr;
+    const QVector<RemotePlaylist> &playlists = closedPlaylists ? _playlistsClosed : _playlistsOpened;
+    return idx >= 0 && idx < playlists.size() ? &playlists.at(idx) : nullptr;
 }
-int ClementineRemote::playlistIndex() const { return _dispPlaylistIndex; }
+const RemotePlaylist *ClementineRemote::dispPlaylist() const { return playlist(_dispPlaylistIndex); }
+int ClementineRemote::playlistIndex() const { return qMax(0, _dispPlaylistIndex); }
 int ClementineRemote::playlistID() const { return _dispPlaylistId; }
 
 int ClementineRemote::numberOfPlaylists(bool closedPlaylists) const
@@ -745,14 +1056,16 @@ RemoteFile &ClementineRemote::remoteFile(int index) { return _remoteFiles[index]
 ////////////////////////////////
 
 QAbstractItemModel *ClementineRemote::modelRemoteSongs() const { return _songsProxyModel; }
-int ClementineRemote::nbSongs() const { return _songs.size(); }
+int ClementineRemote::nbSongs() const { return numberOfPlaylistSongs(); }
 bool ClementineRemote::allSongsSelected() const { return _songsProxyModel->allSongsSelected(); }
 void ClementineRemote::selectAllSongsFromProxyModel(bool selectAll)
 {
     _songsProxyModel->selectAllSongs(selectAll);
 }
 int ClementineRemote::activeSongIndex() const
-{   
+{
+    if (_songsProxyModel->isIdentity())
+        return _activeSongIndex >= 0 && _activeSongIndex < numberOfPlaylistSongs() ? _activeSongIndex : -1;
     QModelIndex modelIndex = _songsModel->index(_activeSongIndex, 0);
     if (modelIndex.isValid())
     {
@@ -762,9 +1075,43 @@ int ClementineRemote::activeSongIndex() const
     }
     return -1;
 }
-int ClementineRemote::numberOfPlaylistSongs() const { return _songs.size(); }
-const RemoteSong &ClementineRemote::playlistSong(int index) const { return _songs.at(index); }
-RemoteSong &ClementineRemote::playlistSong(int index) { return _songs[index]; }
+int ClementineRemote::numberOfPlaylistSongs() const
+{
+    return _pagedSongs.isActive() ? _pagedSongs.totalCount() : _songs.size();
+}
+const RemoteSong &ClementineRemote::playlistSong(int index) const
+{
+    return _pagedSongs.isActive() ? _pagedSongs.song(index) : _songs.at(index);
+}
+RemoteSong &ClementineRemote::playlistSong(int index)
+{
+    return _pagedSongs.isActive() ? _pagedSongs.song(index) : _songs[index];
+}
+bool ClementineRemote::isPlaylistSongLoaded(int index) const
+{
+    return _pagedSongs.isActive() ? _pagedSongs.isLoaded(index) : true;
+}
+void ClementineRemote::setSongSelected(int index, bool selected)
+{
+    playlistSong(index).selected = selected;
+    if (!_pagedSongs.isActive())
+        _songsIndex.setSelected(index, selected);
+}
+void ClementineRemote::invalidateSongsIndexes()
+{
+    _songsIndex.invalidate();
+    _songsSorter.invalidate();
+}
+bool ClementineRemote::hasSongsIndex() const { return !_pagedSongs.isActive(); }
+QList<int> ClementineRemote::selectedSongRows() { return _songsIndex.selectedRows(_songs); }
+int ClementineRemote::songRank(int index)
+{
+    return _pagedSongs.isActive() ? index : _songsSorter.rank(_songs, index);
+}
+int ClementineRemote::songsSortColumn() const
+{
+    return _songsSorter.isSorted() ? static_cast<int>(_songsSorter.keys().first().column) : 0;
+}
 
 const QString ClementineRemote::activeTrackName() const{ return _activeSong.name(); }
 const QString ClementineRemote::activeTrackDuration() const { return _activeSong.pretty_length; }
@@ -825,9 +1172,9 @@ QString ClementineRemote::_remoteFilesListError(pb::remote::ResponseListFiles::E
     case pb::remote::ResponseListFiles::ROOT_DIR_NOT_SET:
         return tr("The root directory is not set on Clementine server...");
     case pb::remote::ResponseListFiles::DIR_NOT_ACCESSIBLE:
-        return tr("The directory %1 is not accessible on Clementine server...").arg(relativePath.c_str());
+        return tr("The directory %1 is not accessible on Clementine server...").arg(Utf8::toQString(relativePath));
     case pb::remote::ResponseListFiles::DIR_NOT_EXIST:
-        return tr("The directory %1 doesn't exist on Clementine server...").arg(relativePath.c_str());
+        return tr("The directory %1 doesn't exist on Clementine server...").arg(Utf8::toQString(relativePath));
     case pb::remote::ResponseListFiles::UNKNOWN:
         return tr("Clementine sent back an UNKNOWN error...");
     case pb::remote::ResponseListFiles::NONE:
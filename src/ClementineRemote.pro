@@ -1,22 +1,9 @@
 QT += core network quick sql
 
-CONFIG += c++17
 TARGET = ClemRemote
 
-# possible to remove the Connection Thread as Sockets are Async
-# cf https://forum.qt.io/topic/120468/qabstractlistmodel-populated-in-a-worker-thread-not-the-gui-one
-DEFINES  += __USE_CONNECTION_THREAD__
-
-INCLUDEPATH += $$PWD/../protobuf-3.13.0/src
-DEPENDPATH += $$PWD/../protobuf-3.13.0/src
-
-CONFIG(debug, debug|release) :{
-    DEFINES += __DEBUG__
-}
-else {
-    # In release mode, remove all qDebugs !
-    DEFINES += QT_NO_DEBUG_OUTPUT
-}
+# protocol, state and models (shared with core/core.pro and cli/cli.pro)
+include(core.pri)
 
 #For linux
 linux {
@@ -99,30 +86,9 @@ android {
     }
 }
 
-# The following define makes your compiler emit warnings if you use
-# any Qt feature that has been marked deprecated (the exact warnings
-# depend on your compiler). Refer to the documentation for the
-# deprecated API to know how to port your code away from it.
-DEFINES += QT_DEPRECATED_WARNINGS
-
-# You can also make your code fail to compile if it uses deprecated APIs.
-# In order to do so, uncomment the following line.
-# You can also select to disable deprecated APIs only up to a certain version of Qt.
-#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
-
-
 SOURCES += \
-        ClementineRemote.cpp \
-        ConnectionWorker.cpp \
-        model/LibraryModel.cpp \
-        model/PlaylistModel.cpp \
-        model/RadioStreamModel.cpp \
-        model/RemoteFileModel.cpp \
-        model/RemoteSongModel.cpp \
         main.cpp \
-        player/RemoteSong.cpp \
-        protobuf/remotecontrolmessages.pb.cc \
-        utils/Downloader.cpp
+        $$CORE_SOURCES
 
 RESOURCES += \
     qml/qml.qrc \
@@ -139,23 +105,7 @@ qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
 
-HEADERS += \
-    ClementineRemote.h \
-    ClementineSession.h \
-    ConnectionWorker.h \
-    model/LibraryModel.h \
-    model/PlaylistModel.h \
-    model/RadioStreamModel.h \
-    model/RemoteFileModel.h \
-    model/RemoteSongModel.h \
-    player/RemoteFile.h \
-    player/RemotePlaylist.h \
-    player/RemoteSong.h \
-    player/Stream.h \
-    utils/Downloader.h \
-    utils/Macro.h \
-    utils/Singleton.h \
-    protobuf/remotecontrolmessages.pb.h
+HEADERS += $$CORE_HEADERS
 
 DISTFILES += \
     ios/info.plist \
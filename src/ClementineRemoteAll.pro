@@ -0,0 +1,13 @@
+# builds the headless core library, the CLI driver, the benchmarks, the unit tests and the GUI application
+TEMPLATE = subdirs
+
+SUBDIRS = core cli bench tests gui
+
+core.subdir   = core
+cli.subdir    = cli
+cli.depends   = core
+bench.subdir  = bench
+bench.depends = core
+tests.subdir  = tests
+tests.depends = core
+gui.file      = ClementineRemote.pro
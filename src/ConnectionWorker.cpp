@@ -22,11 +22,13 @@
 #include "ClementineRemote.h"
 #include "ClementineSession.h"
 #include "player/RemotePlaylist.h"
+#include "utils/TraceRecorder.h"
 
 #include <QFile>
 #include <QDir>
 #include <QFileInfo>
 #include <QCryptographicHash>
+#include <QElapsedTimer>
 
 ConnectionWorker::ConnectionWorker(ClementineRemote *remote, QObject *parent) :
     QObject(parent),
@@ -35,7 +37,9 @@ ConnectionWorker::ConnectionWorker(ClementineRemote *remote, QObject *parent) :
     _reading_protobuf(false), _expected_length(0), _buffer(),
     _session(nullptr),
     _libraryDL(), _songsDL(),
-    _killingSocket(0x0)
+    _killingSocket(0x0), _nbReadyReads(0), _frameBytes(0), _peakFrameBytes(0),
+    _reconnectTimer(this), _reconnectAttempt(0), _reconnectAllowed(0x0), _resumeToken(), _disconnectHandled(false),
+    _store(), _background(0x0)
 {
     setObjectName("ConnectionWorker");
 
@@ -46,21 +50,37 @@ ConnectionWorker::ConnectionWorker(ClementineRemote *remote, QObject *parent) :
 #endif
 
     connect(&_timeout, &QTimer::timeout, this, &ConnectionWorker::onSocketTimeout, Qt::DirectConnection);
+    _reconnectTimer.setSingleShot(true);
+    connect(&_reconnectTimer, &QTimer::timeout, this, &ConnectionWorker::onReconnect, Qt::DirectConnection);
 
     connect(this,    &ConnectionWorker::connectToServer,      this, &ConnectionWorker::onConnectToServer,      connectionType);
     connect(this,    &ConnectionWorker::killSocket,           this, &ConnectionWorker::onKillSocket,           connectionType);
     connect(this,    &ConnectionWorker::getLibrary,           this, &ConnectionWorker::onGetLibrary,           connectionType);
 
+    attachToRemote();
+}
+
+void ConnectionWorker::attachToRemote()
+{
+#ifdef __USE_CONNECTION_THREAD__
+    Qt::ConnectionType connectionType = Qt::QueuedConnection;
+#else
+    Qt::ConnectionType connectionType = Qt::DirectConnection;
+#endif
+
     connect(_remote, &ClementineRemote::disconnectFromServer, this, &ConnectionWorker::onDisconnectFromServer, connectionType);
     connect(_remote, &ClementineRemote::changeToSong,         this, &ConnectionWorker::onChangeToSong,         connectionType);
     connect(_remote, &ClementineRemote::setTrackPostion,      this, &ConnectionWorker::onSetTrackPostion,      connectionType);
+    connect(_remote, &ClementineRemote::requestTrackPositionInterval, this, &ConnectionWorker::onRequestTrackPositionInterval, connectionType);
     connect(_remote, &ClementineRemote::setVolume,            this, &ConnectionWorker::onSetVolume,            connectionType);
     connect(_remote, &ClementineRemote::nextSong,             this, &ConnectionWorker::onNextSong,             connectionType);
     connect(_remote, &ClementineRemote::previousSong,         this, &ConnectionWorker::onPreviousSong,         connectionType);
     connect(_remote, &ClementineRemote::setEngineState,       this, &ConnectionWorker::onSetEngineState,       connectionType);
     connect(_remote, &ClementineRemote::shuffle,              this, &ConnectionWorker::onShuffle,              connectionType);
     connect(_remote, &ClementineRemote::repeat,               this, &ConnectionWorker::onRepeat,               connectionType);
-    connect(_remote, &ClementineRemote::changePlaylist,       this, &ConnectionWorker::onChangePlaylist,       connectionType);
+    connect(_remote, &ClementineRemote::requestPlaylistSongs, this, &ConnectionWorker::onRequestPlaylistSongs, connectionType);
+    connect(_remote, &ClementineRemote::requestPlaylistSongsWindow, this, &ConnectionWorker::onRequestPlaylistSongsWindow, connectionType);
+    connect(_remote, &ClementineRemote::requestSongMetadata,  this, &ConnectionWorker::onRequestSongMetadata,  connectionType);
     connect(_remote, &ClementineRemote::getServerFiles,       this, &ConnectionWorker::onGetServerFiles,       connectionType);
     connect(_remote, &ClementineRemote::sendFilesToAppend,    this, &ConnectionWorker::onSendFilesToAppend,    connectionType);
     connect(_remote, &ClementineRemote::savePlaylist,         this, &ConnectionWorker::onSavePlaylist,         connectionType);
@@ -76,6 +96,12 @@ ConnectionWorker::ConnectionWorker(ClementineRemote *remote, QObject *parent) :
     connect(_remote, &ClementineRemote::downloadPlaylist,     this, &ConnectionWorker::onDownloadPlaylist,     connectionType);
     connect(_remote, &ClementineRemote::sendSongsToDownload,  this, &ConnectionWorker::onSendSongsToDownload,  connectionType);
     connect(_remote, &ClementineRemote::insertUrls,           this, &ConnectionWorker::onInsertUrls,           connectionType);
+    connect(_remote, &ClementineRemote::requestGlobalSearch,  this, &ConnectionWorker::onRequestGlobalSearch,  connectionType);
+}
+
+void ConnectionWorker::detachFromRemote()
+{
+    disconnect(_remote, nullptr, this, nullptr);
 }
 
 ConnectionWorker::~ConnectionWorker()
@@ -102,6 +128,7 @@ void ConnectionWorker::onKillSocket(){
     }
     if (_timeout.isActive())
         _timeout.stop();
+    _reconnectTimer.stop();
     _killingSocket = 0x0;
 }
 
@@ -109,6 +136,7 @@ void ConnectionWorker::onConnectToServer(ClementineSession *session)
 {
     _session = session;
     _socket = new QTcpSocket();
+    _disconnectHandled = false;
 
     _socket->setSocketOption(QAbstractSocket::KeepAliveOption, true);
     _socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
@@ -129,7 +157,16 @@ void ConnectionWorker::onConnectToServer(ClementineSession *session)
 
 void ConnectionWorker::onDisconnectFromServer()
 {
-    _socket->disconnectFromHost();
+    _reconnectAllowed = 0x0;
+    if (_socket)
+        _socket->disconnectFromHost();
+    else if (M_LoadAtomic(_reconnectAttempt))
+    {
+        _reconnectTimer.stop();
+        _disconnectReason = " ";
+        _disconnectHandled = false; // the failed attempt was handled, not the end of the session
+        onDisconnected();
+    }
 }
 
 void ConnectionWorker::onNextSong()
@@ -233,21 +270,47 @@ void ConnectionWorker::onRepeat(ushort mode)
     sendDataToServer(msg);
 }
 
-void ConnectionWorker::onChangePlaylist(qint32 pIdx)
+void ConnectionWorker::onRequestPlaylistSongs(qint32 playlistID)
 {
-    qDebug() << "[ConnectionWorker::onChangePlaylist] playlistIdx: " << pIdx;
+    qDebug() << "[ConnectionWorker::onRequestPlaylistSongs] playlistID: " << playlistID;
 
-    RemotePlaylist *playlist = _remote->playlist(pIdx);
-    if (!playlist)
-    {
-        qCritical() << "[ConnectionWorker::onChangePlaylist] Can't find playlist with index: " << pIdx;
-        return ;
-    }
+    pb::remote::Message msg;
+    msg.set_type(pb::remote::REQUEST_PLAYLIST_SONGS);
+    pb::remote::RequestPlaylistSongs *req = msg.mutable_request_playlist_songs();
+    req->set_id(playlistID);
+    req->set_fields_mask(RemoteSong::sPlaylistFieldsMask);
+
+    sendDataToServer(msg);
+}
+
+void ConnectionWorker::onRequestPlaylistSongsWindow(qint32 playlistID, qint32 offset, qint32 limit)
+{
+    qDebug() << "[ConnectionWorker::onRequestPlaylistSongsWindow] playlistID: " << playlistID
+             << ", rows: [" << offset << ", " << offset + limit << "[";
+
+    pb::remote::Message msg;
+    msg.set_type(pb::remote::REQUEST_PLAYLIST_SONGS);
+    pb::remote::RequestPlaylistSongs *req = msg.mutable_request_playlist_songs();
+    req->set_id(playlistID);
+    req->set_offset(offset);
+    req->set_limit(limit);
+    req->set_fields_mask(RemoteSong::sPlaylistFieldsMask);
 
+    sendDataToServer(msg);
+}
+
+void ConnectionWorker::onRequestSongMetadata(qint32 playlistID, qint32 songIndex)
+{
+    qDebug() << "[ConnectionWorker::onRequestSongMetadata] playlistID: " << playlistID
+             << ", song index: " << songIndex;
+
+    // windowed request of one row with all the fields
     pb::remote::Message msg;
     msg.set_type(pb::remote::REQUEST_PLAYLIST_SONGS);
-    msg.mutable_request_playlist_songs()->set_id(playlist->id);
-    _remote->setRequestSongsForPlaylistID(playlist->id);
+    pb::remote::RequestPlaylistSongs *req = msg.mutable_request_playlist_songs();
+    req->set_id(playlistID);
+    req->set_offset(songIndex);
+    req->set_limit(1);
 
     sendDataToServer(msg);
 }
@@ -320,7 +383,7 @@ void ConnectionWorker::onClosePlaylist(qint32 playlistID)
     sendDataToServer(msg);
 
     _remote->closingPlaylist(playlistID);
-    onChangePlaylist(_remote->playlistIndex());
+    emit _remote->changePlaylist(_remote->playlistIndex()); // displayed by ClementineRemote::onChangePlaylist
 }
 
 void ConnectionWorker::onGetAllPlaylists()
@@ -442,6 +505,17 @@ void ConnectionWorker::onInsertUrls(qint32 playlistID, const QString &newPlaylis
     _remote->doSendInsertUrls(playlistID, newPlaylistName);
 }
 
+void ConnectionWorker::onRequestGlobalSearch(const QString &query)
+{
+    qDebug() << "[ConnectionWorker::onRequestGlobalSearch] query: " << query;
+
+    pb::remote::Message msg;
+    msg.set_type(pb::remote::GLOBAL_SEARCH);
+    msg.mutable_request_global_search()->set_query(query.toStdString());
+
+    sendDataToServer(msg);
+}
+
 void ConnectionWorker::sendChangeSong(int songIndex, qint32 playlistID)
 {
     pb::remote::Message msg;
@@ -478,6 +552,17 @@ void ConnectionWorker::onSetTrackPostion(qint32 newPos)
     sendDataToServer(msg);
 }
 
+void ConnectionWorker::onRequestTrackPositionInterval(qint32 intervalMs)
+{
+    pb::remote::Message msg;
+    msg.set_type(pb::remote::SET_TRACK_POSITION_INTERVAL);
+    msg.mutable_request_set_track_position_interval()->set_interval_ms(intervalMs);
+
+    qDebug() << "[ConnectionWorker::onRequestTrackPositionInterval] " << intervalMs << " ms";
+
+    sendDataToServer(msg);
+}
+
 void ConnectionWorker::onSetVolume(qint32 vol)
 {
     pb::remote::Message msg;
@@ -499,6 +584,10 @@ void ConnectionWorker::onConnected()
     pb::remote::RequestConnect *reqConnect = msg.mutable_request_connect();
     if (_session->pass() != -1)
         reqConnect->set_auth_code(_session->pass());
+    reqConnect->set_supports_playlist_delta(true);
+    if (M_LoadAtomic(_reconnectAttempt) && !_resumeToken.empty())
+        reqConnect->set_resume_token(_resumeToken);
+    // _reconnectAttempt is only reset once the server has accepted us (it may drop us right away)
 
     sendDataToServer(msg);
 
@@ -507,6 +596,12 @@ void ConnectionWorker::onConnected()
 
 void ConnectionWorker::onDisconnected()
 {
+    if (_disconnectHandled)
+    {
+        qDebug() << "[ConnectionWorker::onDisconnected] already handled for this socket";
+        return; // one attempt counted and one reconnection scheduled per socket
+    }
+    _disconnectHandled = true;
     qDebug() << "[ConnectionWorker::onDisconnected] from " << _session->str();
     if (_timeout.isActive())
         _timeout.stop();
@@ -524,28 +619,128 @@ void ConnectionWorker::onDisconnected()
 
     _songsDL.init(0, 0);
     _libraryDL.init();
+    _reading_protobuf = false;
+    _buffer.clear();
+
+    if (M_LoadAtomic(_reconnectAllowed) && scheduleReconnection())
+        return; // keep all the client state
 
+    _reconnectAttempt = 0;
+    _reconnectAllowed = 0x0;
+    _resumeToken.clear();
+    _store.clear();
+    if (M_LoadAtomic(_background))
+    {
+        emit backgroundSessionClosed();
+        return;
+    }
     _session = nullptr;
     _remote->clearData(_disconnectReason);
 }
 
+void ConnectionWorker::park()
+{
+    qDebug() << "[ConnectionWorker::park] " << (_session ? _session->str() : QString("no session"))
+             << ", store: " << _store.memoryUsage() << " bytes";
+    _background = 0x1;
+    if (_socket)
+        onRequestTrackPositionInterval(0); // nobody is watching
+}
+
+void ConnectionWorker::activate(int intervalMs)
+{
+    QElapsedTimer replayTime;
+    replayTime.start();
+    _background = 0x0;
+
+    if (!_socket && !_reconnectTimer.isActive())
+    {   // closed while in background (its store is cleared): a normal connection
+        qDebug() << "[ConnectionWorker::activate] " << _session->str() << " was closed, connecting again";
+        onConnectToServer(_session);
+        return;
+    }
+
+    const QList<QByteArray> frames = _store.frames();
+    for (const QByteArray &frame : frames)
+        _remote->parseMessage(frame);
+
+    pb::remote::Message msg;
+    msg.set_type(pb::remote::FIRST_DATA_SENT_COMPLETE);
+    _remote->parseMessage(QByteArray::fromStdString(msg.SerializeAsString()));
+
+    qDebug() << "[ConnectionWorker::activate] " << _session->str() << ": " << frames.size()
+             << " messages replayed in " << replayTime.elapsed() << " ms";
+    if (_socket)
+        onRequestTrackPositionInterval(intervalMs);
+}
+
+void ConnectionWorker::recordInBackground(const QByteArray &frame)
+{
+    pb::remote::Message msg;
+    if (!msg.ParseFromArray(frame.constData(), frame.size()))
+        return;
+
+    _store.record(msg, frame);
+    if (msg.type() == pb::remote::PLAYLIST_DELTA)
+        onRequestPlaylistSongs(msg.response_playlist_delta().playlist_id()); // cheaper than applying it
+    else if (msg.type() == pb::remote::DISCONNECT)
+        _reconnectAllowed = 0x0;
+}
+
+bool ConnectionWorker::scheduleReconnection()
+{
+    int attempt = M_LoadAtomic(_reconnectAttempt);
+    if (attempt >= sMaxReconnectAttempts)
+    {
+        qDebug() << "[ConnectionWorker::scheduleReconnection] giving up after " << attempt << " attempts";
+        _disconnectReason = tr("Connection lost...");
+        return false;
+    }
+
+    bool background = M_LoadAtomic(_background);
+    if (attempt == 0 && !background)
+        _remote->connectionLost();
+
+    int delayMs = qMin(sReconnectDelayMinMs << attempt, sReconnectDelayMaxMs);
+    _reconnectAttempt = ++attempt;
+    qDebug() << "[ConnectionWorker::scheduleReconnection] attempt #" << attempt << " in " << delayMs << " ms"
+             << (background ? " (background session)" : "");
+    if (!background)
+        emit _remote->reconnecting(attempt, delayMs);
+    _reconnectTimer.start(delayMs);
+    return true;
+}
+
+void ConnectionWorker::onReconnect()
+{
+    qDebug() << "[ConnectionWorker::onReconnect] attempt #" << M_LoadAtomic(_reconnectAttempt)
+             << " to " << _session->str();
+    onConnectToServer(_session);
+}
+
 void ConnectionWorker::onReadyRead()
 {
+    M_TRACE_SCOPE("ConnectionWorker::onReadyRead");
     if (_killingSocket.loadRelaxed() || !_socket)
     {
         qDebug() << "[ConnectionWorker::onReadyRead] ignoring read...";
         return;
     }
+    _nbReadyReads.fetchAndAddRelaxed(1);
+    readFrames(_socket);
+}
 
-    while (_socket->bytesAvailable()) {
+void ConnectionWorker::readFrames(QIODevice *device)
+{
+    while (device->bytesAvailable()) {
         if (!_reading_protobuf) {
             // If we have less than 4 byte, we cannot read the length. Wait for more
             // data
-            if (_socket->bytesAvailable() < 4) {
+            if (device->bytesAvailable() < 4) {
                 break;
             }
             // Read the length of the next message
-            QDataStream s(_socket);
+            QDataStream s(device);
             s >> _expected_length;
 
             // Receiving more than 128mb is very unlikely
@@ -553,7 +748,7 @@ void ConnectionWorker::onReadyRead()
             if (_expected_length > 134217728) {
                 qDebug() << "Received invalid data, disconnect client";
                 qDebug() << "_expected_length =" << _expected_length;
-                _socket->close();
+                device->close();
                 return;
             }
 
@@ -561,15 +756,22 @@ void ConnectionWorker::onReadyRead()
         }
 
         // Read some of the message
-        _buffer.append(_socket->read(_expected_length - _buffer.size()));
+        _buffer.append(device->read(_expected_length - _buffer.size()));
+        _frameBytes = _buffer.capacity();
 
         // Did we get everything?
         if (_buffer.size() == _expected_length) {
             // Parse the message
-            _remote->parseMessage(_buffer);
+            if (M_LoadAtomic(_background))
+                recordInBackground(_buffer);
+            else
+                _remote->parseMessage(_buffer, &_store);
 
             // Clear the buffer
+            if (_buffer.size() > M_LoadAtomic(_peakFrameBytes))
+                _peakFrameBytes = _buffer.size();
             _buffer.clear();
+            _frameBytes = 0;
             _reading_protobuf = false;
         }
     }
@@ -579,19 +781,26 @@ void ConnectionWorker::onSocketTimeout()
 {
     qDebug() << "[ConnectionWorker::onSocketTimeout] on " << _session->str();
     _timeout.stop();
-    emit _remote->connectionError(tr("Unable to connect..."));
+    if (!M_LoadAtomic(_reconnectAttempt) && !M_LoadAtomic(_background))
+        emit _remote->connectionError(tr("Unable to connect..."));
     if (_socket)
         onDisconnected();
 }
 
 void ConnectionWorker::onError(QAbstractSocket::SocketError err)
 {
+    if (sender() != _socket)
+        return; // queued error of a previous socket (already handled, maybe a new attempt is ongoing)
     if (!_killingSocket.loadRelaxed() && _socket)
     {
         qDebug() << "[ConnectionWorker::onError] err: " << err << " : " << _socket->errorString();
-        emit _remote->connectionError(_socket->errorString());
+        bool reconnecting = M_LoadAtomic(_reconnectAttempt);
+        if (!reconnecting && !M_LoadAtomic(_background))
+            emit _remote->connectionError(_socket->errorString());
 
-        if (err == QAbstractSocket::SocketError::ConnectionRefusedError)
+        // a failed reconnection attempt doesn't emit disconnected, no need to wait the timeout
+        if (err == QAbstractSocket::SocketError::ConnectionRefusedError
+                || (reconnecting && _socket->state() == QAbstractSocket::UnconnectedState))
         {
             _disconnectReason = _socket->errorString();
             _timeout.stop();
@@ -607,6 +816,12 @@ void ConnectionWorker::sendDataToServer(pb::remote::Message &msg)
     // Set the default version
     msg.set_version(msg.default_instance().version());
 
+    if (!_socket)
+    {
+        qDebug() << "[ConnectionWorker::sendDataToServer] not connected, dropping msg type: " << msg.type();
+        return;
+    }
+
     // Check if we are still connected
     if (_socket->state() == QTcpSocket::ConnectedState) {
         // Serialize the message
@@ -619,7 +834,7 @@ void ConnectionWorker::sendDataToServer(pb::remote::Message &msg)
 
         // Do NOT flush data here! If the client is already disconnected, it
         // causes a SIGPIPE termination!!!
-    } else {
+    } else if (!M_LoadAtomic(_reconnectAttempt)) { // don't abort a reconnection
         qDebug() << "Closed";
         _socket->close();
     }
@@ -724,6 +939,7 @@ void ConnectionWorker::downloadSong(const pb::remote::ResponseSongFileChunk &son
             return;
         }
 
+        M_TRACE_SCOPE("ConnectionWorker::writeSongChunk");
         const std::string &data = songChunk.data();
         qint64 bytesWritten = 0, size = static_cast<qint64>(data.size());
         int iterMax = 10, iter = 0;
@@ -792,6 +1008,7 @@ void ConnectionWorker::downloadFinished()
 
 void ConnectionWorker::downloadLibrary(const pb::remote::ResponseLibraryChunk &libChunk)
 {
+    M_TRACE_SCOPE("ConnectionWorker::downloadLibrary");
 
     if (libChunk.chunk_number() == 1)
     {
@@ -860,6 +1077,7 @@ void ConnectionWorker::downloadLibrary(const pb::remote::ResponseLibraryChunk &l
 
 QByteArray ConnectionWorker::sha1Hex(QFile &file)
 {
+    M_TRACE_SCOPE("ConnectionWorker::sha1Hex");
     file.seek(0);
     QCryptographicHash hash(QCryptographicHash::Sha1);
     QByteArray data;
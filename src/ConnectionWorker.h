@@ -21,6 +21,7 @@
 #define CONNECTIONWORKER_H
 #include "protobuf/remotecontrolmessages.pb.h"
 #include "utils/Downloader.h"
+#include "utils/SessionStore.h"
 #include <QTcpSocket>
 #include <QByteArray>
 #include <QTimer>
@@ -35,8 +36,12 @@ class RemotePlaylist;
 class ConnectionWorker : public QObject
 {
     Q_OBJECT
+    friend class ClementineBench; //!< bench/ClementineBench.cpp
 
 private:
+    static const int sReconnectDelayMinMs  = 100;  //!< first retry, then doubled at each failure
+    static const int sReconnectDelayMaxMs  = 8000;
+    static const int sMaxReconnectAttempts = 10;
 
     ClementineRemote *_remote;
 
@@ -55,11 +60,41 @@ private:
 
     AtomicBool _killingSocket;
 
+    QAtomicInt _nbReadyReads;   //!< number of readyRead handled (for the power metrics)
+    QAtomicInt _frameBytes;     //!< size of the frame being received (memory accounting)
+    QAtomicInt _peakFrameBytes; //!< biggest frame received
+
+    QTimer      _reconnectTimer;
+    QAtomicInt  _reconnectAttempt; //!< 0 when we're not trying to reconnect
+    AtomicBool  _reconnectAllowed; //!< only for a session that was established (not after a DISCONNECT or a user request)
+    std::string _resumeToken;      //!< given by the server (SESSION_TOKEN)
+    bool        _disconnectHandled; //!< onDisconnected already ran for the current socket (timeout + queued onError)
+
+    SessionStore _store;      //!< latest state of the server (to switch back to this session)
+    AtomicBool   _background; //!< session of the multi-room not displayed: only feeds _store
+
 public:
     ConnectionWorker(ClementineRemote *remote, QObject *parent = nullptr);
     ~ConnectionWorker();
 
     inline bool isConnected() const;
+    inline int nbReadyReads() const;
+    inline int frameBytes() const;
+    inline int peakFrameBytes() const;
+    inline bool isReconnecting() const;
+    inline void setReconnectAllowed(bool allowed);
+    inline void resetReconnectAttempts(); //!< the session is resumed (SESSION_TOKEN or FIRST_DATA_SENT_COMPLETE)
+    inline void setResumeToken(const std::string &token);
+
+    inline SessionStore &store();
+    inline bool isInBackground() const;
+
+    //! signals of ClementineRemote (only for the session displayed)
+    void attachToRemote();
+    void detachFromRemote();
+
+    void park();                   //!< goes in background (to be called in the thread of the worker)
+    void activate(int intervalMs); //!< replays the store to ClementineRemote (idem)
     inline const QString &disconnectReason() const;
     inline void setDisconnectReason(const QString &disconnectReason);
 
@@ -84,16 +119,19 @@ signals:
     void getLibrary();
     void disconnectFromServer();
     void killSocket();
+    void backgroundSessionClosed();
 
+public slots:
+    void onKillSocket(); //!< called directly by ClementineRemote::switchToSession (in our thread)
 
 private slots:
     void onConnectToServer(ClementineSession *session);
     void onDisconnectFromServer();
-    void onKillSocket();
 
 
     void onChangeToSong(int proxyRow);
     void onSetTrackPostion(qint32 newPos);
+    void onRequestTrackPositionInterval(qint32 intervalMs);
     void onSetVolume(qint32 vol);
 
     void onNextSong();
@@ -102,7 +140,9 @@ private slots:
     void onShuffle(ushort mode);
     void onRepeat(ushort mode);
 
-    void onChangePlaylist(qint32 pIdx);
+    void onRequestPlaylistSongs(qint32 playlistID);
+    void onRequestPlaylistSongsWindow(qint32 playlistID, qint32 offset, qint32 limit);
+    void onRequestSongMetadata(qint32 playlistID, qint32 songIndex);
 
     void onGetServerFiles(QString currentPath, QString subFolder);
     void onSendFilesToAppend();
@@ -128,6 +168,7 @@ private slots:
 
     void onGetLibrary();
     void onInsertUrls(qint32 playlistID, const QString &newPlaylistName);
+    void onRequestGlobalSearch(const QString &query);
 
 
 
@@ -138,9 +179,14 @@ private slots:
     void onReadyRead();
     void onSocketTimeout();
     void onError(QAbstractSocket::SocketError err);
+    void onReconnect();
 
 
 private:
+    bool scheduleReconnection(); //!< false when we give up
+    void readFrames(QIODevice *device); //!< length prefixed protobuf messages
+    void recordInBackground(const QByteArray &frame);
+
     bool createDownloadDestinationFolder(const QString &dstFolder);
 
     QByteArray sha1Hex(QFile &file);
@@ -150,6 +196,16 @@ private:
 void ConnectionWorker::cancelDownload(){ _songsDL.cancelDownload(); }
 
 bool ConnectionWorker::isConnected() const { return _socket != nullptr; }
+int ConnectionWorker::nbReadyReads() const { return M_LoadAtomic(_nbReadyReads); }
+int ConnectionWorker::frameBytes() const { return M_LoadAtomic(_frameBytes); }
+int ConnectionWorker::peakFrameBytes() const { return M_LoadAtomic(_peakFrameBytes); }
+bool ConnectionWorker::isReconnecting() const { return M_LoadAtomic(_reconnectAttempt) != 0; }
+void ConnectionWorker::setReconnectAllowed(bool allowed) { _reconnectAllowed = allowed ? 0x1 : 0x0; }
+void ConnectionWorker::resetReconnectAttempts() { _reconnectAttempt = 0; }
+void ConnectionWorker::setResumeToken(const std::string &token) { _resumeToken = token; }
+
+SessionStore &ConnectionWorker::store() { return _store; }
+bool ConnectionWorker::isInBackground() const { return M_LoadAtomic(_background); }
 
 const QString &ConnectionWorker::disconnectReason() const { return _disconnectReason; }
 void ConnectionWorker::setDisconnectReason(const QString &disconnectReason) { _disconnectReason = disconnectReason; }
@@ -7,6 +7,7 @@ import android.app.Activity;
 import android.app.AlertDialog;
 import android.app.PendingIntent;
 import android.content.BroadcastReceiver;
+import android.content.ComponentCallbacks2;
 import android.content.Context;
 import android.content.DialogInterface;
 import android.content.Intent;
@@ -18,4 +19,30 @@ import android.os.Bundle;
 // http://supertos.free.fr/supertos.php?page=1198
 public class ClementineRemote extends QtActivity {
 
+    // implemented in main.cpp: drops the caches of ClementineRemote (cf MemoryPressure)
+    private static native void notifyLowMemory();
+
+    @Override
+    public void onTrimMemory(int level) {
+        super.onTrimMemory(level);
+        // UI_HIDDEN only means we went in background: nothing to free
+        if (level == ComponentCallbacks2.TRIM_MEMORY_RUNNING_LOW
+                || level == ComponentCallbacks2.TRIM_MEMORY_RUNNING_CRITICAL
+                || level >= ComponentCallbacks2.TRIM_MEMORY_BACKGROUND)
+            dropCaches();
+    }
+
+    @Override
+    public void onLowMemory() {
+        super.onLowMemory();
+        dropCaches();
+    }
+
+    private static void dropCaches() {
+        try {
+            notifyLowMemory();
+        } catch (UnsatisfiedLinkError e) {
+            // the Qt libraries are not loaded yet: nothing cached
+        }
+    }
 }
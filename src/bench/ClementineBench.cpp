@@ -0,0 +1,785 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "ClementineBench.h"
+#include "ClementineRemote.h"
+#include "ConnectionWorker.h"
+#include "model/LibraryModel.h"
+#include "model/RemoteSongModel.h"
+#include "player/RemoteSong.h"
+#include "player/SongsDecoder.h"
+#include "utils/Utf8.h"
+#include <QtTest>
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QThreadPool>
+
+ClementineBench::ClementineBench(QObject *parent):
+    QObject(parent),
+    _remote(nullptr), _tmpDir()
+{}
+
+void ClementineBench::initTestCase()
+{
+    QVERIFY(_tmpDir.isValid());
+    // don't touch the user's settings and library
+    QStandardPaths::setTestModeEnabled(true);
+    qputenv("XDG_CONFIG_HOME", _tmpDir.path().toLocal8Bit());
+    _remote = ClementineRemote::getInstance();
+}
+
+void ClementineBench::cleanupTestCase()
+{
+    _remote->close();
+}
+
+void ClementineBench::fillSong(pb::remote::SongMetadata *song, int idx)
+{
+    song->set_id(idx);
+    song->set_index(idx);
+    song->set_title(QString("Title of the song %1").arg(idx).toStdString());
+    song->set_album(QString("Album %1").arg(idx / 10).toStdString());
+    song->set_artist(QString("Artist %1").arg(idx / 100).toStdString());
+    song->set_albumartist(QString("Artist %1").arg(idx / 100).toStdString());
+    song->set_track(idx % 10 + 1);
+    song->set_disc(1);
+    song->set_pretty_year("2020");
+    song->set_genre("Rock");
+    song->set_playcount(idx % 7);
+    song->set_pretty_length("3:42");
+    song->set_length(222);
+    song->set_is_local(true);
+    song->set_filename(QString("Artist %1 - Title of the song %2.mp3").arg(idx / 100).arg(idx).toStdString());
+    song->set_file_size(4 * 1024 * 1024);
+    song->set_rating(0.6f);
+}
+
+QByteArray ClementineBench::frame(const pb::remote::Message &msg)
+{
+    QByteArray data;
+    QDataStream s(&data, QIODevice::WriteOnly);
+    std::string payload = msg.SerializeAsString();
+    s << static_cast<qint32>(payload.size());
+    data.append(payload.data(), static_cast<int>(payload.size()));
+    return data;
+}
+
+void ClementineBench::playlistSongsMsg(pb::remote::ResponsePlaylistSongs &songs, qint32 playlistID, int nbSongs)
+{
+    pb::remote::Playlist *playlist = songs.mutable_requested_playlist();
+    playlist->set_id(playlistID);
+    playlist->set_name(QString("Playlist %1").arg(playlistID).toStdString());
+    playlist->set_item_count(nbSongs);
+    for (int i = 0 ; i < nbSongs ; ++i)
+        fillSong(songs.add_songs(), i);
+}
+
+void ClementineBench::loadSongs(int nbSongs)
+{
+    if (_remote->numberOfPlaylistSongs() == nbSongs)
+        return;
+    pb::remote::ResponsePlaylistSongs songs;
+    playlistSongsMsg(songs, 1, nbSongs);
+    _remote->rcvPlaylistSongs(songs);
+}
+
+bool ClementineBench::loadLibrary(int nbTracks)
+{
+    _remote->_libDB.close();
+    if (!createLibraryDB(QString("%1/%2.db").arg(_remote->_libraryPath).arg(_remote->sessionName()), nbTracks))
+        return false;
+    _remote->onLibraryDownloaded();
+    return _remote->isLibraryLoaded();
+}
+
+bool ClementineBench::createLibraryDB(const QString &dbPath, int nbTracks)
+{
+    QFile::remove(dbPath);
+    QDir().mkpath(QFileInfo(dbPath).absolutePath());
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "ClementineBench");
+        db.setDatabaseName(dbPath);
+        if (db.open())
+        {
+            QSqlQuery query(db);
+            ok = query.exec("create table songs (artist text, albumartist text, album text, genre text, year int,"
+                            " title text, track int, filename text)");
+            db.transaction();
+            query.prepare("insert into songs (artist, albumartist, album, genre, year, title, track, filename)"
+                          " values (?, ?, ?, ?, ?, ?, ?, ?)");
+            for (int i = 0 ; ok && i < nbTracks ; ++i)
+            {
+                query.addBindValue(QString("Artist %1").arg(i / 100));
+                query.addBindValue(i % 1000 < 100 ? QString("Various Artists") : QString()); // compilations
+                query.addBindValue(QString("Album %1").arg(i / 10));
+                query.addBindValue(QString("Genre %1").arg((i / 100) % 20));
+                query.addBindValue(1970 + (i / 10) % 50);
+                query.addBindValue(QString("Title of the song %1").arg(i));
+                query.addBindValue(i % 10 + 1);
+                query.addBindValue(QString("/music/Artist %1/Album %2/%3.mp3").arg(i / 100).arg(i / 10).arg(i));
+                ok = query.exec();
+            }
+            db.commit();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase("ClementineBench");
+    return ok;
+}
+
+
+void ClementineBench::readFrames_data()
+{
+    QTest::addColumn<QByteArray>("stream");
+    QTest::addColumn<bool>("background");
+
+    for (int nbFrames : {1000, 10000})
+    {
+        QByteArray stream;
+        for (int i = 0 ; i < nbFrames ; ++i)
+        {
+            pb::remote::Message msg;
+            if (i % 50 == 0)
+                msg.set_type(pb::remote::KEEP_ALIVE);
+            else if (i % 10 == 0)
+            {
+                msg.set_type(pb::remote::CURRENT_METAINFO);
+                fillSong(msg.mutable_response_current_metadata()->mutable_song_metadata(), i);
+            }
+            else
+            {
+                msg.set_type(pb::remote::UPDATE_TRACK_POSITION);
+                msg.mutable_response_update_track_position()->set_position(i);
+            }
+            stream.append(frame(msg));
+        }
+        QTest::newRow(qPrintable(QString("%1 small frames").arg(nbFrames))) << stream << false;
+    }
+
+    pb::remote::Message msg;
+    msg.set_type(pb::remote::PLAYLIST_SONGS);
+    playlistSongsMsg(*msg.mutable_response_playlist_songs(), 2, 10000);
+    QTest::newRow("10k songs playlist (background session)") << frame(msg) << true;
+}
+
+void ClementineBench::readFrames()
+{
+    QFETCH(QByteArray, stream);
+    QFETCH(bool, background);
+
+    ConnectionWorker worker(_remote);
+    worker.detachFromRemote();
+    worker._background = background ? 0x1 : 0x0;
+
+    QBuffer buffer(&stream);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QBENCHMARK {
+        buffer.seek(0);
+        worker.readFrames(&buffer);
+        QCoreApplication::processEvents(); // handover to the GUI thread
+    }
+    QVERIFY(!worker._reading_protobuf);
+}
+
+
+void ClementineBench::remoteSong_data()
+{
+    QTest::addColumn<qint64>("fieldsMask");
+
+    QTest::newRow("all fields") << qint64(-1);
+    QTest::newRow("playlist fields") << RemoteSong::sPlaylistFieldsMask;
+}
+
+void ClementineBench::remoteSong()
+{
+    QFETCH(qint64, fieldsMask);
+
+    pb::remote::ResponsePlaylistSongs songs;
+    playlistSongsMsg(songs, 1, 10000);
+
+    QBENCHMARK {
+        QList<RemoteSong> playlistSongs;
+        playlistSongs.reserve(songs.songs_size());
+        if (fieldsMask == -1)
+        {
+            for (const auto &song : songs.songs())
+                playlistSongs << RemoteSong(song);
+        }
+        else
+        {
+            for (const auto &song : songs.songs())
+                playlistSongs << RemoteSong(song, fieldsMask);
+        }
+    }
+}
+
+
+void ClementineBench::rcvPlaylists_data()
+{
+    QTest::addColumn<int>("nbOpened");
+    QTest::addColumn<int>("nbClosed");
+
+    QTest::newRow("5 opened, 20 closed")   << 5 << 20;
+    QTest::newRow("20 opened, 250 closed") << 20 << 250;
+}
+
+void ClementineBench::rcvPlaylists()
+{
+    QFETCH(int, nbOpened);
+    QFETCH(int, nbClosed);
+
+    // the same playlists with a song added in the first one and a closed one renamed
+    pb::remote::ResponsePlaylists playlists[2];
+    for (int version = 0 ; version < 2 ; ++version)
+    {
+        playlists[version].set_include_closed(true);
+        for (int i = 0 ; i < nbOpened + nbClosed ; ++i)
+        {
+            pb::remote::Playlist *playlist = playlists[version].add_playlist();
+            playlist->set_id(i + 1);
+            playlist->set_name(QString("Playlist %1").arg(i + 1).toStdString());
+            playlist->set_item_count(100 + (i == 0 ? version : 0));
+            playlist->set_closed(i >= nbOpened);
+            if (version && i == nbOpened)
+                playlist->set_name("Renamed playlist");
+        }
+    }
+
+    int iter = 0;
+    QBENCHMARK {
+        _remote->rcvPlaylists(playlists[iter++ % 2]);
+    }
+    QCOMPARE(_remote->numberOfPlaylists(), nbOpened);
+    QCOMPARE(_remote->numberOfPlaylists(true), nbClosed);
+}
+
+void ClementineBench::utf8Strings_data()
+{
+    QTest::addColumn<QStringList>("corpus");
+    QTest::addColumn<bool>("simd");
+
+    // samples of the metadata sent by Clementine (titles, artists, albums, urls)
+    QStringList ascii = {"Title of the song 42", "Pink Floyd", "The Dark Side of the Moon", "3:42", "Rock",
+                         "file:///home/user/Music/Pink Floyd/The Dark Side of the Moon/04 - Time.flac"};
+    QStringList latin = {"Motörhead", "Sigur Rós", "Beyoncé", "Ágætis byrjun", "Café del Mar", "Les Négresses Vertes",
+                         "file:///home/user/Music/Mylène Farmer/Ainsi soit je.../01 - L'Horloge.mp3"};
+    QStringList cjk   = {"坂本龍一", "宇多田ヒカル", "戦場のメリークリスマス", "First Love", "Пётр Чайковский", "Лебединое озеро",
+                         "file:///home/user/Music/宇多田ヒカル/First Love/01 - Automatic.mp3"};
+
+    QTest::newRow("ascii c_str()")  << ascii << false;
+    QTest::newRow("ascii Utf8")     << ascii << true;
+    QTest::newRow("latin c_str()")  << latin << false;
+    QTest::newRow("latin Utf8")     << latin << true;
+    QTest::newRow("cjk c_str()")    << cjk << false;
+    QTest::newRow("cjk Utf8")       << cjk << true;
+}
+
+void ClementineBench::utf8Strings()
+{
+    QFETCH(QStringList, corpus);
+    QFETCH(bool, simd);
+
+    std::vector<std::string> strings;
+    for (int i = 0 ; i < 10000 ; ++i)
+        strings.push_back(corpus.at(i % corpus.size()).toStdString());
+
+    qint64 nbChars = 0;
+    QBENCHMARK {
+        nbChars = 0;
+        if (simd)
+        {
+            for (const std::string &str : strings)
+                nbChars += Utf8::toQString(str).size();
+        }
+        else
+        {
+            for (const std::string &str : strings)
+                nbChars += QString(str.c_str()).size();
+        }
+    }
+    for (const std::string &str : strings)
+        QCOMPARE(Utf8::toQString(str), QString::fromStdString(str));
+    QVERIFY(nbChars > 0);
+}
+
+
+void ClementineBench::rcvPlaylistSongs_data()
+{
+    QTest::addColumn<int>("nbSongs");
+
+    QTest::newRow("1k songs")   << 1000;
+    QTest::newRow("10k songs")  << 10000;
+    QTest::newRow("100k songs") << 100000;
+}
+
+void ClementineBench::rcvPlaylistSongs()
+{
+    QFETCH(int, nbSongs);
+
+    // alternate between 2 playlists of different sizes so the model is always reset
+    pb::remote::ResponsePlaylistSongs songs[2];
+    playlistSongsMsg(songs[0], 3, nbSongs);
+    playlistSongsMsg(songs[1], 4, nbSongs + 1);
+
+    int iter = 0;
+    QBENCHMARK {
+        _remote->rcvPlaylistSongs(songs[iter++ % 2]);
+    }
+    QVERIFY(_remote->numberOfPlaylistSongs() >= nbSongs);
+}
+
+
+void ClementineBench::decodeSongs_data()
+{
+    QTest::addColumn<int>("nbThreads");
+
+    int idealThreads = QThread::idealThreadCount();
+    for (int nbThreads = 1 ; nbThreads < idealThreads ; nbThreads *= 2)
+        QTest::newRow(QString("%1 thread(s)").arg(nbThreads).toLocal8Bit().constData()) << nbThreads;
+    QTest::newRow(QString("%1 threads (ideal)").arg(idealThreads).toLocal8Bit().constData()) << idealThreads;
+}
+
+void ClementineBench::decodeSongs()
+{
+    QFETCH(int, nbThreads);
+
+    pb::remote::ResponsePlaylistSongs songs;
+    playlistSongsMsg(songs, 1, 100000);
+    qint32 activeIndex = songs.songs_size() - 1;
+
+    QThreadPool *pool = QThreadPool::globalInstance();
+    int maxThreads = pool->maxThreadCount();
+    pool->setMaxThreadCount(nbThreads);
+    int activeRow = -1;
+    QBENCHMARK {
+        QList<RemoteSong> playlistSongs = SongsDecoder::decode(
+                    songs.songs(), RemoteSong::sPlaylistFieldsMask, activeIndex, activeRow, nbThreads);
+    }
+    pool->setMaxThreadCount(maxThreads);
+    QCOMPARE(activeRow, activeIndex);
+}
+
+
+void ClementineBench::updateActiveSong_data()
+{
+    QTest::addColumn<bool>("indexIsRow");
+
+    QTest::newRow("100k songs, index == row") << true;
+    QTest::newRow("100k songs, shuffled indexes") << false;
+}
+
+void ClementineBench::updateActiveSong()
+{
+    QFETCH(bool, indexIsRow);
+
+    pb::remote::ResponsePlaylistSongs songs;
+    playlistSongsMsg(songs, 5, 100000);
+    if (!indexIsRow) // as if the server had sent them in another order
+    {
+        for (int i = 0 ; i < songs.songs_size() ; ++i)
+            songs.mutable_songs(i)->set_index(songs.songs_size() - 1 - i);
+    }
+    _remote->rcvPlaylistSongs(songs);
+
+    int iter = 0;
+    QBENCHMARK { // a CURRENT_METAINFO on a song spread in the playlist
+        pb::remote::SongMetadata metadata(songs.songs((iter++ * 7919) % songs.songs_size()));
+        _remote->updateActiveSong(RemoteSong(metadata, RemoteSong::sPlaylistFieldsMask));
+    }
+    QCOMPARE(_remote->playlistSong(_remote->_activeSongIndex).index, _remote->_activeSong.index);
+}
+
+
+void ClementineBench::libraryDownloaded_data()
+{
+    QTest::addColumn<int>("nbTracks");
+
+    QTest::newRow("1k tracks")   << 1000;
+    QTest::newRow("10k tracks")  << 10000;
+    QTest::newRow("100k tracks") << 100000;
+}
+
+void ClementineBench::libraryDownloaded()
+{
+    QFETCH(int, nbTracks);
+
+    QVERIFY(loadLibrary(nbTracks));
+    QBENCHMARK {
+        _remote->onLibraryDownloaded();
+    }
+    QCOMPARE(_remote->libraryModel()->rowCount(), (nbTracks + 99) / 100);
+}
+
+
+void ClementineBench::libraryHierarchy_data()
+{
+    QTest::addColumn<int>("hierarchy"); // LibraryTable::Hierarchy
+    QTest::addColumn<int>("nbTopItems");
+
+    QTest::newRow("200k tracks, artist / album")         << 0 << 2000;
+    QTest::newRow("200k tracks, album artist / album")   << 1 << 1801;
+    QTest::newRow("200k tracks, genre / artist / album") << 2 << 20;
+    QTest::newRow("200k tracks, year / album")           << 3 << 50;
+}
+
+void ClementineBench::libraryHierarchy()
+{
+    QFETCH(int, hierarchy);
+    QFETCH(int, nbTopItems);
+
+    if (_remote->_libModel->table().size() != 200000)
+        QVERIFY(loadLibrary(200000));
+    QBENCHMARK { // switch from and back to the default view (the groupings are built once)
+        _remote->setLibraryHierarchy(hierarchy);
+        _remote->setLibraryHierarchy(0);
+    }
+    _remote->setLibraryHierarchy(hierarchy);
+    QCOMPARE(_remote->libraryModel()->rowCount(), nbTopItems);
+    _remote->setLibraryHierarchy(0);
+}
+
+
+void ClementineBench::songsFilter_data()
+{
+    QTest::addColumn<QString>("filter");
+
+    QTest::newRow("match all")  << "song";
+    QTest::newRow("match some") << "song 12";
+    QTest::newRow("no match")   << "nothing like that";
+}
+
+void ClementineBench::songsFilter()
+{
+    QFETCH(QString, filter);
+
+    loadSongs(10000);
+    QBENCHMARK { // filter + clear
+        _remote->setSongsFilter(filter);
+        _remote->setSongsFilter(QString());
+    }
+}
+
+void ClementineBench::sortSongs_data()
+{
+    QTest::addColumn<QList<int>>("columns"); // SongsSorter::Column, the last one is the primary key
+    QTest::addColumn<bool>("keysCached");
+
+    QTest::newRow("50k songs, title")                           << QList<int>{1} << false;
+    QTest::newRow("50k songs, track, album, artist")            << QList<int>{4, 3, 2} << false;
+    QTest::newRow("50k songs, track, album, artist (resort)")   << QList<int>{4, 3, 2} << true;
+    QTest::newRow("50k songs, length")                          << QList<int>{5} << false;
+}
+
+void ClementineBench::sortSongs()
+{
+    QFETCH(QList<int>, columns);
+    QFETCH(bool, keysCached);
+
+    loadSongs(50000);
+    QBENCHMARK {
+        if (!keysCached)
+            _remote->invalidateSongsIndexes(); // new songs: collation keys to compute
+        _remote->_songsSorter.clear();
+        for (int column : columns)
+            _remote->_songsSorter.sortBy(static_cast<SongsSorter::Column>(column));
+        _remote->_songsProxyModel->applySort(true);
+    }
+    QAbstractItemModel *proxy = _remote->modelRemoteSongs();
+    QCOMPARE(proxy->rowCount(), 50000);
+    RemoteSongProxyModel *songsProxy = _remote->_songsProxyModel;
+    for (int row = 0 ; row < proxy->rowCount() ; row += 997)
+        QCOMPARE(_remote->songRank(songsProxy->mapToSource(proxy->index(row, 0)).row()), row);
+
+    _remote->clearSongsSort();
+}
+
+void ClementineBench::searchPlaylists_data()
+{
+    QTest::addColumn<QString>("query");
+    QTest::addColumn<int>("nbHits");
+
+    QTest::newRow("40 x 2500 songs, common word") << "song"       << PlaylistsSearchIndex::sMaxHits;
+    QTest::newRow("40 x 2500 songs, prefix")      << "artist 1"   << PlaylistsSearchIndex::sMaxHits;
+    QTest::newRow("40 x 2500 songs, two words")   << "artist 12"  << PlaylistsSearchIndex::sMaxHits;
+    QTest::newRow("40 x 2500 songs, rare word")   << "song 1234"  << 40; // only one title per playlist
+    QTest::newRow("40 x 2500 songs, no match")    << "nothing"    << 0;
+}
+
+void ClementineBench::searchPlaylists()
+{
+    QFETCH(QString, query);
+    QFETCH(int, nbHits);
+
+    if (_remote->_playlistsSearch.nbPlaylists() != 40)
+    {
+        _remote->_playlistsSearch.clear();
+        for (qint32 playlistID = 1 ; playlistID <= 40 ; ++playlistID)
+        {
+            pb::remote::ResponsePlaylistSongs songs;
+            playlistSongsMsg(songs, playlistID, 2500);
+            int activeRow = -1;
+            _remote->_playlistsSearch.index(playlistID, SongsDecoder::decode(
+                                                songs.songs(), RemoteSong::sPlaylistFieldsMask, -1, activeRow));
+        }
+    }
+    QBENCHMARK {
+        _remote->searchPlaylists(query);
+    }
+    QCOMPARE(qMin(_remote->_playlistsSearchModel->nbHits(), PlaylistsSearchIndex::sMaxHits), nbHits);
+    QVERIFY(_remote->modelPlaylistsSearch()->rowCount() <= PlaylistsSearchModel::sPageSize);
+    qInfo() << _remote->playlistsSearchStats();
+}
+
+void ClementineBench::globalSearch_data()
+{
+    QTest::addColumn<int>("nbProviders");
+    QTest::addColumn<int>("batchSize");
+
+    QTest::newRow("3 providers x 50")  << 3 << 50;
+    QTest::newRow("10 providers x 200") << 10 << 200;
+}
+
+void ClementineBench::globalSearch()
+{
+    QFETCH(int, nbProviders);
+    QFETCH(int, batchSize);
+
+    // each provider overlaps half of the previous one, plus a batch of the previous query
+    const qint32 queryId = 7;
+    QVector<pb::remote::ResponseGlobalSearch> batches(nbProviders + 1);
+    for (int p = 0 ; p <= nbProviders ; ++p)
+    {
+        pb::remote::ResponseGlobalSearch &batch = batches[p];
+        batch.set_id(p == 0 ? queryId - 1 : queryId);
+        batch.set_query(p == 0 ? "son" : "song");
+        batch.set_search_provider(QString("Provider %1").arg(p).toStdString());
+        batch.set_search_provider_icon(std::string(2048, 'x'));
+        for (int i = 0 ; i < batchSize ; ++i)
+        {
+            pb::remote::SongMetadata *song = batch.add_song_metadata();
+            fillSong(song, p * batchSize / 2 + i);
+            song->set_url(QString("file:///music/%1.mp3").arg(p * batchSize / 2 + i).toStdString());
+        }
+    }
+
+    GlobalSearchModel *model = _remote->_globalSearchModel;
+    QBENCHMARK {
+        model->forgetStaleIds(); // the same query id at each pass (start makes it stale)
+        model->start("song");
+        QVERIFY(model->setStatus(queryId, "song", false));
+        for (const pb::remote::ResponseGlobalSearch &batch : batches)
+            model->merge(batch);
+        model->setStatus(queryId, "song", true);
+    }
+    QCOMPARE(model->nbResults(), qMin(GlobalSearchModel::sMaxResults, (nbProviders + 1) * batchSize / 2));
+    QVERIFY(!model->isSearching());
+    qInfo() << model->stats();
+}
+
+
+void ClementineBench::libraryFilter_data()
+{
+    QTest::addColumn<QString>("filter");
+
+    QTest::newRow("match artists") << "artist 1";
+    QTest::newRow("match tracks")  << "song 12";
+    QTest::newRow("no match")      << "nothing like that";
+}
+
+void ClementineBench::libraryFilter()
+{
+    QFETCH(QString, filter);
+
+    if (_remote->libraryModel()->rowCount() != 100)
+        QVERIFY(loadLibrary(10000));
+    QBENCHMARK { // filter + clear
+        _remote->setLibraryFilter(filter);
+        _remote->setLibraryFilter(QString());
+    }
+}
+
+
+void ClementineBench::selectSongs_data()
+{
+    QTest::addColumn<QString>("filter");
+
+    QTest::newRow("all songs")      << QString();
+    QTest::newRow("filtered songs") << "song 1";
+}
+
+void ClementineBench::selectSongs()
+{
+    QFETCH(QString, filter);
+
+    loadSongs(10000);
+    _remote->setSongsFilter(filter);
+    int nbSelected = 0;
+    int nbMerged = _remote->updateScheduler()->nbMerged();
+    QBENCHMARK { // select all, get the selection, unselect (each in its own frame)
+        _remote->selectAllSongsFromProxyModel(true);
+        _remote->updateScheduler()->flush();
+        nbSelected = _remote->_songsProxyModel->selectedSongsIDs().size();
+        _remote->selectAllSongsFromProxyModel(false);
+        _remote->updateScheduler()->flush();
+    }
+    QCOMPARE(nbSelected, _remote->modelRemoteSongs()->rowCount());
+    QVERIFY(nbSelected < 2 || _remote->updateScheduler()->nbMerged() > nbMerged);
+    _remote->setSongsFilter(QString());
+}
+
+
+void ClementineBench::downloadSong_data()
+{
+    QTest::addColumn<int>("fileSize");
+    QTest::addColumn<int>("chunkSize");
+
+    QTest::newRow("4 MB (chunks of 64 kB)")   << 4 * 1024 * 1024  << 64 * 1024;
+    QTest::newRow("32 MB (chunks of 64 kB)")  << 32 * 1024 * 1024 << 64 * 1024;
+    QTest::newRow("32 MB (chunks of 512 kB)") << 32 * 1024 * 1024 << 512 * 1024;
+}
+
+void ClementineBench::downloadSong()
+{
+    QFETCH(int, fileSize);
+    QFETCH(int, chunkSize);
+
+    QByteArray data(fileSize, Qt::Uninitialized);
+    for (int i = 0 ; i < fileSize ; ++i)
+        data[i] = static_cast<char>(i * 31 + (i >> 12));
+    QByteArray sha1 = QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+
+    int nbChunks = (fileSize + chunkSize - 1) / chunkSize;
+    QList<pb::remote::ResponseSongFileChunk> chunks;
+    pb::remote::ResponseSongFileChunk offer;
+    offer.set_chunk_number(0);
+    offer.set_chunk_count(nbChunks);
+    offer.set_file_number(1);
+    offer.set_file_count(1);
+    offer.set_size(fileSize);
+    fillSong(offer.mutable_song_metadata(), 1);
+    chunks << offer;
+    for (int i = 1 ; i <= nbChunks ; ++i)
+    {
+        pb::remote::ResponseSongFileChunk chunk;
+        chunk.set_chunk_number(i);
+        chunk.set_chunk_count(nbChunks);
+        chunk.set_file_number(1);
+        chunk.set_file_count(1);
+        chunk.set_size(fileSize);
+        int offset = (i - 1) * chunkSize;
+        chunk.set_data(data.constData() + offset, static_cast<size_t>(qMin(chunkSize, fileSize - offset)));
+        if (i == nbChunks)
+            chunk.set_file_hash(sha1.constData(), static_cast<size_t>(sha1.size()));
+        chunks << chunk;
+    }
+
+    ConnectionWorker worker(_remote);
+    worker.detachFromRemote();
+    QString filePath = QString("%1/%2").arg(_tmpDir.path()).arg(RemoteSong(offer.song_metadata()).filename);
+    pb::remote::ResponseDownloadTotalSize downloadSize;
+    downloadSize.set_file_count(1);
+    downloadSize.set_total_size(fileSize);
+
+    QBENCHMARK {
+        worker.prepareDownload(downloadSize);
+        worker._songsDL.downloadPath = _tmpDir.path();
+        for (const auto &chunk : chunks)
+            worker.downloadSong(chunk);
+        QFile::remove(filePath);
+    }
+    QCOMPARE(worker._songsDL.downloadedFiles, 1);
+}
+
+
+void ClementineBench::shedLibrary_data()
+{
+    QTest::addColumn<int>("nbTracks");
+
+    QTest::newRow("10k tracks")  << 10000;
+    QTest::newRow("100k tracks") << 100000;
+}
+
+void ClementineBench::shedLibrary()
+{
+    QFETCH(int, nbTracks);
+
+    QVERIFY(loadLibrary(nbTracks));
+    QBENCHMARK { // eviction + reload on the next access
+        _remote->simulateMemoryPressure(static_cast<int>(MemoryPressure::Tier::library));
+        _remote->requestLibrary();
+        QCoreApplication::processEvents(); // libraryDownloaded is queued
+    }
+    QVERIFY(_remote->isLibraryLoaded());
+}
+
+void ClementineBench::sessionOverhead_data()
+{
+    QTest::addColumn<QByteArray>("stream");
+    QTest::addColumn<int>("nbPlaylists");
+
+    for (int nbPlaylists : {5, 40})
+    {
+        QByteArray stream;
+        pb::remote::Message msg;
+        msg.set_type(pb::remote::CURRENT_METAINFO);
+        fillSong(msg.mutable_response_current_metadata()->mutable_song_metadata(), 1);
+        stream.append(frame(msg));
+        for (qint32 playlistID = 1 ; playlistID <= nbPlaylists ; ++playlistID)
+        {
+            msg.Clear();
+            msg.set_type(pb::remote::PLAYLIST_SONGS);
+            playlistSongsMsg(*msg.mutable_response_playlist_songs(), playlistID, 2500);
+            stream.append(frame(msg));
+        }
+        QTest::newRow(qPrintable(QString("%1 x 2500 songs").arg(nbPlaylists))) << stream << nbPlaylists;
+    }
+}
+
+void ClementineBench::sessionOverhead()
+{
+    QFETCH(QByteArray, stream);
+    QFETCH(int, nbPlaylists);
+
+    ConnectionWorker worker(_remote);
+    worker.detachFromRemote();
+    worker._background = 0x1;
+
+    QBuffer buffer(&stream);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QBENCHMARK { // recording of the frames of a background session
+        buffer.seek(0);
+        worker.readFrames(&buffer);
+    }
+
+    // no extra thread: all the workers share the connection thread
+    qint64 storeBytes = worker.store().memoryUsage();
+    QVERIFY(storeBytes <= static_cast<qint64>(SessionStore::sMaxPlaylistSongsMB + 1) * 1024 * 1024);
+    qInfo() << "session overhead for " << nbPlaylists << " playlists: ConnectionWorker "
+            << sizeof(ConnectionWorker) << " bytes + store " << storeBytes / 1024 << " kB (stream of "
+            << stream.size() / 1024 << " kB)";
+}
+
+QTEST_GUILESS_MAIN(ClementineBench)
@@ -0,0 +1,110 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef CLEMENTINEBENCH_H
+#define CLEMENTINEBENCH_H
+#include "protobuf/remotecontrolmessages.pb.h"
+#include <QObject>
+#include <QTemporaryDir>
+class ClementineRemote;
+
+/*!
+ * \brief QBENCHMARK of the hot paths of the client on synthetic fixtures
+ * (no server needed)
+ *
+ * machine readable results: ./clemremote-bench -o results.xml,xml
+ * or -csv (cf QtTest logging options)
+ */
+class ClementineBench : public QObject
+{
+    Q_OBJECT
+
+private:
+    ClementineRemote *_remote;
+    QTemporaryDir     _tmpDir; //!< library DBs and downloaded files
+
+public:
+    ClementineBench(QObject *parent = nullptr);
+    ~ClementineBench() = default;
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void readFrames_data();
+    void readFrames();          //!< framing (ConnectionWorker::onReadyRead) + ClementineRemote::parseMessage
+
+    void remoteSong_data();
+    void remoteSong();          //!< RemoteSong construction (full and projected)
+
+    void rcvPlaylists_data();
+    void rcvPlaylists();        //!< keyed reconciliation of the playlist models
+
+    void utf8Strings_data();
+    void utf8Strings();         //!< protobuf strings to QString (Utf8 vs c_str())
+
+    void rcvPlaylistSongs_data();
+    void rcvPlaylistSongs();
+
+    void decodeSongs_data();
+    void decodeSongs();         //!< SongsDecoder scaling from 1 to N threads (100k songs)
+
+    void updateActiveSong_data();
+    void updateActiveSong();    //!< CURRENT_METAINFO lookup in the SongsIndex
+
+    void libraryDownloaded_data();
+    void libraryDownloaded();   //!< tree built from the SQLite library
+
+    void libraryHierarchy_data();
+    void libraryHierarchy();    //!< LibraryTable groupings
+    void songsFilter_data();
+    void songsFilter();         //!< RemoteSongProxyModel
+    void sortSongs_data();
+    void sortSongs();           //!< SongsSorter + RemoteSongProxyModel
+    void searchPlaylists_data();
+    void searchPlaylists();     //!< PlaylistsSearchIndex over 40 playlists
+    void globalSearch_data();
+    void globalSearch();        //!< merge of the GLOBAL_SEARCH_RESULT batches (dedup by url, stale ones dropped)
+
+    void libraryFilter_data();
+    void libraryFilter();       //!< LibraryProxyModel
+
+    void selectSongs_data();
+    void selectSongs();
+
+    void downloadSong_data();
+    void downloadSong();        //!< write of the chunks and SHA-1 verification
+
+    void shedLibrary_data();
+    void shedLibrary();         //!< memory pressure on the library tree and its reload from the DB
+
+    void sessionOverhead_data();
+    void sessionOverhead();     //!< memory of a background session of the multi-room (its SessionStore)
+
+private:
+    static void fillSong(pb::remote::SongMetadata *song, int idx);
+    static QByteArray frame(const pb::remote::Message &msg); //!< with its length prefix
+    static void playlistSongsMsg(pb::remote::ResponsePlaylistSongs &songs, qint32 playlistID, int nbSongs);
+
+    void loadSongs(int nbSongs);
+    bool loadLibrary(int nbTracks);
+    bool createLibraryDB(const QString &dbPath, int nbTracks);
+};
+
+#endif // CLEMENTINEBENCH_H
@@ -0,0 +1,36 @@
+# clemremote-bench: QBENCHMARK of the client's hot paths on synthetic fixtures
+# to be built in release (no qDebug) and run with a machine readable output
+# so the results can be compared between releases:
+#   ./clemremote-bench -o bench.xml,xml
+#   ./clemremote-bench -csv
+QT += core network sql gui testlib
+QT -= quick
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = clemremote-bench
+
+# only for the DEFINES and INCLUDEPATH, the sources come from the core library
+include(../core.pri)
+
+LIBS += -L$$OUT_PWD/../core/ -lclemremotecore
+win32: PRE_TARGETDEPS += $$OUT_PWD/../core/clemremotecore.lib
+else:  PRE_TARGETDEPS += $$OUT_PWD/../core/libclemremotecore.a
+
+linux {
+    LIBS += -L$$PWD/../../protobuf-3.13.0/lib/x86_64/ -lprotobuf
+}
+macx{
+    LIBS += -L$$PWD/../../protobuf-3.13.0/lib/macx/ -lprotobuf
+    PRE_TARGETDEPS += $$PWD/../../protobuf-3.13.0/lib/macx/libprotobuf.a
+}
+win32{
+    LIBS += -L$$PWD/../../protobuf-3.13.0/lib/win64/ -lprotobuf
+}
+
+SOURCES += \
+        ClementineBench.cpp
+
+HEADERS += \
+    ClementineBench.h
@@ -0,0 +1,424 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "CliDriver.h"
+#include "ClementineRemote.h"
+#include "player/RemotePlaylist.h"
+#include "player/RemoteSong.h"
+#include "utils/Macro.h"
+#include <QAbstractItemModel>
+#include <QDebug>
+
+const QMap<QString, CliDriver::Command> CliDriver::sCommands = {
+    {"playlists",        Command::playlists},
+    {"songs",            Command::songs},
+    {"library",          Command::library},
+    {"download",         Command::download},
+    {"switch-playlists", Command::switchPlaylists},
+    {"soak",             Command::soak},
+    {"search",           Command::search}
+};
+
+CliDriver::CliDriver(ClementineRemote *remote, Command cmd, const QStringList &args,
+                     const Options &opt, QObject *parent):
+    QObject(parent),
+    _remote(remote), _cmd(cmd), _args(args), _opt(opt),
+    _out(stdout), _timeout(), _elapsed(),
+    _running(false),
+    _switchPlaylists(), _switchStep(0), _switchPlaylistID(-1), _switchTimes(),
+    _soakTimer(), _firstResultsMs(-1)
+{
+    _timeout.setSingleShot(true);
+    _timeout.setInterval(_opt.timeoutSec * 1000);
+    connect(&_timeout, &QTimer::timeout, this, &CliDriver::onTimeout);
+
+    connect(_remote, &ClementineRemote::connected,       this, &CliDriver::onConnected);
+    connect(_remote, &ClementineRemote::disconnected,    this, &CliDriver::onDisconnected);
+    connect(_remote, &ClementineRemote::connectionError, this, &CliDriver::onConnectionError);
+    connect(_remote, &ClementineRemote::error, this, [this](const QString &title, const QString &msg){
+        _out << "[error] " << title << ": " << msg << "\n" << M_FLUSH;
+    });
+    connect(_remote, &ClementineRemote::info, this, [this](const QString &title, const QString &msg){
+        _out << "[info] " << title << ": " << msg << "\n" << M_FLUSH;
+    });
+}
+
+void CliDriver::start()
+{
+    _out << "Connecting to " << _opt.host << ":" << _opt.port << "...\n" << M_FLUSH;
+    _elapsed.start();
+    _timeout.start();
+    _remote->attachUI(); // no QML to wait for
+    _remote->tryConnectToServer(0, _opt.host, _opt.port, _opt.authCode);
+}
+
+void CliDriver::onConnected()
+{
+    if (_running)
+        return; // reconnection
+    _timeout.stop();
+    _running = true;
+    _out << "Connected to Clementine " << _remote->clemVersion() << " in "
+         << _elapsed.elapsed() << " ms\n" << M_FLUSH;
+
+    // let ClementineRemote finish its own handling of the connection
+    QTimer::singleShot(0, this, &CliDriver::runCommand);
+}
+
+void CliDriver::onDisconnected(const QString &reason)
+{
+    _out << "Disconnected: " << reason << "\n" << M_FLUSH;
+    finish(2);
+}
+
+void CliDriver::onConnectionError(const QString &err)
+{
+    _out << "Connection error: " << err << "\n" << M_FLUSH;
+    finish(2);
+}
+
+void CliDriver::onTimeout()
+{
+    _out << "Timeout after " << _opt.timeoutSec << " sec" << (_running ? "" : " (not connected)") << "\n" << M_FLUSH;
+    finish(3);
+}
+
+void CliDriver::finish(int exitCode)
+{
+    _timeout.stop();
+    _soakTimer.stop();
+    disconnect(_remote, nullptr, this, nullptr);
+    emit done(exitCode);
+}
+
+void CliDriver::runCommand()
+{
+    switch (_cmd) {
+    case Command::playlists:
+        listPlaylists();
+        break;
+    case Command::songs:
+        listSongs();
+        break;
+    case Command::library:
+        dumpLibrary();
+        break;
+    case Command::download:
+        downloadPlaylist();
+        break;
+    case Command::switchPlaylists:
+        switchPlaylists();
+        break;
+    case Command::soak:
+        soak();
+        break;
+    case Command::search:
+        globalSearch();
+        break;
+    }
+}
+
+int CliDriver::playlistIndexFromArg() const
+{
+    bool ok = false;
+    qint32 playlistID = _args.isEmpty() ? _remote->playlistID() : _args.first().toInt(&ok);
+    if (!_args.isEmpty() && !ok)
+        return -1;
+
+    for (int i = 0 ; i < _remote->numberOfPlaylists() ; ++i)
+    {
+        if (_remote->playlist(i)->id == playlistID)
+            return i;
+    }
+    return -1;
+}
+
+void CliDriver::listPlaylists()
+{
+    int nbPlaylists = _remote->numberOfPlaylists();
+    _out << nbPlaylists << " opened playlist(s):\n";
+    for (int i = 0 ; i < nbPlaylists ; ++i)
+        _out << "  " << _remote->playlist(i)->str() << "\n";
+    _out << M_FLUSH;
+    finish(0);
+}
+
+void CliDriver::listSongs()
+{
+    int pIdx = playlistIndexFromArg();
+    if (pIdx == -1)
+    {
+        _out << "Unknown playlist: " << _args.value(0) << "\n" << M_FLUSH;
+        finish(1);
+        return;
+    }
+
+    _switchPlaylistID = _remote->playlist(pIdx)->id;
+    if (_remote->displayedPlaylistID() == _switchPlaylistID)
+    {
+        onSongsDisplayed();
+        return;
+    }
+
+    // connect before emitting: a cache hit is displayed synchronously
+    connect(_remote, &ClementineRemote::postSongAppended, this, &CliDriver::onSongsDisplayed);
+    _elapsed.start();
+    _timeout.start();
+    emit _remote->changePlaylist(pIdx);
+}
+
+void CliDriver::onSongsDisplayed()
+{
+    if (_remote->displayedPlaylistID() != _switchPlaylistID)
+        return;
+    _timeout.stop();
+    disconnect(_remote, &ClementineRemote::postSongAppended, this, &CliDriver::onSongsDisplayed);
+
+    int nbSongs = _remote->numberOfPlaylistSongs(), nbNotLoaded = 0;
+    _out << "Playlist #" << _switchPlaylistID << ": " << nbSongs << " song(s)\n";
+    for (int i = 0 ; i < nbSongs ; ++i)
+    {
+        if (_remote->isPlaylistSongLoaded(i))
+            _out << "  " << _remote->playlistSong(i).str() << "\n";
+        else
+            ++nbNotLoaded;
+    }
+    if (nbNotLoaded)
+        _out << "  (" << nbNotLoaded << " song(s) not loaded: paged playlist)\n";
+    _out << M_FLUSH;
+    finish(0);
+}
+
+void CliDriver::dumpLibrary()
+{
+    connect(_remote, &ClementineRemote::libraryLoaded, this, &CliDriver::onLibraryLoaded);
+    _elapsed.start();
+    _timeout.start();
+    if (_remote->isLibraryLoaded())
+        onLibraryLoaded();
+    else
+        _remote->getLibrary();
+}
+
+void CliDriver::onLibraryLoaded()
+{
+    _timeout.stop();
+    disconnect(_remote, &ClementineRemote::libraryLoaded, this, &CliDriver::onLibraryLoaded);
+    qint64 loadTime = _elapsed.elapsed();
+
+    int nbItems = dumpItems(QModelIndex(), 0);
+    _out << "Library: " << nbItems << " item(s) loaded in " << loadTime << " ms\n" << M_FLUSH;
+    finish(0);
+}
+
+int CliDriver::dumpItems(const QModelIndex &parent, int depth)
+{
+    QAbstractItemModel *model = _remote->libraryModel();
+    int nbRows = model->rowCount(parent), nbItems = nbRows;
+    for (int row = 0 ; row < nbRows ; ++row)
+    {
+        QModelIndex idx = model->index(row, 0, parent);
+        _out << QString(2 * (depth + 1), ' ') << model->data(idx).toString() << "\n";
+        nbItems += dumpItems(idx, depth + 1);
+    }
+    return nbItems;
+}
+
+void CliDriver::downloadPlaylist()
+{
+    int pIdx = playlistIndexFromArg();
+    if (pIdx == -1)
+    {
+        _out << "Unknown playlist: " << _args.value(0) << "\n" << M_FLUSH;
+        finish(1);
+        return;
+    }
+    if (!_remote->downloadsAllowed())
+    {
+        _out << "Downloads are not allowed by the server\n" << M_FLUSH;
+        finish(1);
+        return;
+    }
+    if (!_opt.destFolder.isEmpty())
+        _remote->updateDownloadPath(_opt.destFolder);
+
+    const RemotePlaylist *p = _remote->playlist(pIdx);
+    _out << "Downloading playlist " << p->str() << " in " << _remote->downloadPath() << "\n" << M_FLUSH;
+
+    connect(_remote, &ClementineRemote::downloadProgress, this, &CliDriver::onDownloadProgress);
+    connect(_remote, &ClementineRemote::downloadComplete, this, &CliDriver::onDownloadComplete);
+    _elapsed.start();
+    _timeout.start();
+    emit _remote->downloadPlaylist(p->id, p->name);
+}
+
+void CliDriver::onDownloadProgress(double pct)
+{
+    _timeout.start(); // only a stalled download times out
+    _out << QString("\r  %1%").arg(pct, 0, 'f', 1) << M_FLUSH;
+}
+
+void CliDriver::onDownloadComplete(qint32 downloadedFiles, qint32 totalFiles, const QStringList &errors)
+{
+    _out << "\nDownloaded " << downloadedFiles << "/" << totalFiles << " file(s) in "
+         << _elapsed.elapsed() << " ms\n";
+    for (const QString &err : errors)
+        _out << "  - " << err << "\n";
+    _out << M_FLUSH;
+    finish(errors.isEmpty() ? 0 : 1);
+}
+
+void CliDriver::switchPlaylists()
+{
+    for (int i = 0 ; i < _remote->numberOfPlaylists() ; ++i)
+    {
+        if (_remote->playlist(i)->item_count > 0)
+            _switchPlaylists << i;
+    }
+    if (_switchPlaylists.size() < 2)
+    {
+        _out << "Need at least 2 opened playlists with songs\n" << M_FLUSH;
+        finish(1);
+        return;
+    }
+
+    _out << "Switching " << _opt.iterations << " time(s) between " << _switchPlaylists.size() << " playlists\n" << M_FLUSH;
+    connect(_remote, &ClementineRemote::postSongAppended, this, &CliDriver::onSwitchDisplayed);
+    connect(_remote, &ClementineRemote::songsUpdated, this, [this](int firstSongIdx){
+        if (firstSongIdx == 0) // same number of songs: updated in place
+            onSwitchDisplayed();
+    });
+    _switchStep = 0;
+    nextSwitch();
+}
+
+void CliDriver::nextSwitch()
+{
+    if (_switchStep == _opt.iterations * _switchPlaylists.size())
+    {
+        qint64 total = 0, worst = 0;
+        for (qint64 ms : _switchTimes)
+        {
+            total += ms;
+            if (ms > worst)
+                worst = ms;
+        }
+        _out << "switch-playlists: " << _switchTimes.size() << " switches, avg: "
+             << (_switchTimes.isEmpty() ? 0 : total / _switchTimes.size()) << " ms, worst: " << worst << " ms\n"
+             << M_FLUSH;
+        finish(0);
+        return;
+    }
+
+    int pIdx = _switchPlaylists.at(_switchStep % _switchPlaylists.size());
+    _switchPlaylistID = _remote->playlist(pIdx)->id;
+    if (_remote->displayedPlaylistID() == _switchPlaylistID)
+    {   // that would be a refresh, not a switch
+        ++_switchStep;
+        nextSwitch();
+        return;
+    }
+    _elapsed.start();
+    _timeout.start();
+    emit _remote->changePlaylist(pIdx); // a cache hit calls onSwitchDisplayed synchronously
+}
+
+void CliDriver::onSwitchDisplayed()
+{
+    if (!_timeout.isActive() || _remote->displayedPlaylistID() != _switchPlaylistID)
+        return;
+    _timeout.stop();
+
+    qint64 ms = _elapsed.elapsed();
+    _switchTimes << ms;
+    _out << "  playlist #" << _switchPlaylistID << " displayed in " << ms << " ms ("
+         << _remote->numberOfPlaylistSongs() << " songs)\n" << M_FLUSH;
+
+    ++_switchStep;
+    QTimer::singleShot(0, this, &CliDriver::nextSwitch); // don't recurse in the model signals
+}
+
+void CliDriver::soak()
+{
+    _out << "Soak test for " << _opt.durationSec << " sec (report every " << sSoakReportPeriodSec << " sec)\n" << M_FLUSH;
+    _timeout.stop();
+    _elapsed.start();
+    connect(&_soakTimer, &QTimer::timeout, this, &CliDriver::onSoakReport);
+    _soakTimer.start(sSoakReportPeriodSec * 1000);
+}
+
+void CliDriver::onSoakReport()
+{
+    qint64 elapsedSec = _elapsed.elapsed() / 1000;
+    _out << "[" << elapsedSec << " s] readyRead/min: " << _remote->readyReadsPerMinute()
+         << ", optimistic updates: " << _remote->optimisticUpdatesStats() << "\n"
+         << "model updates: " << _remote->modelUpdatesStats() << "\n"
+         << "playlists search: " << _remote->playlistsSearchStats() << "\n"
+         << _remote->sessionsReport() << "\n"
+         << "memory:\n" << _remote->memoryReportStr() << "\n" << M_FLUSH;
+
+    if (elapsedSec >= _opt.durationSec)
+        finish(0);
+}
+
+void CliDriver::globalSearch()
+{
+    QString query = _args.join(" ");
+    if (query.trimmed().size() < ClementineRemote::sGlobalSearchMinLength)
+    {
+        _out << "The query needs at least " << ClementineRemote::sGlobalSearchMinLength << " characters\n" << M_FLUSH;
+        finish(1);
+        return;
+    }
+
+    QAbstractItemModel *model = _remote->modelGlobalSearch();
+    connect(model, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex &, int first, int last){
+        if (_firstResultsMs == -1)
+            _firstResultsMs = _elapsed.elapsed();
+        _timeout.start(); // only a stalled search times out
+        _out << "  +" << last - first + 1 << " result(s) after " << _elapsed.elapsed() << " ms\n" << M_FLUSH;
+    });
+    connect(_remote, &ClementineRemote::globalSearchStatus, this, &CliDriver::onGlobalSearchStatus);
+    _out << "Global search: " << query << "\n" << M_FLUSH;
+    _elapsed.start();
+    _timeout.start();
+    _remote->globalSearch(query);
+}
+
+void CliDriver::onGlobalSearchStatus(bool searching)
+{
+    if (searching)
+        return;
+    _timeout.stop();
+    disconnect(_remote->modelGlobalSearch(), nullptr, this, nullptr);
+
+    QAbstractItemModel *model = _remote->modelGlobalSearch();
+    int nbResults = model->rowCount();
+    for (int row = 0 ; row < nbResults ; ++row)
+    {
+        QModelIndex idx = model->index(row, 0);
+        _out << "  [" << model->data(idx, GlobalSearchModel::provider).toString() << "] "
+             << model->data(idx, GlobalSearchModel::artist).toString() << " - "
+             << model->data(idx, GlobalSearchModel::title).toString() << " ("
+             << model->data(idx, GlobalSearchModel::url).toString() << ")\n";
+    }
+    _out << "search: " << nbResults << " result(s) in " << _elapsed.elapsed() << " ms, first ones after "
+         << _firstResultsMs << " ms\n" << _remote->globalSearchStats() << "\n" << M_FLUSH;
+    finish(nbResults ? 0 : 1);
+}
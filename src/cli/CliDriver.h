@@ -0,0 +1,119 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef CLIDRIVER_H
+#define CLIDRIVER_H
+#include <QObject>
+#include <QMap>
+#include <QModelIndex>
+#include <QStringList>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QTextStream>
+class ClementineRemote;
+
+/*!
+ * \brief drives ClementineRemote without any QML
+ * so the protocol and the models can be exercised headless
+ * (scripts, CI, profiling sessions...)
+ */
+class CliDriver : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Command {playlists, songs, library, download, switchPlaylists, soak, search};
+    static const QMap<QString, Command> sCommands;
+
+    typedef struct Options
+    {
+        QString host;
+        ushort  port;
+        int     authCode;
+        QString destFolder;
+        int     iterations;  //!< for switch-playlists
+        int     durationSec; //!< for soak
+        int     timeoutSec;  //!< to connect and for each step
+    } Options;
+
+private:
+    ClementineRemote *_remote;
+    const Command     _cmd;
+    const QStringList _args;
+    const Options     _opt;
+
+    QTextStream   _out;
+    QTimer        _timeout;
+    QElapsedTimer _elapsed;
+
+    bool _running; //!< connected and the command has been started
+
+    // switch-playlists
+    QList<int> _switchPlaylists; //!< indexes of the opened playlists with songs
+    int        _switchStep;
+    qint32     _switchPlaylistID;
+    QList<qint64> _switchTimes;
+
+    QTimer _soakTimer;
+
+    qint64 _firstResultsMs; //!< search: -1 until the first rows are appended
+
+    static const int sSoakReportPeriodSec = 10;
+
+public:
+    CliDriver(ClementineRemote *remote, Command cmd, const QStringList &args,
+              const Options &opt, QObject *parent = nullptr);
+    ~CliDriver() = default;
+
+    void start();
+
+signals:
+    void done(int exitCode);
+
+private slots:
+    void onConnected();
+    void onDisconnected(const QString &reason);
+    void onConnectionError(const QString &err);
+    void onTimeout();
+
+    void onSongsDisplayed();
+    void onSwitchDisplayed();
+    void onLibraryLoaded();
+    void onDownloadProgress(double pct);
+    void onDownloadComplete(qint32 downloadedFiles, qint32 totalFiles, const QStringList &errors);
+    void onSoakReport();
+    void onGlobalSearchStatus(bool searching);
+
+private:
+    void runCommand();
+    void listPlaylists();
+    void listSongs();
+    void dumpLibrary();
+    void downloadPlaylist();
+    void switchPlaylists();
+    void nextSwitch();
+    void soak();
+    void globalSearch();
+
+    int playlistIndexFromArg() const; //!< index in the opened playlists of the ID given in _args
+    int dumpItems(const QModelIndex &parent, int depth);
+    void finish(int exitCode);
+};
+
+#endif // CLIDRIVER_H
@@ -0,0 +1,34 @@
+# clemremote-cli: drives the headless core without any QML
+# (connect, list playlists, dump the library, downloads, timed scenarios)
+QT += core network sql gui
+QT -= quick
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = clemremote-cli
+
+# only for the DEFINES and INCLUDEPATH, the sources come from the core library
+include(../core.pri)
+
+LIBS += -L$$OUT_PWD/../core/ -lclemremotecore
+win32: PRE_TARGETDEPS += $$OUT_PWD/../core/clemremotecore.lib
+else:  PRE_TARGETDEPS += $$OUT_PWD/../core/libclemremotecore.a
+
+linux {
+    LIBS += -L$$PWD/../../protobuf-3.13.0/lib/x86_64/ -lprotobuf
+}
+macx{
+    LIBS += -L$$PWD/../../protobuf-3.13.0/lib/macx/ -lprotobuf
+    PRE_TARGETDEPS += $$PWD/../../protobuf-3.13.0/lib/macx/libprotobuf.a
+}
+win32{
+    LIBS += -L$$PWD/../../protobuf-3.13.0/lib/win64/ -lprotobuf
+}
+
+SOURCES += \
+        CliDriver.cpp \
+        main.cpp
+
+HEADERS += \
+    CliDriver.h
@@ -0,0 +1,85 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+
+#include "ClementineRemote.h"
+#include "CliDriver.h"
+#include "utils/Macro.h"
+#include "utils/TraceRecorder.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("clemremote-cli"); // its own settings, not the ones of the GUI
+    app.setApplicationVersion(ClementineRemote::appVersion());
+    app.setOrganizationName(ClementineRemote::appName());
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QString("%1 headless driver").arg(ClementineRemote::appTitle()));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOptions({
+        {{"H", "host"},   "Clementine server.", "host", "127.0.0.1"},
+        {{"p", "port"},   "remote control port.", "port", "5500"},
+        {{"a", "auth"},   "authentication code.", "code", "-1"},
+        {"dest",          "download folder (download).", "folder"},
+        {"iterations",    "number of cycles over the playlists (switch-playlists).", "n", "3"},
+        {"duration",      "duration in seconds (soak).", "sec", "60"},
+        {"timeout",       "timeout in seconds to connect and for each step.", "sec", "30"},
+        {"trace",         "Chrome trace-event JSON of the run.", "file"}
+    });
+    parser.addPositionalArgument("command", QString("one of: %1").arg(CliDriver::sCommands.keys().join(", ")));
+    parser.addPositionalArgument("playlistID", "for songs and download (default: current playlist)", "[playlistID]");
+    parser.addPositionalArgument("query", "for search", "[query]");
+    parser.process(app);
+
+    QStringList args = parser.positionalArguments();
+    if (args.isEmpty() || !CliDriver::sCommands.contains(args.first()))
+    {
+        QTextStream(stderr) << "Unknown command: " << args.value(0) << "\n" << parser.helpText() << M_FLUSH;
+        return 1;
+    }
+    CliDriver::Command cmd = CliDriver::sCommands.value(args.takeFirst());
+
+    CliDriver::Options opt;
+    opt.host        = parser.value("host");
+    opt.port        = static_cast<ushort>(parser.value("port").toUInt());
+    opt.authCode    = parser.value("auth").toInt();
+    opt.destFolder  = parser.value("dest");
+    opt.iterations  = parser.value("iterations").toInt();
+    opt.durationSec = parser.value("duration").toInt();
+    opt.timeoutSec  = parser.value("timeout").toInt();
+
+    ClementineRemote *remote = ClementineRemote::getInstance();
+    CliDriver driver(remote, cmd, args, opt);
+    QObject::connect(&driver, &CliDriver::done, &app, &QCoreApplication::exit, Qt::QueuedConnection);
+    QString traceFile = parser.value("trace");
+    if (!traceFile.isEmpty())
+        TraceRecorder::setEnabled(true);
+    driver.start();
+
+    int exitCode = app.exec();
+    remote->close();
+    if (!traceFile.isEmpty() && TraceRecorder::exportChromeTrace(traceFile))
+        QTextStream(stdout) << "Trace saved in " << traceFile << "\n" << M_FLUSH;
+    return exitCode;
+}
@@ -0,0 +1,100 @@
+# Protocol, network worker, state and models of ClementineRemote
+# without any QtQuick dependency (QtGui is still needed for QImage,
+# QStandardItemModel and the application state)
+# used by ClementineRemote.pro (GUI), core/core.pro (static lib) and cli/cli.pro
+
+CONFIG += c++17
+
+# parallel decoding of the big playlists (player/SongsDecoder)
+QT += concurrent
+
+# possible to remove the Connection Thread as Sockets are Async
+# cf https://forum.qt.io/topic/120468/qabstractlistmodel-populated-in-a-worker-thread-not-the-gui-one
+DEFINES  += __USE_CONNECTION_THREAD__
+
+INCLUDEPATH += $$PWD $$PWD/../protobuf-3.13.0/src
+DEPENDPATH += $$PWD $$PWD/../protobuf-3.13.0/src
+
+CONFIG(debug, debug|release) :{
+    DEFINES += __DEBUG__
+}
+else {
+    # In release mode, remove all qDebugs !
+    DEFINES += QT_NO_DEBUG_OUTPUT
+}
+
+# The following define makes your compiler emit warnings if you use
+# any Qt feature that has been marked deprecated (the exact warnings
+# depend on your compiler). Refer to the documentation for the
+# deprecated API to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# You can also make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+# You can also select to disable deprecated APIs only up to a certain version of Qt.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+
+CORE_SOURCES = \
+        $$PWD/ClementineRemote.cpp \
+        $$PWD/ConnectionWorker.cpp \
+        $$PWD/model/GlobalSearchModel.cpp \
+        $$PWD/model/LibraryModel.cpp \
+        $$PWD/model/LibraryTable.cpp \
+        $$PWD/model/PlaylistModel.cpp \
+        $$PWD/model/PlaylistsSearchModel.cpp \
+        $$PWD/model/RadioStreamModel.cpp \
+        $$PWD/model/RemoteFileModel.cpp \
+        $$PWD/model/RemoteSongModel.cpp \
+        $$PWD/model/UpdateScheduler.cpp \
+        $$PWD/player/PagedPlaylistSongs.cpp \
+        $$PWD/player/PlaybackClock.cpp \
+        $$PWD/player/PlaylistSongsCache.cpp \
+        $$PWD/player/PlaylistsSearchIndex.cpp \
+        $$PWD/player/RemoteSong.cpp \
+        $$PWD/player/SongsDecoder.cpp \
+        $$PWD/player/SongsIndex.cpp \
+        $$PWD/player/SongsSorter.cpp \
+        $$PWD/protobuf/remotecontrolmessages.pb.cc \
+        $$PWD/utils/Downloader.cpp \
+        $$PWD/utils/MemoryPressure.cpp \
+        $$PWD/utils/PendingOperations.cpp \
+        $$PWD/utils/ServerDiscovery.cpp \
+        $$PWD/utils/SessionStore.cpp \
+        $$PWD/utils/TraceRecorder.cpp \
+        $$PWD/utils/Utf8.cpp
+
+CORE_HEADERS = \
+    $$PWD/ClementineRemote.h \
+    $$PWD/ClementineSession.h \
+    $$PWD/ConnectionWorker.h \
+    $$PWD/model/GlobalSearchModel.h \
+    $$PWD/model/LibraryModel.h \
+    $$PWD/model/LibraryTable.h \
+    $$PWD/model/PlaylistModel.h \
+    $$PWD/model/PlaylistsSearchModel.h \
+    $$PWD/model/RadioStreamModel.h \
+    $$PWD/model/RemoteFileModel.h \
+    $$PWD/model/RemoteSongModel.h \
+    $$PWD/model/UpdateScheduler.h \
+    $$PWD/player/PagedPlaylistSongs.h \
+    $$PWD/player/PlaybackClock.h \
+    $$PWD/player/PlaylistSongsCache.h \
+    $$PWD/player/PlaylistsSearchIndex.h \
+    $$PWD/player/RemoteFile.h \
+    $$PWD/player/RemotePlaylist.h \
+    $$PWD/player/RemoteSong.h \
+    $$PWD/player/SongsDecoder.h \
+    $$PWD/player/SongsIndex.h \
+    $$PWD/player/SongsSorter.h \
+    $$PWD/player/Stream.h \
+    $$PWD/utils/Downloader.h \
+    $$PWD/utils/Macro.h \
+    $$PWD/utils/MemoryPressure.h \
+    $$PWD/utils/PendingOperations.h \
+    $$PWD/utils/ServerDiscovery.h \
+    $$PWD/utils/SessionStore.h \
+    $$PWD/utils/Singleton.h \
+    $$PWD/utils/TraceRecorder.h \
+    $$PWD/utils/Utf8.h \
+    $$PWD/protobuf/remotecontrolmessages.pb.h
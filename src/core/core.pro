@@ -0,0 +1,13 @@
+# headless core of ClementineRemote (no QtQuick)
+# linked by the CLI driver (cli/cli.pro)
+TEMPLATE = lib
+CONFIG += staticlib
+TARGET = clemremotecore
+
+QT += core network sql gui
+
+include(../core.pri)
+
+SOURCES += $$CORE_SOURCES
+
+HEADERS += $$CORE_HEADERS
@@ -20,6 +20,7 @@
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
+#include <QQuickWindow>
 
 #include "ClementineRemote.h"
 #include "ClementineSession.h"
@@ -28,6 +29,17 @@
 #include "model/RemoteFileModel.h"
 #include "model/RadioStreamModel.h"
 #include "model/LibraryModel.h"
+
+#if defined(Q_OS_ANDROID)
+#include <jni.h>
+
+//! ClementineRemote.java onTrimMemory / onLowMemory (called on the Android UI thread: only sets a flag)
+extern "C" JNIEXPORT void JNICALL Java_fr_mbruel_ClementineRemote_ClementineRemote_notifyLowMemory(JNIEnv *, jclass)
+{
+    MemoryPressure::requestLowMemory();
+}
+#endif
+
 int main(int argc, char *argv[])
 {
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
@@ -89,5 +101,10 @@ int main(int argc, char *argv[])
 
     engine.load(url);
 
+    // model updates are flushed once per frame, just before the scene graph is synchronized
+    if (QQuickWindow *window = qobject_cast<QQuickWindow*>(engine.rootObjects().value(0)))
+        QObject::connect(window, &QQuickWindow::afterAnimating,
+                         remote->updateScheduler(), &UpdateScheduler::flush);
+
     return app.exec();
 }
@@ -0,0 +1,217 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "GlobalSearchModel.h"
+#include "utils/TraceRecorder.h"
+#include <QDebug>
+
+const QHash<int, QByteArray> GlobalSearchModel::sRoleNames = {
+    {ResultRole::title,         "title"},
+    {ResultRole::artist,        "artist"},
+    {ResultRole::album,         "album"},
+    {ResultRole::pretty_length, "pretty_length"},
+    {ResultRole::provider,      "provider"},
+    {ResultRole::providerIcon,  "providerIcon"},
+    {ResultRole::url,           "url"}
+};
+
+GlobalSearchModel::GlobalSearchModel(QObject *parent):
+    QAbstractListModel(parent),
+    _results(), _rows(), _providers(), _providerIcons(),
+    _query(), _queryId(-1), _queryIds(), _staleIds(), _searching(false), _searchTime(),
+    _firstResultsMs(-1), _nbBatches(0), _nbDuplicates(0), _nbStale(0)
+{}
+
+int GlobalSearchModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return _results.size();
+}
+
+QVariant GlobalSearchModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= _results.size())
+        return QVariant();
+
+    const Result &result = _results.at(index.row());
+    switch (role) {
+    case ResultRole::title:
+        return result.song.title;
+    case ResultRole::artist:
+        return result.song.artist;
+    case ResultRole::album:
+        return result.song.album;
+    case ResultRole::pretty_length:
+        return result.song.pretty_length;
+    case ResultRole::provider:
+        return _providers.at(result.provider);
+    case ResultRole::providerIcon:
+        return _providerIcons.value(_providers.at(result.provider));
+    case ResultRole::url:
+        return result.song.url;
+    }
+    return QVariant();
+}
+
+void GlobalSearchModel::start(const QString &query)
+{
+    clear();
+    _query     = query;
+    _searching = true;
+    _searchTime.start();
+}
+
+void GlobalSearchModel::clear()
+{
+    if (!_results.isEmpty())
+    {
+        beginRemoveRows(QModelIndex(), 0, _results.size() - 1);
+        _results.clear();
+        endRemoveRows();
+    }
+    _rows.clear();
+    if (_staleIds.size() + _queryIds.size() > sMaxStaleIds)
+        _staleIds.clear();
+    _staleIds.unite(_queryIds);
+    _queryIds.clear();
+    _query.clear();
+    _queryId        = -1;
+    _searching      = false;
+    _firstResultsMs = -1;
+    _nbBatches      = 0;
+    _nbDuplicates   = 0;
+    _nbStale        = 0;
+}
+
+bool GlobalSearchModel::isStale(qint32 id, const QString &query) const
+{
+    if (_staleIds.contains(id))
+        return true; // same query typed again: its old id must not come back
+    if (_queryId != -1)
+        return id != _queryId;
+    // results before GlobalSearchStarted: only the query can tell
+    return !_searching || query != _query;
+}
+
+bool GlobalSearchModel::setStatus(qint32 id, const QString &query, bool finished)
+{
+    if (isStale(id, query))
+    {
+        qDebug() << "[GlobalSearchModel::setStatus] stale search #" << id << " (" << query << ")";
+        return false;
+    }
+
+    if (_queryId == -1)
+    {   // the other ids accepted before GlobalSearchStarted were from an older identical query
+        _queryIds.remove(id);
+        _staleIds.unite(_queryIds);
+        _queryIds = {id};
+    }
+    _queryId = id;
+    if (finished)
+    {
+        _searching = false;
+        qDebug() << "[GlobalSearchModel::setStatus] " << stats();
+    }
+    return true;
+}
+
+int GlobalSearchModel::merge(const pb::remote::ResponseGlobalSearch &results)
+{
+    M_TRACE_SCOPE("GlobalSearchModel::merge");
+    if (isStale(results.id(), Utf8::toQString(results.query())))
+    {
+        ++_nbStale;
+        return -1;
+    }
+    _queryIds.insert(results.id());
+    ++_nbBatches;
+
+    QString providerName = Utf8::toQString(results.search_provider());
+    int providerIdx = _providers.indexOf(providerName);
+    if (providerIdx == -1)
+    {
+        providerIdx = _providers.size();
+        _providers << providerName;
+    }
+    if (!_providerIcons.contains(providerName) && !results.search_provider_icon().empty())
+    {   // the same icon comes with each batch: encoded only once
+        const std::string &png = results.search_provider_icon();
+        _providerIcons.insert(providerName, QString("data:image/png;base64,%1").arg(
+                                  QString::fromLatin1(QByteArray(png.data(), static_cast<int>(png.size())).toBase64())));
+    }
+
+    // decode and dedup first, then a single insertion for the View
+    QVector<Result> newResults;
+    newResults.reserve(results.song_metadata_size());
+    for (const pb::remote::SongMetadata &metadata : results.song_metadata())
+    {
+        if (_results.size() + newResults.size() == sMaxResults)
+            break;
+        Result result{RemoteSong(metadata, RemoteSong::sPlaylistFieldsMask), providerIdx};
+        QString key = dedupKey(result.song);
+        if (_rows.contains(key))
+        {
+            ++_nbDuplicates;
+            continue;
+        }
+        _rows.insert(key, _results.size() + newResults.size());
+        newResults << std::move(result);
+    }
+
+    if (newResults.isEmpty())
+        return 0;
+
+    if (_firstResultsMs == -1)
+        _firstResultsMs = _searchTime.elapsed();
+    beginInsertRows(QModelIndex(), _results.size(), _results.size() + newResults.size() - 1);
+    _results << newResults;
+    endInsertRows();
+    return newResults.size();
+}
+
+const RemoteSong *GlobalSearchModel::song(int row) const
+{
+    return row >= 0 && row < _results.size() ? &_results.at(row).song : nullptr;
+}
+
+QString GlobalSearchModel::stats() const
+{
+    return QString("'%1': %2 results in %3 batches, first ones after %4 ms, %5 duplicates, %6 stale batches dropped").arg(
+                _query).arg(_results.size()).arg(_nbBatches).arg(_firstResultsMs).arg(_nbDuplicates).arg(_nbStale);
+}
+
+qint64 GlobalSearchModel::memoryUsage() const
+{
+    qint64 bytes = _results.capacity() * static_cast<qint64>(sizeof(Result));
+    for (const Result &result : _results)
+        bytes += result.song.memoryUsage() - static_cast<qint64>(sizeof(RemoteSong));
+    bytes += _rows.size() * static_cast<qint64>(sizeof(QString) + sizeof(int) + 64); // + the key itself
+    for (const QString &icon : _providerIcons)
+        bytes += icon.size() * static_cast<qint64>(sizeof(QChar));
+    return bytes;
+}
+
+QString GlobalSearchModel::dedupKey(const RemoteSong &song)
+{
+    if (!song.url.isEmpty())
+        return song.url;
+    return QString("%1\n%2").arg(song.artist.toLower(), song.title.toLower());
+}
@@ -0,0 +1,113 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef GLOBALSEARCHMODEL_H
+#define GLOBALSEARCHMODEL_H
+#include "player/RemoteSong.h"
+#include <QAbstractListModel>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+
+/*!
+ * \brief results of the GLOBAL_SEARCH of the server
+ * Clementine streams them by provider (one ResponseGlobalSearch each) as they come:
+ * every batch is merged straight away (rows appended, duplicate urls skipped)
+ * so the first results are displayed without waiting for GlobalSearchFinished.
+ * A new query makes all the previous ids stale: their results are dropped
+ * and none of them can be adopted by a later GlobalSearchStarted (even for the same query).
+ */
+class GlobalSearchModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    static const QHash<int, QByteArray> sRoleNames;
+
+    typedef struct Result {
+        RemoteSong song;
+        int        provider; //!< index in _providers
+    } Result;
+
+public:
+    static const int sMaxResults = 1000; //!< a generic word would return half the internet
+    static const int sMaxStaleIds = 1024; //!< forgotten beyond (the server won't send those anymore)
+
+    explicit GlobalSearchModel(QObject *parent = nullptr);
+
+    enum ResultRole {
+        title = Qt::UserRole,
+        artist,
+        album,
+        pretty_length,
+        provider,
+        providerIcon,
+        url
+    };
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    inline virtual QHash<int, QByteArray> roleNames() const override;
+
+    void start(const QString &query); //!< the ids of the previous queries become stale
+    void clear(); //!< the ids seen so far become stale
+    inline void forgetStaleIds(); //!< new session: the server may start its ids again
+
+    //! GLOBAL_SEARCH_STATUS: Started gives the id of our query. returns false if stale
+    bool setStatus(qint32 id, const QString &query, bool finished);
+    //! GLOBAL_SEARCH_RESULT: number of rows appended, -1 if stale
+    int merge(const pb::remote::ResponseGlobalSearch &results);
+
+    inline const QString &query() const;
+    inline bool isSearching() const;
+    inline int nbResults() const;
+    const RemoteSong *song(int row) const; //!< nullptr if out of range
+
+    QString stats() const;
+    qint64 memoryUsage() const;
+
+private:
+    bool isStale(qint32 id, const QString &query) const;
+    static QString dedupKey(const RemoteSong &song); //!< the url or artist + title when there is none
+
+private:
+    QVector<Result>     _results;
+    QHash<QString, int> _rows;      //!< dedupKey => row
+    QStringList         _providers; //!< kept between the queries
+    QHash<QString, QString> _providerIcons; //!< provider => data url of its png (sent with each batch)
+
+    QString       _query;
+    qint32        _queryId;   //!< -1 until GlobalSearchStarted is received
+    QSet<qint32>  _queryIds;  //!< ids accepted for the current query (only _queryId once it is known)
+    QSet<qint32>  _staleIds;  //!< ids of the previous queries
+    bool          _searching;
+    QElapsedTimer _searchTime;
+    qint64        _firstResultsMs; //!< -1 until a batch is merged
+    int           _nbBatches;
+    int           _nbDuplicates;
+    int           _nbStale;   //!< batches of the previous queries dropped
+};
+
+QHash<int, QByteArray> GlobalSearchModel::roleNames() const { return sRoleNames; }
+const QString &GlobalSearchModel::query() const { return _query; }
+bool GlobalSearchModel::isSearching() const { return _searching; }
+void GlobalSearchModel::forgetStaleIds() { _staleIds.clear(); }
+int GlobalSearchModel::nbResults() const { return _results.size(); }
+
+#endif // GLOBALSEARCHMODEL_H
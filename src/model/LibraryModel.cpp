@@ -25,10 +25,164 @@ const QHash<int, QByteArray> LibraryModel::sRoleNames = {
     {ItemRole::url,          "url"}
 };
 
-LibraryModel::LibraryModel(QObject *parent): QStandardItemModel(parent)
+LibraryModel::LibraryModel(QObject *parent): QAbstractItemModel(parent),
+    _table(), _hierarchy(LibraryTable::Hierarchy::artistAlbum), _grouping(nullptr)
+{}
+
+QModelIndex LibraryModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!_grouping || row < 0 || column != 0 || row >= rowCount(parent))
+        return QModelIndex();
+
+    if (!parent.isValid())
+        return createIndex(row, column, quintptr(row + 1)); // top level groups are the first ones
+
+    const LibraryTable::Group &parentGroup = group(parent);
+    if (parentGroup.level == _grouping->levels.size() - 1)
+        return createIndex(row, column, sTrackFlag | quintptr(parentGroup.first + row));
+    return createIndex(row, column, quintptr(parentGroup.first + row + 1));
+}
+
+QModelIndex LibraryModel::parent(const QModelIndex &child) const
+{
+    if (!_grouping || !child.isValid())
+        return QModelIndex();
+
+    int parentIdx;
+    if (isTrack(child))
+        parentIdx = _table.leafGroupOf(*_grouping, static_cast<int>(child.internalId() & ~sTrackFlag));
+    else
+        parentIdx = group(child).parent;
+    if (parentIdx < 0)
+        return QModelIndex();
+
+    const LibraryTable::Group &parentGroup = _grouping->groups.at(parentIdx);
+    int row = parentGroup.parent < 0 ? parentIdx : parentIdx - _grouping->groups.at(parentGroup.parent).first;
+    return createIndex(row, 0, quintptr(parentIdx + 1));
+}
+
+int LibraryModel::rowCount(const QModelIndex &parent) const
+{
+    if (!_grouping)
+        return 0;
+    if (!parent.isValid())
+        return _grouping->nbTopGroups;
+    if (isTrack(parent))
+        return 0;
+    return group(parent).count;
+}
+
+int LibraryModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return 1;
+}
+
+QVariant LibraryModel::data(const QModelIndex &index, int role) const
+{
+    if (!_grouping || !index.isValid())
+        return QVariant();
+
+    if (isTrack(index))
+    {
+        int row = _grouping->rows.at(static_cast<int>(index.internalId() & ~sTrackFlag));
+        switch (role) {
+        case ItemRole::name:
+        {
+            int track = _table.track(row);
+            if (track == -1)
+                return _table.title(row);
+            return QString("%1 - %2").arg(track, 2, 10, QChar('0')).arg(_table.title(row));
+        }
+        case ItemRole::type:
+            return _table.url(row).endsWith("m3u", Qt::CaseInsensitive) ? Playlist : Track;
+        case ItemRole::url:
+            return _table.url(row);
+        }
+        return QVariant();
+    }
+
+    const LibraryTable::Group &itemGroup = group(index);
+    switch (role) {
+    case ItemRole::name:
+        return groupName(itemGroup);
+    case ItemRole::type:
+        return itemType(_grouping->levels.at(itemGroup.level));
+    }
+    return QVariant();
+}
+
+void LibraryModel::setTable(LibraryTable &&table)
+{
+    beginResetModel();
+    _table    = std::move(table);
+    _grouping = _table.size() ? &_table.grouping(_hierarchy) : nullptr;
+    endResetModel();
+}
+
+void LibraryModel::clear()
+{
+    beginResetModel();
+    _grouping = nullptr;
+    _table.clear();
+    endResetModel();
+}
+
+void LibraryModel::setHierarchy(LibraryTable::Hierarchy hierarchy)
+{
+    if (hierarchy == _hierarchy)
+        return;
+
+    beginResetModel();
+    _hierarchy = hierarchy;
+    _grouping  = _table.size() ? &_table.grouping(_hierarchy) : nullptr;
+    endResetModel();
+}
+
+qint64 LibraryModel::memoryUsage(int &nbItems) const
 {
-    connect(this, &LibraryModel::beginReset, this, [=](){beginResetModel();});
-    connect(this, &LibraryModel::endReset,   this, [=](){endResetModel();});
+    nbItems = _grouping ? _table.size() + _grouping->groups.size() : 0;
+    return _table.memoryUsage();
+}
+
+QString LibraryModel::groupName(const LibraryTable::Group &group) const
+{
+    LibraryTable::Field field = _grouping->levels.at(group.level);
+    switch (field) {
+    case LibraryTable::Field::year:
+        return group.value > 0 ? QString::number(group.value) : tr("unset year");
+    case LibraryTable::Field::artist:
+    case LibraryTable::Field::albumArtist:
+    {
+        const QString &artist = _table.value(field, group.value);
+        return artist.isEmpty() ? tr("unset artist") : artist;
+    }
+    case LibraryTable::Field::album:
+    {
+        const QString &album = _table.value(field, group.value);
+        return album.isEmpty() ? tr("unset album") : album;
+    }
+    case LibraryTable::Field::genre:
+    {
+        const QString &genre = _table.value(field, group.value);
+        return genre.isEmpty() ? tr("unset genre") : genre;
+    }
+    }
+    return QString();
+}
+
+LibraryModel::ItemType LibraryModel::itemType(LibraryTable::Field field)
+{
+    switch (field) {
+    case LibraryTable::Field::album:
+        return Album;
+    case LibraryTable::Field::genre:
+        return Genre;
+    case LibraryTable::Field::year:
+        return Year;
+    default:
+        return Artist;
+    }
 }
 
 
@@ -49,7 +203,7 @@ QVariantList LibraryProxyModel::getExpandableIndexes(const QModelIndex &currentI
         return QVariantList();
 
     QVariantList expandableIndexes = {currentIndex};
-    if (data(currentIndex, LibraryModel::type).toInt() == LibraryModel::Artist)
+    if (!isTrack(index(0, 0, currentIndex)))
     { // Albums have only Tracks under them which are not expendable ;)
         int childCount = rowCount(currentIndex);
         for (int i = 0; i < childCount ; ++i)
@@ -19,14 +19,21 @@
 
 #ifndef LIBRARYMODEL_H
 #define LIBRARYMODEL_H
-#include <QStandardItemModel>
+#include "LibraryTable.h"
+#include <QAbstractItemModel>
 #include <QSortFilterProxyModel>
 
-class LibraryModel : public QStandardItemModel
+/*!
+ * \brief tree view of the LibraryTable for one of its Hierarchy
+ * The items are not stored: an index points either to a Group of the current Grouping
+ * or to a position in its rows (tracks), cf internalId
+ */
+class LibraryModel : public QAbstractItemModel
 {
     Q_OBJECT
 
     static const QHash<int, QByteArray> sRoleNames;
+    static constexpr quintptr sTrackFlag = quintptr(1) << 31; //!< internalId of the tracks (position in the rows)
 
 public:
     explicit LibraryModel(QObject *parent = nullptr);
@@ -34,7 +41,9 @@ public:
     enum ItemType {
         Artist = 0,
         Album,
-        Track,
+        Genre,
+        Year,
+        Track,   //!< Track and Playlist must stay the last ones (cf isTrack)
         Playlist
     };
 
@@ -46,12 +55,43 @@ public:
 
     inline virtual QHash<int, QByteArray> roleNames() const override;
 
-signals:
-    void beginReset();
-    void endReset();
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void setTable(LibraryTable &&table); //!< the library has been (re)loaded
+    void clear();
+
+    inline LibraryTable::Hierarchy hierarchy() const;
+    void setHierarchy(LibraryTable::Hierarchy hierarchy); //!< the Grouping is built on its first use
+
+    inline const LibraryTable &table() const;
+
+    //! table and groupings
+    qint64 memoryUsage(int &nbItems) const;
+
+private:
+    inline bool isTrack(const QModelIndex &index) const;
+    inline const LibraryTable::Group &group(const QModelIndex &index) const;
+    QString groupName(const LibraryTable::Group &group) const;
+    static ItemType itemType(LibraryTable::Field field);
+
+    LibraryTable                  _table;
+    LibraryTable::Hierarchy       _hierarchy;
+    const LibraryTable::Grouping *_grouping; //!< of _hierarchy, nullptr when the table is empty
 };
 
 QHash<int, QByteArray> LibraryModel::roleNames() const { return sRoleNames; }
+LibraryTable::Hierarchy LibraryModel::hierarchy() const { return _hierarchy; }
+const LibraryTable &LibraryModel::table() const { return _table; }
+
+bool LibraryModel::isTrack(const QModelIndex &index) const { return index.internalId() & sTrackFlag; }
+const LibraryTable::Group &LibraryModel::group(const QModelIndex &index) const
+{
+    return _grouping->groups.at(static_cast<int>(index.internalId()) - 1);
+}
 
 
 class LibraryProxyModel : public QSortFilterProxyModel {
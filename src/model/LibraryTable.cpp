@@ -0,0 +1,296 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "LibraryTable.h"
+#include "utils/TraceRecorder.h"
+#include <QCollator>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+LibraryTable::LibraryTable():
+    _artists(), _albums(), _genres(),
+    _artist(), _albumArtist(), _album(), _genre(), _year(), _track(), _titles(), _urls(),
+    _groupings()
+{
+    for (Grouping &grouping : _groupings)
+    {
+        grouping.nbTopGroups    = 0;
+        grouping.firstLeafGroup = 0;
+        grouping.built          = false;
+    }
+}
+
+QVector<LibraryTable::Field> LibraryTable::levels(Hierarchy hierarchy)
+{
+    switch (hierarchy) {
+    case Hierarchy::albumArtistAlbum:
+        return {Field::albumArtist, Field::album};
+    case Hierarchy::genreArtistAlbum:
+        return {Field::genre, Field::artist, Field::album};
+    case Hierarchy::yearAlbum:
+        return {Field::year, Field::album};
+    default:
+        return {Field::artist, Field::album};
+    }
+}
+
+void LibraryTable::clear()
+{
+    *this = LibraryTable();
+}
+
+void LibraryTable::reserve(int nbTracks)
+{
+    _artist.reserve(nbTracks);
+    _albumArtist.reserve(nbTracks);
+    _album.reserve(nbTracks);
+    _genre.reserve(nbTracks);
+    _year.reserve(nbTracks);
+    _track.reserve(nbTracks);
+    _titles.reserve(nbTracks);
+    _urls.reserve(nbTracks);
+}
+
+void LibraryTable::append(const QString &artist, const QString &albumArtist, const QString &album,
+                          const QString &genre, int year, int track, const QString &title, const QString &url)
+{
+    int artistId = encode(_artists, artist);
+    _artist      << artistId;
+    _albumArtist << (albumArtist.isEmpty() ? artistId : encode(_artists, albumArtist));
+    _album       << encode(_albums, album);
+    _genre       << encode(_genres, genre);
+    _year        << qMax(0, year); // unset is -1 in Clementine
+    _track       << static_cast<short>(track);
+    _titles      << title;
+    _urls        << url;
+}
+
+void LibraryTable::squeeze()
+{
+    _artist.squeeze();
+    _albumArtist.squeeze();
+    _album.squeeze();
+    _genre.squeeze();
+    _year.squeeze();
+    _track.squeeze();
+    _artists.ids.squeeze();
+    _albums.ids.squeeze();
+    _genres.ids.squeeze();
+}
+
+const QString &LibraryTable::value(Field field, int valueId) const
+{
+    static const QString sNoValue;
+    switch (field) {
+    case Field::artist:
+    case Field::albumArtist:
+        return _artists.values.at(valueId);
+    case Field::album:
+        return _albums.values.at(valueId);
+    case Field::genre:
+        return _genres.values.at(valueId);
+    default:
+        return sNoValue;
+    }
+}
+
+const LibraryTable::Grouping &LibraryTable::grouping(Hierarchy hierarchy)
+{
+    Grouping &grouping = _groupings[static_cast<int>(hierarchy)];
+    if (!grouping.built)
+        build(grouping, hierarchy);
+    return grouping;
+}
+
+qint64 LibraryTable::memoryUsage() const
+{
+    qint64 bytes = memoryUsage(_artists) + memoryUsage(_albums) + memoryUsage(_genres);
+    bytes += (_artist.capacity() + _albumArtist.capacity() + _album.capacity()
+              + _genre.capacity() + _year.capacity()) * static_cast<qint64>(sizeof(int))
+            + _track.capacity() * static_cast<qint64>(sizeof(short));
+    for (const QStringList *strings : {&_titles, &_urls})
+    {
+        bytes += strings->size() * static_cast<qint64>(sizeof(QString) + 24); // + the QArrayData header
+        for (const QString &str : *strings)
+            bytes += str.capacity() * static_cast<qint64>(sizeof(QChar));
+    }
+    for (const Grouping &grouping : _groupings)
+        bytes += grouping.rows.capacity() * static_cast<qint64>(sizeof(int))
+                + grouping.groups.capacity() * static_cast<qint64>(sizeof(Group));
+    return bytes;
+}
+
+
+int LibraryTable::encode(Dictionary &dictionary, const QString &value)
+{
+    auto it = dictionary.ids.constFind(value);
+    if (it != dictionary.ids.cend())
+        return it.value();
+
+    int id = dictionary.values.size();
+    dictionary.values << value;
+    dictionary.ids.insert(value, id);
+    return id;
+}
+
+void LibraryTable::rank(Dictionary &dictionary)
+{
+    QCollator collator;
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    collator.setNumericMode(true);
+
+    int nbValues = dictionary.values.size();
+    std::vector<QCollatorSortKey> keys;
+    keys.reserve(static_cast<size_t>(nbValues));
+    for (const QString &value : dictionary.values)
+        keys.push_back(collator.sortKey(value));
+
+    QVector<int> ids(nbValues);
+    std::iota(ids.begin(), ids.end(), 0);
+    std::sort(ids.begin(), ids.end(), [&keys](int a, int b){
+        return keys[static_cast<size_t>(a)].compare(keys[static_cast<size_t>(b)]) < 0;
+    });
+
+    dictionary.ranks.resize(nbValues);
+    for (int i = 0 ; i < nbValues ; ++i)
+        dictionary.ranks[ids.at(i)] = i;
+}
+
+qint64 LibraryTable::memoryUsage(const Dictionary &dictionary)
+{
+    qint64 bytes = dictionary.values.size() * static_cast<qint64>(sizeof(QString) + 24 + 2 * sizeof(int) + 16)
+            + dictionary.ranks.capacity() * static_cast<qint64>(sizeof(int)); // + the QHash nodes
+    for (const QString &value : dictionary.values)
+        bytes += value.capacity() * static_cast<qint64>(sizeof(QChar));
+    return bytes;
+}
+
+void LibraryTable::build(Grouping &grouping, Hierarchy hierarchy)
+{
+    M_TRACE_SCOPE("LibraryTable::build");
+    QElapsedTimer buildTime;
+    buildTime.start();
+
+    grouping.levels = levels(hierarchy);
+    int nbLevels = grouping.levels.size(), nbTracks = size();
+    const QVector<int> *columns[sMaxLevels] = {nullptr}, *ranks[sMaxLevels] = {nullptr};
+    for (int level = 0 ; level < nbLevels ; ++level)
+    {
+        Field field = grouping.levels.at(level);
+        columns[level] = &column(field);
+        if (field == Field::year)
+            continue; // the year is its own rank
+        Dictionary &dict = dictionary(field);
+        if (dict.ranks.size() != dict.values.size())
+            rank(dict);
+        ranks[level] = &dict.ranks;
+    }
+
+    // sort the tracks on the ranks of their levels (then the track number and the DB order)
+    typedef struct Entry
+    {
+        int keys[sMaxLevels];
+        int track;
+        int row;
+    } Entry;
+    std::vector<Entry> entries(static_cast<size_t>(nbTracks));
+    for (int row = 0 ; row < nbTracks ; ++row)
+    {
+        Entry &entry = entries[static_cast<size_t>(row)];
+        for (int level = 0 ; level < sMaxLevels ; ++level)
+        {
+            if (level >= nbLevels)
+                entry.keys[level] = 0;
+            else
+            {
+                int id = columns[level]->at(row);
+                entry.keys[level] = ranks[level] ? ranks[level]->at(id) : id;
+            }
+        }
+        entry.track = _track.at(row);
+        entry.row   = row;
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b){
+        for (int level = 0 ; level < sMaxLevels ; ++level)
+        {
+            if (a.keys[level] != b.keys[level])
+                return a.keys[level] < b.keys[level];
+        }
+        if (a.track != b.track)
+            return a.track < b.track;
+        return a.row < b.row;
+    });
+
+    // one pass: a group starts where the keys of its level (or of a parent one) change
+    QVector<Group> levelGroups[sMaxLevels];
+    grouping.rows.resize(nbTracks);
+    for (int i = 0 ; i < nbTracks ; ++i)
+    {
+        const Entry &entry = entries[static_cast<size_t>(i)];
+        grouping.rows[i] = entry.row;
+
+        int changedLevel = 0;
+        if (i > 0)
+        {
+            const Entry &previous = entries[static_cast<size_t>(i - 1)];
+            while (changedLevel < nbLevels && previous.keys[changedLevel] == entry.keys[changedLevel])
+                ++changedLevel;
+        }
+        for (int level = changedLevel ; level < nbLevels ; ++level)
+        {
+            int parent = -1;
+            if (level > 0)
+            {
+                parent = levelGroups[level - 1].size() - 1;
+                ++levelGroups[level - 1].last().count;
+            }
+            int first = level == nbLevels - 1 ? i : levelGroups[level + 1].size();
+            levelGroups[level] << Group{parent, columns[level]->at(entry.row), first, 0, static_cast<ushort>(level)};
+        }
+        ++levelGroups[nbLevels - 1].last().count;
+    }
+
+    // concatenate the levels (local indexes to global ones)
+    int offsets[sMaxLevels + 1] = {0};
+    for (int level = 0 ; level < nbLevels ; ++level)
+        offsets[level + 1] = offsets[level] + levelGroups[level].size();
+    grouping.groups.clear();
+    grouping.groups.reserve(offsets[nbLevels]);
+    for (int level = 0 ; level < nbLevels ; ++level)
+    {
+        for (Group group : qAsConst(levelGroups[level]))
+        {
+            if (level > 0)
+                group.parent += offsets[level - 1];
+            if (level < nbLevels - 1)
+                group.first += offsets[level + 1];
+            grouping.groups << group;
+        }
+    }
+    grouping.nbTopGroups    = levelGroups[0].size();
+    grouping.firstLeafGroup = offsets[nbLevels - 1];
+    grouping.built          = true;
+
+    qDebug() << "[LibraryTable::build] hierarchy " << static_cast<ushort>(hierarchy) << ": "
+             << nbTracks << " tracks in " << grouping.groups.size() << " groups, "
+             << buildTime.elapsed() << " ms";
+}
@@ -0,0 +1,189 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef LIBRARYTABLE_H
+#define LIBRARYTABLE_H
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+/*!
+ * \brief columnar copy of the Clementine library (one row per track)
+ * The grouping columns are dictionary encoded (an int per track, each distinct string stored once)
+ * and the tree views (LibraryModel) are derived from it through Grouping indexes:
+ * the permutation of the tracks in display order and the groups (artist, album...) as ranges of it.
+ * A Grouping is built on its first use then kept: switching view doesn't touch the tracks.
+ * (it's only used from the GUI Thread, no need to lock it)
+ */
+class LibraryTable
+{
+public:
+    enum class Hierarchy : ushort {artistAlbum = 0, albumArtistAlbum, genreArtistAlbum, yearAlbum, nbHierarchies};
+    enum class Field : ushort {artist = 0, albumArtist, album, genre, year};
+
+    static const int sMaxLevels = 3;
+
+    typedef struct Group
+    {
+        int    parent; //!< index of the parent group, -1 for the top level ones
+        int    value;  //!< dictionary id of the level Field (the year itself for Field::year)
+        int    first;  //!< first child: group index or, for the last level, position in Grouping::rows
+        int    count;  //!< number of children
+        ushort level;
+    } Group;
+
+    typedef struct Grouping
+    {
+        QVector<Field> levels;         //!< from the top one, the tracks are under the last one
+        QVector<int>   rows;           //!< track rows in display order
+        QVector<Group> groups;         //!< level by level, the children of a group are contiguous
+        int            nbTopGroups;    //!< groups [0, nbTopGroups[ are the top level ones
+        int            firstLeafGroup; //!< groups holding the tracks start there
+        bool           built;
+    } Grouping;
+
+    LibraryTable();
+    ~LibraryTable() = default;
+
+    LibraryTable(const LibraryTable &) = delete;
+    LibraryTable &operator=(const LibraryTable &) = delete;
+    LibraryTable(LibraryTable &&) = default;
+    LibraryTable &operator=(LibraryTable &&) = default;
+
+    static QVector<Field> levels(Hierarchy hierarchy);
+
+    void clear();
+    void reserve(int nbTracks);
+    //! an empty albumArtist falls back on the artist (like Clementine does)
+    void append(const QString &artist, const QString &albumArtist, const QString &album,
+                const QString &genre, int year, int track, const QString &title, const QString &url);
+    void squeeze(); //!< once loaded
+
+    inline int size() const;
+    inline int nbValues(Field field) const; //!< distinct values (not for Field::year)
+
+    inline int  track(int row) const; //!< -1 if unset
+    inline const QString &title(int row) const;
+    inline const QString &url(int row) const;
+    inline int valueOf(Field field, int row) const;
+    const QString &value(Field field, int valueId) const; //!< empty for Field::year
+
+    //! built on its first use (sort of the tracks on the dictionary ranks)
+    const Grouping &grouping(Hierarchy hierarchy);
+    inline int leafGroupOf(const Grouping &grouping, int position) const; //!< group holding rows[position]
+
+    qint64 memoryUsage() const;
+
+private:
+    typedef struct Dictionary
+    {
+        QStringList         values;
+        QHash<QString, int> ids;
+        QVector<int>        ranks;  //!< id -> position in the collation order (computed with the first Grouping)
+    } Dictionary;
+
+    static int encode(Dictionary &dictionary, const QString &value);
+    static void rank(Dictionary &dictionary);
+    static qint64 memoryUsage(const Dictionary &dictionary);
+
+    inline const QVector<int> &column(Field field) const;
+    inline Dictionary &dictionary(Field field);
+    void build(Grouping &grouping, Hierarchy hierarchy);
+
+    Dictionary     _artists; //!< shared by the artist and albumArtist columns
+    Dictionary     _albums;
+    Dictionary     _genres;
+
+    QVector<int>   _artist;
+    QVector<int>   _albumArtist;
+    QVector<int>   _album;
+    QVector<int>   _genre;
+    QVector<int>   _year;
+    QVector<short> _track;
+    QStringList    _titles;
+    QStringList    _urls;
+
+    Grouping       _groupings[static_cast<int>(Hierarchy::nbHierarchies)];
+};
+
+int LibraryTable::size() const { return _urls.size(); }
+int LibraryTable::nbValues(Field field) const
+{
+    switch (field) {
+    case Field::artist:
+    case Field::albumArtist:
+        return _artists.values.size();
+    case Field::album:
+        return _albums.values.size();
+    case Field::genre:
+        return _genres.values.size();
+    default:
+        return 0;
+    }
+}
+
+int LibraryTable::track(int row) const { return _track.at(row); }
+const QString &LibraryTable::title(int row) const { return _titles.at(row); }
+const QString &LibraryTable::url(int row) const { return _urls.at(row); }
+int LibraryTable::valueOf(Field field, int row) const { return column(field).at(row); }
+
+int LibraryTable::leafGroupOf(const Grouping &grouping, int position) const
+{
+    // the leaf groups are in the order of the rows: the last one starting before position
+    int first = grouping.firstLeafGroup, last = grouping.groups.size();
+    while (last - first > 1)
+    {
+        int middle = (first + last) / 2;
+        if (grouping.groups.at(middle).first <= position)
+            first = middle;
+        else
+            last = middle;
+    }
+    return first;
+}
+
+const QVector<int> &LibraryTable::column(Field field) const
+{
+    switch (field) {
+    case Field::artist:
+        return _artist;
+    case Field::albumArtist:
+        return _albumArtist;
+    case Field::album:
+        return _album;
+    case Field::genre:
+        return _genre;
+    default:
+        return _year;
+    }
+}
+
+LibraryTable::Dictionary &LibraryTable::dictionary(Field field)
+{
+    switch (field) {
+    case Field::album:
+        return _albums;
+    case Field::genre:
+        return _genres;
+    default:
+        return _artists;
+    }
+}
+
+#endif // LIBRARYTABLE_H
@@ -43,12 +43,24 @@ PlaylistModel::PlaylistModel(ClementineRemote *remote, bool useClosedPl, QObject
     _remote(remote),
     _useClosedPlaylists(useClosedPl)
 {
-    connect(this, &PlaylistModel::preAddPlaylist, this, [=](int index) {
-        beginInsertRows(QModelIndex(), index, index);
+    connect(this, &PlaylistModel::preAddPlaylists, this, [=](int firstIdx, int lastIdx) {
+        beginInsertRows(QModelIndex(), firstIdx, lastIdx);
     }, Qt::DirectConnection);
-    connect(this, &PlaylistModel::postAddPlaylist, this, [=]() {
+    connect(this, &PlaylistModel::postAddPlaylists, this, [=]() {
         endInsertRows();
     }, Qt::DirectConnection);
+    connect(this, &PlaylistModel::preRemovePlaylists, this, [=](int firstIdx, int lastIdx) {
+        beginRemoveRows(QModelIndex(), firstIdx, lastIdx);
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistModel::postRemovePlaylists, this, [=]() {
+        endRemoveRows();
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistModel::preMovePlaylist, this, [=](int fromIdx, int toIdx) {
+        beginMoveRows(QModelIndex(), fromIdx, fromIdx, QModelIndex(), toIdx);
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistModel::postMovePlaylist, this, [=]() {
+        endMoveRows();
+    }, Qt::DirectConnection);
     connect(this, &PlaylistModel::preClearPlaylists, this, [=](int lastIdx) {
         beginRemoveRows(QModelIndex(), 0, lastIdx);
     }, Qt::DirectConnection);
@@ -73,7 +85,7 @@ QVariant PlaylistModel::data(const QModelIndex &index, int role) const
     if (!index.isValid() || !_remote)
         return QVariant();
 
-    RemotePlaylist *p = _remote->playlist(index.row(), _useClosedPlaylists);
+    const RemotePlaylist *p = _remote->playlist(index.row(), _useClosedPlaylists);
     switch (role) {
     case PlaylistModel::name:
         return p->name;
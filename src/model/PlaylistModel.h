@@ -62,8 +62,12 @@ public:
 
 signals:
     // signals for PlaylistModel
-    void preAddPlaylist(int index);
-    void postAddPlaylist(int index);
+    void preAddPlaylists(int firstIdx, int lastIdx);
+    void postAddPlaylists();
+    void preRemovePlaylists(int firstIdx, int lastIdx);
+    void postRemovePlaylists();
+    void preMovePlaylist(int fromIdx, int toIdx); //!< toIdx < fromIdx
+    void postMovePlaylist();
     void preClearPlaylists(int lastIdx);
     void postClearPlaylists();
 
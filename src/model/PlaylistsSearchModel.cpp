@@ -0,0 +1,106 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "PlaylistsSearchModel.h"
+#include "ClementineRemote.h"
+
+const QHash<int, QByteArray> PlaylistsSearchModel::sRoleNames = {
+    {HitRole::playlistName, "playlistName"},
+    {HitRole::title,        "title"},
+    {HitRole::artist,       "artist"},
+    {HitRole::album,        "album"},
+    {HitRole::score,        "score"}
+};
+
+PlaylistsSearchModel::PlaylistsSearchModel(QObject *parent):
+    QAbstractListModel(parent),
+    _remote(nullptr), _hits(), _nbShown(0)
+{}
+
+int PlaylistsSearchModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return _nbShown;
+}
+
+QVariant PlaylistsSearchModel::data(const QModelIndex &index, int role) const
+{
+    const PlaylistsSearchIndex::Hit *searchHit = hit(index.row());
+    if (!index.isValid() || !searchHit || !_remote)
+        return QVariant();
+
+    if (role == HitRole::playlistName)
+        return _remote->openedPlaylistName(searchHit->playlistID);
+    else if (role == HitRole::score)
+        return searchHit->score;
+
+    const PlaylistsSearchIndex::IndexedSong *song =
+            _remote->playlistsSearchIndex().song(searchHit->playlistID, searchHit->row);
+    if (!song)
+        return QVariant(); // reindexed since the query
+    switch (role) {
+    case HitRole::title:
+        return song->title;
+    case HitRole::artist:
+        return song->artist;
+    case HitRole::album:
+        return song->album;
+    }
+    return QVariant();
+}
+
+bool PlaylistsSearchModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && _nbShown < _hits.size();
+}
+
+void PlaylistsSearchModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid())
+        return;
+    int nbToShow = qMin(sPageSize, _hits.size() - _nbShown);
+    if (nbToShow <= 0)
+        return;
+    beginInsertRows(QModelIndex(), _nbShown, _nbShown + nbToShow - 1);
+    _nbShown += nbToShow;
+    endInsertRows();
+}
+
+void PlaylistsSearchModel::setRemote(ClementineRemote *remote)
+{
+    beginResetModel();
+    _remote  = remote;
+    _hits.clear();
+    _nbShown = 0;
+    endResetModel();
+}
+
+void PlaylistsSearchModel::setHits(const QVector<PlaylistsSearchIndex::Hit> &hits)
+{
+    beginResetModel();
+    _hits    = hits;
+    _nbShown = qMin(sPageSize, _hits.size());
+    endResetModel();
+}
+
+const PlaylistsSearchIndex::Hit *PlaylistsSearchModel::hit(int row) const
+{
+    return row >= 0 && row < _hits.size() ? &_hits.at(row) : nullptr;
+}
@@ -0,0 +1,71 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef PLAYLISTSSEARCHMODEL_H
+#define PLAYLISTSSEARCHMODEL_H
+#include "player/PlaylistsSearchIndex.h"
+#include <QAbstractListModel>
+class ClementineRemote;
+
+/*!
+ * \brief ranked hits of a PlaylistsSearchIndex query
+ * The View gets them by pages (canFetchMore / fetchMore) as it scrolls:
+ * the first ones are displayed without creating the delegates of a thousand hits.
+ */
+class PlaylistsSearchModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    static const QHash<int, QByteArray> sRoleNames;
+
+public:
+    static const int sPageSize = 50;
+
+    explicit PlaylistsSearchModel(QObject *parent = nullptr);
+
+    enum HitRole {
+        playlistName = Qt::UserRole,
+        title,
+        artist,
+        album,
+        score
+    };
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    inline virtual QHash<int, QByteArray> roleNames() const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    void setRemote(ClementineRemote *remote);
+    void setHits(const QVector<PlaylistsSearchIndex::Hit> &hits); //!< only the first page is shown
+    inline int nbHits() const;
+    const PlaylistsSearchIndex::Hit *hit(int row) const; //!< nullptr if out of range
+
+private:
+    ClementineRemote                  *_remote;
+    QVector<PlaylistsSearchIndex::Hit> _hits;
+    int                                _nbShown; //!< rows exposed to the View
+};
+
+QHash<int, QByteArray> PlaylistsSearchModel::roleNames() const { return sRoleNames; }
+int PlaylistsSearchModel::nbHits() const { return _hits.size(); }
+
+#endif // PLAYLISTSSEARCHMODEL_H
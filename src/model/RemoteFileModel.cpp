@@ -109,7 +109,7 @@ bool RemoteFileModel::setData(const QModelIndex &index, const QVariant &value, i
     }
 
     if (update) {
-        emit dataChanged(index, index, {role});
+        _remote->updateScheduler()->dataChanged(this, index.row(), index.row(), {role});
         return true;
     }
     return false;
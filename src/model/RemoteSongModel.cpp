@@ -20,6 +20,7 @@
 #include "RemoteSongModel.h"
 #include "ClementineRemote.h"
 #include "player/RemoteSong.h"
+#include <algorithm>
 
 const QHash<int, QByteArray> RemoteSongModel::sRoleNames = {
     {SongRole::title,         "title"},
@@ -55,6 +56,7 @@ QVariant RemoteSongModel::data(const QModelIndex &index, int role) const
     if (!index.isValid() || !_remote)
         return QVariant();
 
+    // playlist fetched by pages: the View requests its visible rows (ClementineRemote::fetchVisibleSongs)
     const RemoteSong &song = _remote->playlistSong(index.row());
     switch (role) {
     case SongRole::title:
@@ -84,16 +86,16 @@ QVariant RemoteSongModel::data(const QModelIndex &index, int role) const
 
 bool RemoteSongModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    if (!_remote)
+    if (!_remote || !_remote->isPlaylistSongLoaded(index.row()))
         return false;
 
-    RemoteSong &song = _remote->playlistSong(index.row());
+    const RemoteSong &song = _remote->playlistSong(index.row());
     switch (role) {
     case SongRole::selected:
         if (song.selected != value.toBool())
         {
-            song.selected = value.toBool();
-            emit dataChanged(index, index, QVector<int>() << role);
+            _remote->setSongSelected(index.row(), value.toBool());
+            _remote->updateScheduler()->dataChanged(this, index.row(), index.row(), {role}); // selectAll: one range per frame
             return true;
         }
         break;
@@ -113,6 +115,11 @@ Qt::ItemFlags RemoteSongModel::flags(const QModelIndex &index) const
 }
 
 
+bool RemoteSongModel::isSongLoaded(int row) const
+{
+    return _remote ? _remote->isPlaylistSongLoaded(row) : false;
+}
+
 ClementineRemote *RemoteSongModel::remote() const
 {
     return _remote;
@@ -140,23 +147,60 @@ void RemoteSongModel::setRemote(ClementineRemote *remote)
         connect(_remote, &ClementineRemote::postSongRemoved, this, [=]() {
             endRemoveRows();
         });
+        connect(_remote, &ClementineRemote::preInsertSongs, this, [=](int firstSongIdx, int lastSongIdx) {
+            beginInsertRows(QModelIndex(), firstSongIdx, lastSongIdx);
+        });
+        connect(_remote, &ClementineRemote::preRemoveSongs, this, [=](int firstSongIdx, int lastSongIdx) {
+            beginRemoveRows(QModelIndex(), firstSongIdx, lastSongIdx);
+        });
+        connect(_remote, &ClementineRemote::preMoveSongs, this,
+                [=](int firstSongIdx, int lastSongIdx, int destinationIdx) {
+            beginMoveRows(QModelIndex(), firstSongIdx, lastSongIdx, QModelIndex(), destinationIdx);
+        });
+        connect(_remote, &ClementineRemote::postSongsMoved, this, [=]() {
+            endMoveRows();
+        });
+        connect(_remote, &ClementineRemote::songsUpdated, this, [=](int firstSongIdx, int lastSongIdx) {
+            emit dataChanged(index(firstSongIdx), index(lastSongIdx));
+        });
     }
     endResetModel();
 }
 
 
-RemoteSongProxyModel::RemoteSongProxyModel(QObject *parent): QSortFilterProxyModel(parent)
+RemoteSongProxyModel::RemoteSongProxyModel(QObject *parent):
+    QSortFilterProxyModel(parent), _hiddenRows()
 {}
 
+void RemoteSongProxyModel::hideSongs(const QList<int> &songIndexes)
+{
+    for (int songIndex : songIndexes)
+        _hiddenRows.insert(songIndex); // the index of a song is its row in the playlist
+    invalidateFilter();
+}
+
+void RemoteSongProxyModel::showHiddenSongs()
+{
+    if (_hiddenRows.isEmpty())
+        return;
+    _hiddenRows.clear();
+    invalidateFilter();
+}
+
 
 bool RemoteSongProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
 {
+    if (_hiddenRows.contains(sourceRow))
+        return false;
+
     QRegularExpression regexp = filterRegularExpression();
 
     if (!regexp.isValid() || regexp.pattern().isEmpty())
         return true;
 
     RemoteSongModel *model = static_cast<RemoteSongModel *>(sourceModel());
+    if (!model->isSongLoaded(sourceRow))
+        return false; // we won't fetch all the pages to filter them...
     QModelIndex srcRowIndex = model->index(sourceRow, 0, sourceParent);
 
     QString title = model->data(srcRowIndex, RemoteSongModel::SongRole::title).toString();
@@ -178,18 +222,29 @@ bool RemoteSongProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &so
 }
 
 
+bool RemoteSongProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+    ClementineRemote *remote = static_cast<RemoteSongModel *>(sourceModel())->remote();
+    if (!remote)
+        return left.row() < right.row();
+    // the ranks are computed once per sort (SongsSorter), no QVariant nor string comparison here
+    return remote->songRank(left.row()) < remote->songRank(right.row());
+}
+
+void RemoteSongProxyModel::applySort(bool sorted)
+{
+    if (!sorted)
+        sort(-1); // back to the source order
+    else if (sortColumn() == 0)
+        invalidate(); // already sorted: the ranks have changed
+    else
+        sort(0);
+}
+
+
 bool RemoteSongProxyModel::allSongsSelected() const
 {
-    bool allSelected = true;
-    for (int i = 0; i < rowCount() ; ++i)
-    {
-        if (!data(index(i, 0), RemoteSongModel::selected).toBool())
-        {
-            allSelected = false;
-            break;
-        }
-    }
-    return allSelected;
+    return selectedSourceRows().size() == rowCount();
 }
 
 void RemoteSongProxyModel::selectAllSongs(bool selectAll)
@@ -198,35 +253,55 @@ void RemoteSongProxyModel::selectAllSongs(bool selectAll)
         setData(index(i, 0), selectAll, RemoteSongModel::selected);
 }
 
-QList<int> RemoteSongProxyModel::selectedSongsIdexes()
+QList<int> RemoteSongProxyModel::selectedSourceRows() const
 {
-    QList<int> selectedIndexes;
-    for (int i = 0; i < rowCount() ; ++i)
+    QList<int> rows;
+    RemoteSongModel *model = static_cast<RemoteSongModel *>(sourceModel());
+    ClementineRemote *remote = model->remote();
+    if (remote && remote->hasSongsIndex())
+    {
+        bool identity = isIdentity();
+        for (int row : remote->selectedSongRows())
+        {
+            if (identity || mapFromSource(model->index(row, 0)).isValid())
+                rows << row;
+        }
+        if (sortColumn() >= 0)
+            std::sort(rows.begin(), rows.end(), [remote](int l, int r) {
+                return remote->songRank(l) < remote->songRank(r);
+            });
+    }
+    else
     {
-        if (data(index(i, 0), RemoteSongModel::selected).toBool())
-            selectedIndexes << data(index(i, 0), RemoteSongModel::songIndex).toInt();
+        for (int i = 0; i < rowCount() ; ++i)
+        {
+            if (data(index(i, 0), RemoteSongModel::selected).toBool())
+                rows << mapToSource(index(i, 0)).row();
+        }
     }
+    return rows;
+}
+
+QList<int> RemoteSongProxyModel::selectedSongsIdexes()
+{
+    QList<int> selectedIndexes;
+    for (int row : selectedSourceRows())
+        selectedIndexes << sourceModel()->data(sourceModel()->index(row, 0), RemoteSongModel::songIndex).toInt();
     return selectedIndexes;
 }
 
 QList<int> RemoteSongProxyModel::selectedSongsIDs()
 {
     QList<int> selectedIDs;
-    for (int i = 0; i < rowCount() ; ++i)
-    {
-        if (data(index(i, 0), RemoteSongModel::selected).toBool())
-            selectedIDs << data(index(i, 0), RemoteSongModel::songId).toInt();
-    }
+    for (int row : selectedSourceRows())
+        selectedIDs << sourceModel()->data(sourceModel()->index(row, 0), RemoteSongModel::songId).toInt();
     return selectedIDs;
 }
 
 QStringList RemoteSongProxyModel::selectedSongsURLs()
 {
     QStringList selectedURLs;
-    for (int i = 0; i < rowCount() ; ++i)
-    {
-        if (data(index(i, 0), RemoteSongModel::selected).toBool())
-            selectedURLs << data(index(i, 0), RemoteSongModel::url).toString();
-    }
+    for (int row : selectedSourceRows())
+        selectedURLs << sourceModel()->data(sourceModel()->index(row, 0), RemoteSongModel::url).toString();
     return selectedURLs;
 }
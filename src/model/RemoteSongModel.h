@@ -21,6 +21,7 @@
 #define REMOTESONGMODEL_H
 #include <QSortFilterProxyModel>
 #include <QAbstractListModel>
+#include <QSet>
 
 class ClementineRemote;
 #ifndef OPAQUE_ClementineRemote
@@ -68,6 +69,8 @@ public:
     inline virtual QHash<int, QByteArray> roleNames() const override;
 
 
+    bool isSongLoaded(int row) const;
+
     ClementineRemote *remote() const;
     void setRemote(ClementineRemote *remote);
 
@@ -91,11 +94,30 @@ public:
     QList<int>  selectedSongsIDs();
     QStringList selectedSongsURLs();
 
+    //! songs removed optimistically (while waiting for the server)
+    void hideSongs(const QList<int> &songIndexes);
+    void showHiddenSongs();
+    inline bool hasHiddenSongs() const;
+    inline bool isIdentity() const; //!< no song hidden, filtered nor sorted: same rows than the source
+
+    //! sort on the ranks of ClementineRemote::songRank (or go back to the playlist order)
+    void applySort(bool sorted);
 
 protected:
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+
+private:
+    QList<int> selectedSourceRows() const; //!< visible ones only (in the displayed order)
 
+    QSet<int> _hiddenRows;
 };
 
+bool RemoteSongProxyModel::hasHiddenSongs() const { return !_hiddenRows.isEmpty(); }
+bool RemoteSongProxyModel::isIdentity() const
+{
+    return _hiddenRows.isEmpty() && filterRegularExpression().pattern().isEmpty() && sortColumn() < 0;
+}
+
 
 #endif // REMOTESONGMODEL_H
@@ -0,0 +1,262 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "UpdateScheduler.h"
+#include "utils/TraceRecorder.h"
+#include <QDebug>
+
+UpdateScheduler::UpdateScheduler(QObject *parent) :
+    QObject(parent),
+    _timer(), _secureUpdates(), _models(), _watchedModels(), _notifications(), _scheduled(0x0),
+    _nbRequested(0), _nbEmitted(0)
+{
+    _timer.setSingleShot(true);
+    _timer.setInterval(sFramePeriodMs);
+    connect(&_timer, &QTimer::timeout, this, &UpdateScheduler::flush);
+}
+
+void UpdateScheduler::dataChanged(QAbstractItemModel *model, int firstRow, int lastRow, const QVector<int> &roles)
+{
+    if (!model || lastRow < firstRow)
+        return;
+
+    _nbRequested.ref();
+    {
+        QMutexLocker lock(&_secureUpdates);
+        PendingModel *pending = pendingModel(model);
+        if (!pending)
+        {
+            watch(model);
+            _models << PendingModel{model, {}};
+            pending = &_models.last();
+        }
+        mergeRange(pending->ranges, {firstRow, lastRow, roles});
+    }
+    schedule();
+}
+
+void UpdateScheduler::notify(Notification notification, const std::function<void()> &emitter)
+{
+    _nbRequested.ref();
+    {
+        QMutexLocker lock(&_secureUpdates);
+        _notifications.insert(notification, emitter);
+    }
+    schedule();
+}
+
+void UpdateScheduler::flush()
+{
+    if (!_scheduled.testAndSetRelaxed(0x1, 0x0))
+        return;
+    M_TRACE_SCOPE("UpdateScheduler::flush");
+    _timer.stop();
+
+    QList<PendingModel> models;
+    QHash<Notification, std::function<void()>> notifications;
+    {
+        QMutexLocker lock(&_secureUpdates);
+        models.swap(_models);
+        notifications.swap(_notifications);
+    }
+
+    int nbEmitted = 0;
+    for (const PendingModel &pending : models)
+    {
+        if (!pending.model)
+            continue; // deleted since the request
+        int lastRow = pending.model->rowCount() - 1; // the model may have shrunk since
+        for (const Range &range : pending.ranges)
+        {
+            if (range.first > lastRow)
+                break;
+            emit pending.model->dataChanged(pending.model->index(range.first, 0),
+                                            pending.model->index(qMin(range.last, lastRow), 0),
+                                            range.roles);
+            ++nbEmitted;
+        }
+    }
+    for (const auto &emitter : notifications)
+    {
+        emitter();
+        ++nbEmitted;
+    }
+    _nbEmitted.fetchAndAddRelaxed(nbEmitted);
+}
+
+QString UpdateScheduler::stats() const
+{
+    int nbRequests = nbRequested();
+    return QString("requested: %1, emitted: %2, merged: %3 (%4%)").arg(
+                nbRequests).arg(nbEmitted()).arg(nbMerged()).arg(nbRequests ? 100 * nbMerged() / nbRequests : 0);
+}
+
+void UpdateScheduler::schedule()
+{
+    if (_scheduled.testAndSetRelaxed(0x0, 0x1))
+        QMetaObject::invokeMethod(&_timer, static_cast<void (QTimer::*)()>(&QTimer::start)); // queued from another thread
+}
+
+void UpdateScheduler::watch(QAbstractItemModel *model)
+{
+    if (_watchedModels.contains(model))
+        return;
+    _watchedModels.insert(model);
+
+    connect(model, &QObject::destroyed, this, [this, model](){
+        QMutexLocker lock(&_secureUpdates);
+        _watchedModels.remove(model);
+    });
+    connect(model, &QAbstractItemModel::rowsAboutToBeInserted, this,
+            [this, model](const QModelIndex &parent, int first, int last){
+        onRowsAboutToBeInserted(model, parent, first, last);
+    });
+    connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this,
+            [this, model](const QModelIndex &parent, int first, int last){
+        onRowsAboutToBeRemoved(model, parent, first, last);
+    });
+    connect(model, &QAbstractItemModel::rowsAboutToBeMoved, this,
+            [this, model](const QModelIndex &sourceParent, int sourceFirst, int sourceLast,
+                          const QModelIndex &destinationParent, int destinationRow){
+        onRowsAboutToBeMoved(model, sourceParent, sourceFirst, sourceLast, destinationParent, destinationRow);
+    });
+    connect(model, &QAbstractItemModel::modelAboutToBeReset, this, [this, model](){ dropPending(model); });
+}
+
+UpdateScheduler::PendingModel *UpdateScheduler::pendingModel(QAbstractItemModel *model)
+{
+    for (PendingModel &m : _models)
+    {
+        if (m.model == model)
+            return &m;
+    }
+    return nullptr;
+}
+
+void UpdateScheduler::onRowsAboutToBeInserted(QAbstractItemModel *model, const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid())
+        return; // our ranges are top level rows
+    QMutexLocker lock(&_secureUpdates);
+    PendingModel *pending = pendingModel(model);
+    if (!pending)
+        return;
+    int nbRows = last - first + 1;
+    for (Range &range : pending->ranges)
+    {
+        if (range.first >= first)
+            range.first += nbRows;
+        if (range.last >= first)
+            range.last += nbRows; // a range around the insertion also covers the new rows
+    }
+}
+
+void UpdateScheduler::onRowsAboutToBeRemoved(QAbstractItemModel *model, const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+    QMutexLocker lock(&_secureUpdates);
+    PendingModel *pending = pendingModel(model);
+    if (!pending)
+        return;
+    int nbRows = last - first + 1;
+    QList<Range> ranges;
+    for (const Range &range : pending->ranges)
+    {
+        // keep what is outside [first, last], shifted
+        int newFirst = range.first < first ? range.first : (range.first > last ? range.first - nbRows : first);
+        int newLast  = range.last < first ? range.last : (range.last > last ? range.last - nbRows : first - 1);
+        if (newFirst <= newLast)
+            mergeRange(ranges, {newFirst, newLast, range.roles}); // may become adjacent
+    }
+    pending->ranges.swap(ranges);
+}
+
+void UpdateScheduler::onRowsAboutToBeMoved(QAbstractItemModel *model,
+                                           const QModelIndex &sourceParent, int sourceFirst, int sourceLast,
+                                           const QModelIndex &destinationParent, int destinationRow)
+{
+    if (sourceParent.isValid() && destinationParent.isValid())
+        return;
+    if (sourceParent.isValid() || destinationParent.isValid())
+    {
+        dropPending(model); // rows moving in or out of the top level
+        return;
+    }
+
+    // the rows between the source and the destination are the only ones that get a new position:
+    // a pending range touching them is widened to the whole span (still correct after the move)
+    int spanFirst = qMin(sourceFirst, destinationRow), spanLast = qMax(sourceLast, destinationRow - 1);
+    QMutexLocker lock(&_secureUpdates);
+    PendingModel *pending = pendingModel(model);
+    if (!pending)
+        return;
+    QList<Range> ranges;
+    for (const Range &range : pending->ranges)
+    {
+        if (range.last >= spanFirst && range.first <= spanLast)
+            mergeRange(ranges, {qMin(range.first, spanFirst), qMax(range.last, spanLast), range.roles});
+        else
+            mergeRange(ranges, range);
+    }
+    pending->ranges.swap(ranges);
+}
+
+void UpdateScheduler::dropPending(QAbstractItemModel *model)
+{
+    QMutexLocker lock(&_secureUpdates);
+    for (int i = 0 ; i < _models.size() ; ++i)
+    {
+        if (_models.at(i).model == model)
+        {
+            _models.removeAt(i); // the rows of the ranges are not the same anymore
+            return;
+        }
+    }
+}
+
+void UpdateScheduler::mergeRange(QList<Range> &ranges, Range range)
+{
+    int i = 0;
+    while (i < ranges.size() && ranges.at(i).last + 1 < range.first)
+        ++i; // ranges before (not adjacent)
+
+    while (i < ranges.size() && ranges.at(i).first <= range.last + 1)
+    {
+        const Range &r = ranges.at(i); // overlapping or adjacent
+        range.first = qMin(range.first, r.first);
+        range.last  = qMax(range.last, r.last);
+        range.roles = mergeRoles(range.roles, r.roles);
+        ranges.removeAt(i);
+    }
+    ranges.insert(i, range);
+}
+
+QVector<int> UpdateScheduler::mergeRoles(const QVector<int> &a, const QVector<int> &b)
+{
+    if (a.isEmpty() || b.isEmpty())
+        return QVector<int>(); // all roles
+    QVector<int> roles(a);
+    for (int role : b)
+    {
+        if (!roles.contains(role))
+            roles << role;
+    }
+    return roles;
+}
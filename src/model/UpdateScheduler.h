@@ -0,0 +1,110 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef UPDATESCHEDULER_H
+#define UPDATESCHEDULER_H
+#include "utils/Macro.h"
+#include <QObject>
+#include <QTimer>
+#include <QMutex>
+#include <QPointer>
+#include <QAbstractItemModel>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <functional>
+
+/*!
+ * \brief collects the dataChanged of the models and the property notifications
+ * to emit them once per frame (afterAnimating of the QQuickWindow or a 16 ms timer)
+ * - the adjacent or overlapping row ranges of a model are merged
+ * - a notification only keeps its latest value
+ * - the pending ranges follow the rows inserted, removed or moved before the flush (dropped on a reset)
+ * Requests can be made from any thread, they're emitted in the thread of the scheduler (GUI)
+ */
+class UpdateScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Notification : ushort {trackPosition = 0};
+
+    static const int sFramePeriodMs = 16;
+
+    explicit UpdateScheduler(QObject *parent = nullptr);
+    ~UpdateScheduler() = default;
+
+    //! empty roles means all of them
+    void dataChanged(QAbstractItemModel *model, int firstRow, int lastRow, const QVector<int> &roles = QVector<int>());
+    void notify(Notification notification, const std::function<void()> &emitter);
+
+    inline int nbRequested() const; //!< dataChanged and notifications asked
+    inline int nbEmitted() const;   //!< after the merges
+    inline int nbMerged() const;
+    QString stats() const;
+
+public slots:
+    void flush(); //!< to be connected to the frame signal of the window (GUI thread)
+
+private:
+    typedef struct Range
+    {
+        int first;
+        int last;
+        QVector<int> roles;
+    } Range;
+
+    typedef struct PendingModel
+    {
+        QPointer<QAbstractItemModel> model;
+        QList<Range> ranges; //!< sorted, neither overlapping nor adjacent
+    } PendingModel;
+
+    void schedule();
+    void watch(QAbstractItemModel *model); //!< with _secureUpdates locked
+    PendingModel *pendingModel(QAbstractItemModel *model); //!< with _secureUpdates locked
+
+    // structural changes of a watched model (GUI thread): remap its pending ranges
+    void onRowsAboutToBeInserted(QAbstractItemModel *model, const QModelIndex &parent, int first, int last);
+    void onRowsAboutToBeRemoved(QAbstractItemModel *model, const QModelIndex &parent, int first, int last);
+    void onRowsAboutToBeMoved(QAbstractItemModel *model, const QModelIndex &sourceParent, int sourceFirst, int sourceLast,
+                              const QModelIndex &destinationParent, int destinationRow);
+    void dropPending(QAbstractItemModel *model);
+
+    static void mergeRange(QList<Range> &ranges, Range range);
+    static QVector<int> mergeRoles(const QVector<int> &a, const QVector<int> &b);
+
+    QTimer _timer;
+    QMutex _secureUpdates; //!< protects _models and _notifications
+    QList<PendingModel> _models;
+    QSet<QAbstractItemModel*> _watchedModels; //!< connected to their structural signals
+    QHash<Notification, std::function<void()>> _notifications;
+    AtomicBool _scheduled;
+
+    QAtomicInt _nbRequested;
+    QAtomicInt _nbEmitted;
+};
+
+int UpdateScheduler::nbRequested() const { return M_LoadAtomic(_nbRequested); }
+int UpdateScheduler::nbEmitted() const { return M_LoadAtomic(_nbEmitted); }
+int UpdateScheduler::nbMerged() const { return nbRequested() - nbEmitted(); }
+
+inline uint qHash(UpdateScheduler::Notification key, uint seed = 0) { return ::qHash(static_cast<ushort>(key), seed); }
+
+#endif // UPDATESCHEDULER_H
@@ -0,0 +1,117 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "PagedPlaylistSongs.h"
+#include <QCoreApplication>
+
+PagedPlaylistSongs::PagedPlaylistSongs():
+    _playlistID(-1), _totalCount(0), _lastRequestedRow(0),
+    _pages(sMaxPages), _pending(), _clock(),
+    _loadingSong()
+{
+    _clock.start();
+    _loadingSong.id       = -1;
+    _loadingSong.index    = -1;
+    _loadingSong.title    = QCoreApplication::translate("PagedPlaylistSongs", "loading...");
+    _loadingSong.track    = -1;
+    _loadingSong.disc     = -1;
+    _loadingSong.length   = 0;
+    _loadingSong.is_local = false;
+    _loadingSong.file_size = 0;
+    _loadingSong.playcount = 0;
+    _loadingSong.rating   = 0;
+    _loadingSong.type     = pb::remote::SongMetadata_Type_UNKNOWN;
+    _loadingSong.selected = false;
+    _loadingSong.fields_mask = RemoteSong::sPlaylistFieldsMask;
+}
+
+void PagedPlaylistSongs::reset(qint32 playlistID, int totalCount)
+{
+    _playlistID       = playlistID;
+    _totalCount       = totalCount;
+    _lastRequestedRow = 0;
+    _pages.clear();
+    _pending.clear();
+}
+
+void PagedPlaylistSongs::clear() { reset(-1, 0); }
+
+RemoteSong *PagedPlaylistSongs::loadedSong(int row) const
+{
+    QVector<RemoteSong> *page = _pages.object(row / sPageSize); // moves it at the head of the LRU
+    if (page)
+    {
+        int pageRow = row % sPageSize;
+        if (pageRow < page->size())
+            return &(*page)[pageRow];
+    }
+    return nullptr;
+}
+
+QList<int> PagedPlaylistSongs::pagesToFetch(int row)
+{
+    QList<int> pages;
+    if (row < 0 || row >= _totalCount)
+        return pages;
+
+    int direction = row >= _lastRequestedRow ? 1 : -1;
+    _lastRequestedRow = row;
+
+    int page = row / sPageSize, lastPage = (_totalCount - 1) / sPageSize;
+    for (int p : {page, page + direction})
+    {
+        if (p < 0 || p > lastPage || _pages.contains(p))
+            continue;
+        auto it = _pending.constFind(p);
+        if (it != _pending.cend() && _clock.elapsed() - it.value() < sPendingTimeoutMs)
+            continue;
+        _pending.insert(p, _clock.elapsed());
+        pages << p;
+    }
+    return pages;
+}
+
+QList<int> PagedPlaylistSongs::takePending()
+{
+    QList<int> pages = _pending.keys();
+    _pending.clear();
+    return pages;
+}
+
+int PagedPlaylistSongs::storePage(int offset, QVector<RemoteSong> &&songs)
+{
+    if (offset < 0 || offset >= _totalCount || offset % sPageSize != 0)
+        return -1;
+
+    int page = offset / sPageSize;
+    _pending.remove(page);
+    _pages.insert(page, new QVector<RemoteSong>(std::move(songs)));
+    return offset;
+}
+
+qint64 PagedPlaylistSongs::memoryUsage() const
+{
+    qint64 size = 0;
+    for (int page : _pages.keys())
+    {
+        for (const RemoteSong &s : *_pages[page])
+            size += s.memoryUsage();
+    }
+    return size;
+}
@@ -0,0 +1,110 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef PAGEDPLAYLISTSONGS_H
+#define PAGEDPLAYLISTSONGS_H
+#include "RemoteSong.h"
+
+#include <QCache>
+#include <QVector>
+#include <QHash>
+#include <QElapsedTimer>
+
+/*!
+ * \brief Songs of a (huge) playlist fetched by pages of sPageSize rows
+ * using the windowed REQUEST_PLAYLIST_SONGS (offset, limit)
+ * The total number of songs is known upfront so the View can be sized immediately
+ * and only the pages around its visible range are requested.
+ * The memory is bounded by an LRU of sMaxPages pages.
+ * (only used from the GUI Thread)
+ */
+class PagedPlaylistSongs
+{
+public:
+    static const int sPageSize = 250;
+    static const int sMaxPages = 40;  //!< 10k songs in memory max
+    static const int sPendingTimeoutMs = 10000; //!< a page not received by then is requested again
+
+    PagedPlaylistSongs();
+    ~PagedPlaylistSongs() = default;
+
+    PagedPlaylistSongs(const PagedPlaylistSongs &) = delete;
+    PagedPlaylistSongs &operator=(const PagedPlaylistSongs &) = delete;
+
+    void reset(qint32 playlistID, int totalCount);
+    void clear();
+
+    inline bool   isActive() const;
+    inline qint32 playlistID() const;
+    inline int    totalCount() const;
+
+    inline bool isLoaded(int row) const;
+
+    //! returns a placeholder if the row is not loaded (touches the LRU)
+    inline const RemoteSong &song(int row) const;
+    inline RemoteSong &song(int row);
+
+    //! pages to request for the row (not loaded nor pending) + prefetch in the scroll direction
+    //! returned pages are marked as pending
+    QList<int> pagesToFetch(int row);
+    //! pages requested but not received (lost with the connection): no more pending
+    QList<int> takePending();
+
+    //! returns the first row of the page (-1 if the page doesn't belong to the current window)
+    int storePage(int offset, QVector<RemoteSong> &&songs);
+
+    inline static int pageOffset(int page);
+
+    qint64 memoryUsage() const;
+
+private:
+    RemoteSong *loadedSong(int row) const;
+
+private:
+    qint32 _playlistID;
+    int    _totalCount;
+    int    _lastRequestedRow; //!< to guess the scroll direction
+
+    QCache<int, QVector<RemoteSong>> _pages; //!< LRU of the pages loaded (cost: 1 per page)
+    QHash<int, qint64>                _pending; //!< pages requested but not yet received => request time
+    QElapsedTimer                     _clock;
+
+    RemoteSong _loadingSong;
+};
+
+bool   PagedPlaylistSongs::isActive() const { return _playlistID != -1; }
+qint32 PagedPlaylistSongs::playlistID() const { return _playlistID; }
+int    PagedPlaylistSongs::totalCount() const { return _totalCount; }
+
+bool PagedPlaylistSongs::isLoaded(int row) const { return _pages.contains(row / sPageSize); }
+
+const RemoteSong &PagedPlaylistSongs::song(int row) const
+{
+    const RemoteSong *s = loadedSong(row);
+    return s ? *s : _loadingSong;
+}
+RemoteSong &PagedPlaylistSongs::song(int row)
+{
+    RemoteSong *s = loadedSong(row);
+    return s ? *s : _loadingSong;
+}
+
+int PagedPlaylistSongs::pageOffset(int page) { return page * sPageSize; }
+
+#endif // PAGEDPLAYLISTSONGS_H
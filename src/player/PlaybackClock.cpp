@@ -0,0 +1,98 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "PlaybackClock.h"
+#include <algorithm>
+
+PlaybackClock::PlaybackClock():
+    _clock(), _playing(false), _frozenPositionMs(0),
+    _targetOriginMs(0), _displayOriginMs(0), _lastDisplayMs(0),
+    _origins(), _jitterMs(0)
+{
+    _clock.start();
+    _origins.reserve(sHistorySize + 1);
+}
+
+void PlaybackClock::reset(qint64 positionMs)
+{
+    qint64 nowMs = now();
+    _frozenPositionMs = positionMs;
+    _targetOriginMs   = nowMs - positionMs;
+    _displayOriginMs  = _targetOriginMs;
+    _lastDisplayMs    = nowMs;
+    _origins.clear();
+    _jitterMs = 0;
+}
+
+void PlaybackClock::addSample(qint32 positionSec)
+{
+    qint64 positionMs = static_cast<qint64>(positionSec) * 1000;
+    if (!_playing)
+    {
+        _frozenPositionMs = positionMs;
+        return;
+    }
+
+    qint64 origin = now() - positionMs;
+    if (!_origins.isEmpty() && qAbs(origin - _targetOriginMs) > sSnapMs)
+        _origins.clear(); // seek or new track: the history is useless
+
+    _origins << origin;
+    if (_origins.size() > sHistorySize)
+        _origins.removeFirst();
+
+    auto minMax = std::minmax_element(_origins.cbegin(), _origins.cend());
+    _targetOriginMs = *minMax.first;
+    _jitterMs       = *minMax.second - *minMax.first;
+}
+
+void PlaybackClock::setPlaying(bool playing)
+{
+    if (playing == _playing)
+        return;
+
+    if (playing)
+    {
+        _playing = true;
+        reset(_frozenPositionMs); // restart from where we paused
+    }
+    else
+    {
+        _frozenPositionMs = positionMs();
+        _playing = false;
+    }
+}
+
+qint64 PlaybackClock::positionMs()
+{
+    if (!_playing)
+        return _frozenPositionMs;
+
+    qint64 nowMs = now(), gap = _targetOriginMs - _displayOriginMs;
+    if (qAbs(gap) > sSnapMs)
+        _displayOriginMs = _targetOriginMs;
+    else if (gap)
+    {
+        qint64 maxStep = qMax<qint64>(1, (nowMs - _lastDisplayMs) * sMaxSlewPercent / 100);
+        _displayOriginMs += qBound(-maxStep, gap, maxStep);
+    }
+    _lastDisplayMs = nowMs;
+
+    return qMax<qint64>(0, nowMs - _displayOriginMs);
+}
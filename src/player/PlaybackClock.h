@@ -0,0 +1,78 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef PLAYBACKCLOCK_H
+#define PLAYBACKCLOCK_H
+#include <QElapsedTimer>
+#include <QVector>
+
+/*!
+ * \brief Local clock of the position in the active track
+ * so the View can be refreshed at the display rate between two UPDATE_TRACK_POSITION.
+ *
+ * The server sends positions truncated to the second. Each sample gives an origin
+ * (local time of the position 0) delayed by the network and the truncation:
+ * like NTP we keep the smallest one of the last samples (the least delayed).
+ * The displayed origin slews toward that estimation (max sMaxSlewPercent of the elapsed time)
+ * so the position never goes back, unless the gap is more than sSnapMs (seek, new track...)
+ * (only used from the GUI Thread)
+ */
+class PlaybackClock
+{
+public:
+    static const int sHistorySize     = 8;
+    static const int sSnapMs          = 1500;
+    static const int sMaxSlewPercent  = 10;
+
+    PlaybackClock();
+    ~PlaybackClock() = default;
+
+    PlaybackClock(const PlaybackClock &) = delete;
+    PlaybackClock &operator=(const PlaybackClock &) = delete;
+
+    void reset(qint64 positionMs = 0); //!< seek or new track
+    void addSample(qint32 positionSec);
+    void setPlaying(bool playing);
+
+    qint64 positionMs(); //!< extrapolated position (moves the displayed origin toward the estimated one)
+
+    inline bool   isPlaying() const;
+    inline qint64 jitterMs() const; //!< spread of the origins of the last samples
+    inline int    nbSamples() const;
+
+private:
+    inline qint64 now() const;
+
+private:
+    QElapsedTimer   _clock;
+    bool            _playing;
+    qint64          _frozenPositionMs; //!< position when not playing
+    qint64          _targetOriginMs;   //!< estimated local time of the position 0
+    qint64          _displayOriginMs;  //!< origin used for the display
+    qint64          _lastDisplayMs;
+    QVector<qint64> _origins;          //!< origins of the last samples (oldest first)
+    qint64          _jitterMs;
+};
+
+bool   PlaybackClock::isPlaying() const { return _playing; }
+qint64 PlaybackClock::jitterMs() const { return _jitterMs; }
+int    PlaybackClock::nbSamples() const { return _origins.size(); }
+qint64 PlaybackClock::now() const { return _clock.elapsed(); }
+
+#endif // PLAYBACKCLOCK_H
@@ -0,0 +1,65 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "PlaylistSongsCache.h"
+#include <QDebug>
+
+PlaylistSongsCache::PlaylistSongsCache(int maxSizeMB):
+    _cache(maxSizeMB * 1024)
+{}
+
+void PlaylistSongsCache::store(qint32 playlistID, const QList<RemoteSong> &songs, qint32 revision)
+{
+    // QList being implicitly shared, we only pay the copy if the displayed songs get modified
+    int costKB = static_cast<int>(memoryUsage(songs) / 1024) + 1;
+    if (!_cache.insert(playlistID, new CachedPlaylistSongs(songs, songs.size(), revision), costKB))
+        qDebug() << "[PlaylistSongsCache::store] playlist #" << playlistID
+                 << " is too big to be cached (" << costKB << " KB)";
+}
+
+const CachedPlaylistSongs *PlaylistSongsCache::find(qint32 playlistID, qint32 item_count, qint32 revision)
+{
+    CachedPlaylistSongs *entry = _cache.object(playlistID); // moves it at the head of the LRU
+    if (!entry)
+        return nullptr;
+
+    if (entry->item_count != item_count
+            || (revision != -1 && entry->revision != -1 && entry->revision != revision))
+    {
+        qDebug() << "[PlaylistSongsCache::find] dropping stale playlist #" << playlistID
+                 << " (item_count: " << entry->item_count << " vs " << item_count
+                 << ", revision: " << entry->revision << " vs " << revision << ")";
+        _cache.remove(playlistID);
+        return nullptr;
+    }
+    return entry;
+}
+
+void PlaylistSongsCache::setMaxSizeMB(int maxSizeMB)
+{
+    _cache.setMaxCost(maxSizeMB * 1024); // evicts the least recently used if needed
+}
+
+qint64 PlaylistSongsCache::memoryUsage(const QList<RemoteSong> &songs)
+{
+    qint64 size = 0;
+    for (const RemoteSong &s : songs)
+        size += s.memoryUsage();
+    return size;
+}
@@ -0,0 +1,88 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef PLAYLISTSONGSCACHE_H
+#define PLAYLISTSONGSCACHE_H
+#include "RemoteSong.h"
+
+#include <QCache>
+#include <QList>
+
+typedef struct CachedPlaylistSongs
+{
+    QList<RemoteSong> songs;
+    qint32 item_count; //!< number of songs when cached (to compare with RemotePlaylist::item_count)
+    qint32 revision;   //!< server revision of the playlist (-1 if the server doesn't provide it)
+
+public:
+    CachedPlaylistSongs(const QList<RemoteSong> &songs_, qint32 item_count_, qint32 revision_):
+        songs(songs_), item_count(item_count_), revision(revision_){}
+
+    CachedPlaylistSongs(const CachedPlaylistSongs &) = default;
+    CachedPlaylistSongs& operator=(const CachedPlaylistSongs &) = default;
+    ~CachedPlaylistSongs() = default;
+} CachedPlaylistSongs;
+
+/*!
+ * \brief LRU of the songs of the playlists recently viewed, keyed by playlist ID
+ * so switching between tabs doesn't need to wait for the whole PLAYLIST_SONGS.
+ * The memory is bounded: the cost of an entry is its estimated size in KB.
+ * (it's only used from the GUI Thread, no need to lock it)
+ */
+class PlaylistSongsCache
+{
+public:
+    static const int sDefaultMaxSizeMB = 32;
+
+    explicit PlaylistSongsCache(int maxSizeMB = sDefaultMaxSizeMB);
+    ~PlaylistSongsCache() = default;
+
+    PlaylistSongsCache(const PlaylistSongsCache &) = delete;
+    PlaylistSongsCache &operator=(const PlaylistSongsCache &) = delete;
+
+    void store(qint32 playlistID, const QList<RemoteSong> &songs, qint32 revision);
+
+    //! returns the cached entry if it is still valid for the given item_count and revision (nullptr otherwise)
+    //! a stale entry is dropped
+    const CachedPlaylistSongs *find(qint32 playlistID, qint32 item_count, qint32 revision);
+
+    inline void remove(qint32 playlistID);
+    inline void clear();
+    inline QList<qint32> playlistIDs() const;
+
+    inline int  size() const;
+    inline int  sizeKB() const;
+    inline int  maxSizeMB() const;
+    void setMaxSizeMB(int maxSizeMB);
+
+    static qint64 memoryUsage(const QList<RemoteSong> &songs);
+
+private:
+    QCache<qint32, CachedPlaylistSongs> _cache; //!< cost in KB
+};
+
+void PlaylistSongsCache::remove(qint32 playlistID) { _cache.remove(playlistID); }
+void PlaylistSongsCache::clear() { _cache.clear(); }
+QList<qint32> PlaylistSongsCache::playlistIDs() const { return _cache.keys(); }
+
+int PlaylistSongsCache::size() const { return _cache.size(); }
+int PlaylistSongsCache::sizeKB() const { return _cache.totalCost(); }
+int PlaylistSongsCache::maxSizeMB() const { return _cache.maxCost() / 1024; }
+
+#endif // PLAYLISTSONGSCACHE_H
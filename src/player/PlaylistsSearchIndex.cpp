@@ -0,0 +1,315 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "PlaylistsSearchIndex.h"
+#include "utils/TraceRecorder.h"
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+
+PlaylistsSearchIndex::PlaylistsSearchIndex():
+    _tokens(), _tokenRefs(), _nextTokenId(0), _playlists(), _stalePlaylistID(-1), _lastQueryUs(0)
+{}
+
+void PlaylistsSearchIndex::index(qint32 playlistID, const QList<RemoteSong> &songs)
+{
+    M_TRACE_SCOPE("PlaylistsSearchIndex::index");
+    QElapsedTimer indexTime;
+    indexTime.start();
+
+    PlaylistPostings playlist;
+    playlist.songs.reserve(songs.size());
+    QHash<QString, QVector<int>> tokensOfText; // artists and albums are repeated on many rows
+    for (int row = 0 ; row < songs.size() ; ++row)
+    {
+        const RemoteSong &song = songs.at(row);
+        playlist.songs << IndexedSong{song.id, song.title, song.artist, song.album};
+
+        const QString *texts[] = {&song.title, &song.artist, &song.album};
+        for (ushort field = Field::title ; field <= Field::album ; ++field)
+        {
+            const QString &text = *texts[field];
+            if (text.isEmpty())
+                continue;
+            auto it = tokensOfText.find(text);
+            if (it == tokensOfText.end())
+            {
+                QVector<int> ids;
+                for (const QString &token : tokenize(text))
+                    ids << tokenId(token);
+                it = tokensOfText.insert(text, ids);
+            }
+            for (int id : it.value())
+                playlist.postings[id] << (static_cast<quint32>(row) << 2 | field);
+        }
+    }
+    for (auto it = playlist.postings.begin() ; it != playlist.postings.end() ; ++it)
+    {
+        it.value().squeeze();
+        ++_tokenRefs[it.key()];
+    }
+
+    if (playlistID == _stalePlaylistID)
+        _stalePlaylistID = -1;
+    auto previous = _playlists.constFind(playlistID);
+    bool unusedTokens = previous != _playlists.cend() && release(previous.value());
+    _playlists.insert(playlistID, playlist);
+    if (unusedTokens)
+        pruneTokens();
+    qDebug() << "[PlaylistsSearchIndex::index] playlist #" << playlistID << ": " << songs.size()
+             << " songs, " << playlist.postings.size() << " words in " << indexTime.elapsed() << " ms";
+}
+
+void PlaylistsSearchIndex::remove(qint32 playlistID)
+{
+    if (playlistID == _stalePlaylistID)
+        _stalePlaylistID = -1;
+    auto it = _playlists.find(playlistID);
+    if (it == _playlists.end())
+        return;
+    bool unusedTokens = release(it.value());
+    _playlists.erase(it);
+    if (unusedTokens)
+        pruneTokens();
+}
+
+void PlaylistsSearchIndex::retain(const QSet<qint32> &playlistIDs)
+{
+    bool unusedTokens = false;
+    for (auto it = _playlists.begin() ; it != _playlists.end() ; )
+    {
+        if (playlistIDs.contains(it.key()))
+            ++it;
+        else
+        {
+            if (it.key() == _stalePlaylistID)
+                _stalePlaylistID = -1;
+            unusedTokens |= release(it.value());
+            it = _playlists.erase(it);
+        }
+    }
+    if (unusedTokens)
+        pruneTokens();
+}
+
+void PlaylistsSearchIndex::clear()
+{
+    _playlists.clear();
+    _tokens.clear();
+    _tokenRefs.clear();
+    _stalePlaylistID = -1;
+}
+
+QVector<PlaylistsSearchIndex::Hit> PlaylistsSearchIndex::search(const QString &query, int maxHits)
+{
+    M_TRACE_SCOPE("PlaylistsSearchIndex::search");
+    static const int sFieldWeights[] = {3, 2, 1}; // title, artist, album
+
+    QElapsedTimer queryTime;
+    queryTime.start();
+    QVector<Hit> hits;
+
+    QStringList terms = tokenize(query);
+    QVector<QVector<QPair<int, bool>>> termsTokens;
+    for (int term = 0 ; term < terms.size() ; ++term)
+    {
+        termsTokens << matchingTokens(terms.at(term), term == terms.size() - 1);
+        if (termsTokens.last().isEmpty())
+        {
+            terms.clear(); // a word that we don't know: no hit
+            break;
+        }
+    }
+
+    for (auto it = _playlists.cbegin() ; !terms.isEmpty() && it != _playlists.cend() ; ++it)
+    {
+        const PlaylistPostings &playlist = it.value();
+        QHash<int, int> scores; // row -> score of the rows having all the terms so far
+        for (int term = 0 ; term < termsTokens.size() ; ++term)
+        {
+            QHash<int, int> termScores;
+            for (const QPair<int, bool> &token : termsTokens.at(term))
+            {
+                auto postings = playlist.postings.constFind(token.first);
+                if (postings == playlist.postings.cend())
+                    continue;
+                int exactBonus = token.second ? 2 : 1;
+                for (quint32 posting : postings.value())
+                {
+                    int row = static_cast<int>(posting >> 2);
+                    if (term > 0 && !scores.contains(row))
+                        continue;
+                    int &score = termScores[row];
+                    score = qMax(score, sFieldWeights[posting & 0x3] * exactBonus);
+                }
+            }
+
+            if (term == 0)
+                scores.swap(termScores);
+            else
+            {
+                for (auto score = scores.begin() ; score != scores.end() ; )
+                {
+                    auto termScore = termScores.constFind(score.key());
+                    if (termScore == termScores.cend())
+                        score = scores.erase(score);
+                    else
+                    {
+                        score.value() += termScore.value();
+                        ++score;
+                    }
+                }
+            }
+            if (scores.isEmpty())
+                break;
+        }
+
+        for (auto score = scores.cbegin() ; score != scores.cend() ; ++score)
+            hits << Hit{it.key(), score.key(), playlist.songs.at(score.key()).id, score.value()};
+    }
+
+    auto better = [](const Hit &a, const Hit &b){
+        if (a.score != b.score)
+            return a.score > b.score;
+        if (a.playlistID != b.playlistID)
+            return a.playlistID < b.playlistID;
+        return a.row < b.row;
+    };
+    if (hits.size() > maxHits)
+    {
+        std::partial_sort(hits.begin(), hits.begin() + maxHits, hits.end(), better);
+        hits.resize(maxHits);
+    }
+    else
+        std::sort(hits.begin(), hits.end(), better);
+
+    _lastQueryUs = queryTime.nsecsElapsed() / 1000;
+    qDebug() << "[PlaylistsSearchIndex::search] " << query << ": " << hits.size() << " hits in "
+             << _lastQueryUs << " us (" << _playlists.size() << " playlists)";
+    return hits;
+}
+
+const PlaylistsSearchIndex::IndexedSong *PlaylistsSearchIndex::song(qint32 playlistID, int row) const
+{
+    auto it = _playlists.constFind(playlistID);
+    if (it == _playlists.cend() || row < 0 || row >= it.value().songs.size())
+        return nullptr;
+    return &it.value().songs.at(row);
+}
+
+int PlaylistsSearchIndex::nbSongs() const
+{
+    int nbSongs = 0;
+    for (const PlaylistPostings &playlist : _playlists)
+        nbSongs += playlist.songs.size();
+    return nbSongs;
+}
+
+qint64 PlaylistsSearchIndex::memoryUsage() const
+{
+    // the strings of the IndexedSong are shared with the RemoteSong (while they're alive)
+    qint64 bytes = 0;
+    for (auto it = _tokens.cbegin() ; it != _tokens.cend() ; ++it)
+        bytes += 48 + it.key().capacity() * static_cast<qint64>(sizeof(QChar)); // QMap node
+    bytes += _tokenRefs.size() * 24; // QHash node
+    for (const PlaylistPostings &playlist : _playlists)
+    {
+        bytes += playlist.songs.capacity() * static_cast<qint64>(sizeof(IndexedSong));
+        for (const QVector<quint32> &rows : playlist.postings)
+            bytes += 32 + 24 + rows.capacity() * static_cast<qint64>(sizeof(quint32)); // QHash node + QArrayData
+    }
+    return bytes;
+}
+
+QStringList PlaylistsSearchIndex::tokenize(const QString &text)
+{
+    // case and accents insensitive: "Beyoncé" is found with "beyonce"
+    QString folded = text.normalized(QString::NormalizationForm_KD).toCaseFolded();
+    QStringList tokens;
+    QString token;
+    for (const QChar &c : folded)
+    {
+        if (c.isLetterOrNumber())
+            token += c;
+        else if (c.category() == QChar::Mark_NonSpacing)
+            continue;
+        else if (!token.isEmpty())
+        {
+            tokens << token;
+            token.clear();
+        }
+    }
+    if (!token.isEmpty())
+        tokens << token;
+    return tokens;
+}
+
+
+int PlaylistsSearchIndex::tokenId(const QString &token)
+{
+    auto it = _tokens.constFind(token);
+    if (it != _tokens.cend())
+        return it.value();
+    int id = _nextTokenId++; // not _tokens.size(): the ids of the pruned tokens are not reused
+    _tokens.insert(token, id);
+    return id;
+}
+
+QVector<QPair<int, bool>> PlaylistsSearchIndex::matchingTokens(const QString &term, bool prefix) const
+{
+    QVector<QPair<int, bool>> tokens;
+    if (!prefix)
+    {
+        auto it = _tokens.constFind(term);
+        if (it != _tokens.cend())
+            tokens << qMakePair(it.value(), true);
+        return tokens;
+    }
+    for (auto it = _tokens.lowerBound(term) ; it != _tokens.cend() && it.key().startsWith(term) ; ++it)
+        tokens << qMakePair(it.value(), it.key().size() == term.size());
+    return tokens;
+}
+
+bool PlaylistsSearchIndex::release(const PlaylistPostings &playlist)
+{
+    bool unusedTokens = false;
+    for (auto it = playlist.postings.cbegin() ; it != playlist.postings.cend() ; ++it)
+    {
+        auto refs = _tokenRefs.find(it.key());
+        if (refs != _tokenRefs.end() && --refs.value() <= 0)
+        {
+            _tokenRefs.erase(refs);
+            unusedTokens = true;
+        }
+    }
+    return unusedTokens;
+}
+
+void PlaylistsSearchIndex::pruneTokens()
+{
+    int nbTokens = _tokens.size();
+    for (auto it = _tokens.begin() ; it != _tokens.end() ; )
+    {
+        if (_tokenRefs.contains(it.value()))
+            ++it;
+        else
+            it = _tokens.erase(it);
+    }
+    qDebug() << "[PlaylistsSearchIndex::pruneTokens] " << nbTokens - _tokens.size() << " words dropped";
+}
@@ -0,0 +1,118 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef PLAYLISTSSEARCHINDEX_H
+#define PLAYLISTSSEARCHINDEX_H
+#include "RemoteSong.h"
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QVector>
+
+/*!
+ * \brief inverted index of the songs of all the playlists received (title, artist and album words)
+ * A playlist is (re)indexed each time its PLAYLIST_SONGS arrive. A PLAYLIST_DELTA applied on the displayed one
+ * only marks it stale: its owner indexes it again before the next search (or when the displayed songs change)
+ * so we can find in which playlist is a song without opening them all, nor re-tokenizing it at each edit.
+ * The words are shared between the playlists (_tokens is sorted for the prefix queries: "instant" search)
+ * and each playlist has its postings: word -> rows (with the field they're from).
+ * A word is dropped once no playlist uses it anymore (refcount of the playlists).
+ * (it's only used from the GUI Thread, no need to lock it)
+ */
+class PlaylistsSearchIndex
+{
+public:
+    enum Field : ushort {title = 0, artist, album};
+
+    static const int sMaxHits = 1000;
+
+    typedef struct Hit
+    {
+        qint32 playlistID;
+        int    row;    //!< when indexed (use songID to find it back after some edits)
+        qint32 songID;
+        int    score;
+    } Hit;
+
+    typedef struct IndexedSong
+    {
+        qint32  id;
+        QString title;
+        QString artist;
+        QString album;
+    } IndexedSong;
+
+    PlaylistsSearchIndex();
+    ~PlaylistsSearchIndex() = default;
+
+    PlaylistsSearchIndex(const PlaylistsSearchIndex &) = delete;
+    PlaylistsSearchIndex &operator=(const PlaylistsSearchIndex &) = delete;
+
+    void index(qint32 playlistID, const QList<RemoteSong> &songs); //!< replaces the previous version
+    void remove(qint32 playlistID);
+    void retain(const QSet<qint32> &playlistIDs); //!< drops the other playlists
+    void clear();
+    inline void markStale(qint32 playlistID); //!< its songs were edited: to index again before searching
+    inline qint32 stalePlaylistID() const;    //!< -1 if none
+
+    //! all the words of the query must be found exactly, except the last one that can be a prefix while typing
+    //! ranked by score: exact word > prefix and title > artist > album
+    QVector<Hit> search(const QString &query, int maxHits = sMaxHits);
+
+    inline bool contains(qint32 playlistID) const;
+    const IndexedSong *song(qint32 playlistID, int row) const; //!< nullptr if not indexed
+
+    inline int nbPlaylists() const;
+    int nbSongs() const;
+    inline int nbTokens() const;
+    inline qint64 lastQueryUs() const;
+    qint64 memoryUsage() const;
+
+    static QStringList tokenize(const QString &text);
+
+private:
+    typedef struct PlaylistPostings
+    {
+        QVector<IndexedSong>          songs;
+        QHash<int, QVector<quint32>>  postings; //!< token id -> (row << 2 | Field)
+    } PlaylistPostings;
+
+    int tokenId(const QString &token);
+    QVector<QPair<int, bool>> matchingTokens(const QString &term, bool prefix) const; //!< (token id, exact)
+    bool release(const PlaylistPostings &playlist); //!< true if some tokens are not used anymore
+    void pruneTokens();
+
+    QMap<QString, int>              _tokens;    //!< sorted for the prefix queries
+    QHash<int, int>                 _tokenRefs; //!< token id -> number of playlists using it
+    int                             _nextTokenId;
+    QHash<qint32, PlaylistPostings> _playlists;
+    qint32                          _stalePlaylistID;
+    qint64                          _lastQueryUs;
+};
+
+void PlaylistsSearchIndex::markStale(qint32 playlistID) { _stalePlaylistID = playlistID; }
+qint32 PlaylistsSearchIndex::stalePlaylistID() const { return _stalePlaylistID; }
+bool PlaylistsSearchIndex::contains(qint32 playlistID) const { return _playlists.contains(playlistID); }
+int PlaylistsSearchIndex::nbPlaylists() const { return _playlists.size(); }
+int PlaylistsSearchIndex::nbTokens() const { return _tokens.size(); }
+qint64 PlaylistsSearchIndex::lastQueryUs() const { return _lastQueryUs; }
+
+#endif // PLAYLISTSSEARCHINDEX_H
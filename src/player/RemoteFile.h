@@ -20,6 +20,7 @@
 #ifndef REMOTEFILE_H
 #define REMOTEFILE_H
 
+#include "utils/Utf8.h"
 #include <QString>
 
 typedef struct RemoteFile
@@ -32,7 +33,7 @@ typedef struct RemoteFile
 
 public:
     RemoteFile(const std::string &name_, bool isDir_):
-        filename(name_.c_str()), isDir(isDir_), selected(false){}
+        filename(Utf8::toQString(name_)), isDir(isDir_), selected(false){}
 
     RemoteFile():
         filename(), isDir(false), selected(false){}
@@ -20,6 +20,7 @@
 #ifndef REMOTEPLAYLIST_H
 #define REMOTEPLAYLIST_H
 #include "protobuf/remotecontrolmessages.pb.h"
+#include "utils/Utf8.h"
 
 #include <QtGlobal>
 #include <QString>
@@ -33,6 +34,7 @@ typedef struct RemotePlaylist
     bool closed;
     bool favorite;
     bool playing;
+    qint32 revision; //!< -1 if not provided by the server
 
 public:
     RemotePlaylist() = default;
@@ -40,9 +42,10 @@ public:
     RemotePlaylist(RemotePlaylist &&) = default;
 
     RemotePlaylist(const pb::remote::Playlist &p, qint32 activePlaylistID):
-        id(p.id()), name(p.name().c_str()), item_count(p.item_count()),
+        id(p.id()), name(Utf8::toQString(p.name())), item_count(p.item_count()),
         active(p.active()), closed(p.closed()), favorite(p.favorite()),
-        playing(p.id() == activePlaylistID)
+        playing(p.id() == activePlaylistID),
+        revision(p.has_revision() ? p.revision() : -1)
     {}
 
     RemotePlaylist& operator=(const RemotePlaylist &) = default;
@@ -51,8 +54,16 @@ public:
     ~RemotePlaylist() = default;
 
     inline QString  str() const;
+    inline bool sameData(const RemotePlaylist &other) const; //!< all the fields displayed
 } RemotePlaylist;
 
+bool RemotePlaylist::sameData(const RemotePlaylist &other) const
+{
+    return id == other.id && name == other.name && item_count == other.item_count
+            && active == other.active && closed == other.closed && favorite == other.favorite
+            && playing == other.playing && revision == other.revision;
+}
+
 QString RemotePlaylist::str() const
 {
     return QString("#%1 %2 (nbSongs: %3, active: %4, closed: %5, fav: %6)").arg(
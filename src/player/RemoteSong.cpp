@@ -21,6 +21,47 @@
 
 bool RemoteSong::sDispArtistInName = true;
 
+const qint64 RemoteSong::sPlaylistFieldsMask =
+        fieldBit(pb::remote::SongMetadata::kIdFieldNumber)
+        | fieldBit(pb::remote::SongMetadata::kIndexFieldNumber)
+        | fieldBit(pb::remote::SongMetadata::kTitleFieldNumber)
+        | fieldBit(pb::remote::SongMetadata::kAlbumFieldNumber)
+        | fieldBit(pb::remote::SongMetadata::kArtistFieldNumber)
+        | fieldBit(pb::remote::SongMetadata::kTrackFieldNumber)
+        | fieldBit(pb::remote::SongMetadata::kPrettyLengthFieldNumber)
+        | fieldBit(pb::remote::SongMetadata::kLengthFieldNumber)
+        | fieldBit(pb::remote::SongMetadata::kRatingFieldNumber) // Sort by Rating
+        | fieldBit(pb::remote::SongMetadata::kUrlFieldNumber);
+
+static inline QString decodeField(qint64 fieldsMask, int fieldNumber, const std::string &str)
+{
+    return (fieldsMask & RemoteSong::fieldBit(fieldNumber)) ? Utf8::toQString(str) : QString();
+}
+
+RemoteSong::RemoteSong(const pb::remote::SongMetadata &m, qint64 fieldsMask):
+    id(m.id()), index(m.index()),
+    title(decodeField(fieldsMask, pb::remote::SongMetadata::kTitleFieldNumber, m.title())),
+    album(decodeField(fieldsMask, pb::remote::SongMetadata::kAlbumFieldNumber, m.album())),
+    artist(decodeField(fieldsMask, pb::remote::SongMetadata::kArtistFieldNumber, m.artist())),
+    albumartist(decodeField(fieldsMask, pb::remote::SongMetadata::kAlbumartistFieldNumber, m.albumartist())),
+    track(m.track()), disc(m.disc()),
+    pretty_year(decodeField(fieldsMask, pb::remote::SongMetadata::kPrettyYearFieldNumber, m.pretty_year())),
+    genre(decodeField(fieldsMask, pb::remote::SongMetadata::kGenreFieldNumber, m.genre())),
+    playcount(m.playcount()),
+    pretty_length(decodeField(fieldsMask, pb::remote::SongMetadata::kPrettyLengthFieldNumber, m.pretty_length())),
+    length(m.length()), is_local(m.is_local()),
+    filename(decodeField(fieldsMask, pb::remote::SongMetadata::kFilenameFieldNumber, m.filename())),
+    file_size(m.file_size()), rating(m.rating()),
+    url(decodeField(fieldsMask, pb::remote::SongMetadata::kUrlFieldNumber, m.url())),
+    art_automatic(decodeField(fieldsMask, pb::remote::SongMetadata::kArtAutomaticFieldNumber, m.art_automatic())),
+    art_manual(decodeField(fieldsMask, pb::remote::SongMetadata::kArtManualFieldNumber, m.art_manual())),
+    type(m.type()), artData(),
+    selected(false), fields_mask(fieldsMask)
+{
+    if ((fieldsMask & fieldBit(pb::remote::SongMetadata::kArtFieldNumber)) && m.has_art() && m.art().size())
+        artData = QByteArray(m.art().data(), static_cast<int>(m.art().size()));
+}
+
 QString RemoteSong::name() const
 {
     QString n(title);
@@ -30,3 +71,13 @@ QString RemoteSong::name() const
         n.prepend(QString("%1: ").arg(artist));
     return n;
 }
+
+qint64 RemoteSong::memoryUsage() const
+{
+    qint64 size = sizeof(RemoteSong);
+    for (const QString *str : {&title, &album, &artist, &albumartist, &pretty_year, &genre,
+                               &pretty_length, &filename, &url, &art_automatic, &art_manual})
+        size += str->capacity() * static_cast<qint64>(sizeof(QChar));
+    size += artData.capacity();
+    return size;
+}
@@ -20,10 +20,11 @@
 #ifndef REMOTESONG_H
 #define REMOTESONG_H
 #include "protobuf/remotecontrolmessages.pb.h"
+#include "utils/Utf8.h"
 
 #include <QtGlobal>
 #include <QString>
-#include <QImage>
+#include <QByteArray>
 typedef struct RemoteSong
 {
     qint32 id; // unique id of the song
@@ -47,11 +48,13 @@ typedef struct RemoteSong
     QString art_automatic;
     QString art_manual;
     pb::remote::SongMetadata_Type type;
-    QImage art;
+    QByteArray artData; //!< encoded album art (never decoded in memory)
 
     bool selected; // for its selection in ListView
+    qint64 fields_mask; // SongMetadata fields decoded (0 if all of them)
 
     static bool sDispArtistInName;
+    static const qint64 sPlaylistFieldsMask; //!< fields used by the playlist View (RemoteSongModel)
 
 public:
     RemoteSong() = default;
@@ -59,19 +62,23 @@ public:
     RemoteSong(RemoteSong &&) = default;
 
     RemoteSong(const pb::remote::SongMetadata &m):
-        id(m.id()), index(m.index()), title(m.title().c_str()), album(m.album().c_str()),
-        artist(m.artist().c_str()), albumartist(m.albumartist().c_str()), track(m.track()),
-        disc(m.disc()), pretty_year(m.pretty_year().c_str()), genre(m.genre().c_str()),
-        playcount(m.playcount()), pretty_length(m.pretty_length().c_str()), length(m.length()),
-        is_local(m.is_local()), filename(m.filename().c_str()), file_size(m.file_size()), rating(m.rating()),
-        url(m.url().c_str()), art_automatic(m.art_automatic().c_str()), art_manual(m.art_manual().c_str()),
-        type(m.type()), art(),
-        selected(false)
+        id(m.id()), index(m.index()), title(Utf8::toQString(m.title())), album(Utf8::toQString(m.album())),
+        artist(Utf8::toQString(m.artist())), albumartist(Utf8::toQString(m.albumartist())), track(m.track()),
+        disc(m.disc()), pretty_year(Utf8::toQString(m.pretty_year())), genre(Utf8::toQString(m.genre())),
+        playcount(m.playcount()), pretty_length(Utf8::toQString(m.pretty_length())), length(m.length()),
+        is_local(m.is_local()), filename(Utf8::toQString(m.filename())), file_size(m.file_size()), rating(m.rating()),
+        url(Utf8::toQString(m.url())), art_automatic(Utf8::toQString(m.art_automatic())), art_manual(Utf8::toQString(m.art_manual())),
+        type(m.type()), artData(),
+        selected(false), fields_mask(0)
     {
         if (m.has_art() && m.art().size())
-            art = QImage(m.art().c_str());
+            artData = QByteArray(m.art().data(), static_cast<int>(m.art().size()));
     }
 
+    //! only decode the fields of the mask (bit n for the field number n)
+    //! the numeric ones are cheap so they're always copied
+    RemoteSong(const pb::remote::SongMetadata &m, qint64 fieldsMask);
+
     RemoteSong& operator=(const RemoteSong &) = default;
     RemoteSong& operator=(RemoteSong &&) = default;
 
@@ -80,10 +87,20 @@ public:
     inline QString str() const;
     QString name() const;
 
+    qint64 memoryUsage() const; //!< estimation of the bytes used by the song (including its strings)
+
+
+    inline bool hasAllFields() const;
+    inline static qint64 fieldBit(int fieldNumber);
+
 //    inline RemoteSong& operator=(const pb::remote::SongMetadata &m);
 } RemoteSong;
 
 
+bool RemoteSong::hasAllFields() const { return fields_mask == 0; }
+
+qint64 RemoteSong::fieldBit(int fieldNumber) { return Q_INT64_C(1) << fieldNumber; }
+
 QString RemoteSong::str() const
 {
     return QString("#%1 %2 (title: %3, length: %4 (%5), size: %6, index: %7)").arg(
@@ -95,24 +112,24 @@ RemoteSong &RemoteSong::operator=(const pb::remote::SongMetadata &m)
 {
     id = m.id();
     index = m.index();
-    title = m.title().c_str();
-    album = m.album().c_str();
-    artist = m.artist().c_str();
-    albumartist = m.albumartist().c_str();
+    title = Utf8::toQString(m.title());
+    album = Utf8::toQString(m.album());
+    artist = Utf8::toQString(m.artist());
+    albumartist = Utf8::toQString(m.albumartist());
     track = m.track();
     disc = m.disc();
-    pretty_year = m.pretty_year().c_str();
-    genre = m.genre().c_str();
+    pretty_year = Utf8::toQString(m.pretty_year());
+    genre = Utf8::toQString(m.genre());
     playcount = m.playcount();
-    pretty_length = m.pretty_length().c_str();
+    pretty_length = Utf8::toQString(m.pretty_length());
     length = m.length();
     is_local = m.is_local();
-    filename = m.filename().c_str();
+    filename = Utf8::toQString(m.filename());
     file_size = m.file_size();
     rating = m.rating();
-    url = m.url().c_str();
-    art_automatic = m.art_automatic().c_str();
-    art_manual = m.art_manual().c_str();
+    url = Utf8::toQString(m.url());
+    art_automatic = Utf8::toQString(m.art_automatic());
+    art_manual = Utf8::toQString(m.art_manual());
 
     return *this;
 }
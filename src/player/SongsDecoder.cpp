@@ -0,0 +1,80 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "SongsDecoder.h"
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrent>
+
+QList<RemoteSong> SongsDecoder::decode(const SongsMetadata &songs, qint64 fieldsMask,
+                                       qint32 activeIndex, int &activeRow, int nbChunks)
+{
+    int nbSongs = songs.size();
+    if (nbChunks <= 0)
+        nbChunks = QThreadPool::globalInstance()->maxThreadCount();
+    nbChunks = qBound(1, nbChunks, nbSongs / sMinSongsPerChunk);
+
+    // preallocated slots (QList stores pointers on the songs for such a big type)
+    QList<RemoteSong> playlistSongs;
+    playlistSongs.reserve(nbSongs);
+    QVector<RemoteSong*> songSlots(nbSongs);
+    for (int i = 0 ; i < nbSongs ; ++i)
+    {
+        playlistSongs.append(RemoteSong());
+        songSlots[i] = &playlistSongs[i];
+    }
+
+    int chunkSize = (nbSongs + nbChunks - 1) / nbChunks;
+    QVector<int> activeRows(nbChunks, -1);
+    QList<QFuture<void>> futures;
+    for (int chunk = 1 ; chunk < nbChunks ; ++chunk)
+    {
+        int first = chunk * chunkSize, last = qMin(nbSongs, first + chunkSize);
+        futures << QtConcurrent::run([&songs, fieldsMask, activeIndex, &songSlots, &activeRows, chunk, first, last](){
+            activeRows[chunk] = decodeChunk(songs, fieldsMask, activeIndex, songSlots.data(), first, last);
+        });
+    }
+    activeRows[0] = decodeChunk(songs, fieldsMask, activeIndex, songSlots.data(), 0, qMin(nbSongs, chunkSize));
+    for (QFuture<void> &future : futures)
+        future.waitForFinished();
+
+    activeRow = -1;
+    for (int row : activeRows)
+    {
+        if (row != -1)
+        {
+            activeRow = row;
+            break;
+        }
+    }
+    return playlistSongs;
+}
+
+int SongsDecoder::decodeChunk(const SongsMetadata &songs, qint64 fieldsMask, qint32 activeIndex,
+                              RemoteSong **songSlots, int first, int last)
+{
+    int activeRow = -1;
+    for (int i = first ; i < last ; ++i)
+    {
+        *songSlots[i] = RemoteSong(songs.Get(i), fieldsMask);
+        if (activeRow == -1 && songSlots[i]->index == activeIndex)
+            activeRow = i;
+    }
+    return activeRow;
+}
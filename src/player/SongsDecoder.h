@@ -0,0 +1,51 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef SONGSDECODER_H
+#define SONGSDECODER_H
+#include "RemoteSong.h"
+#include <QList>
+
+/*!
+ * \brief converts the SongMetadata of a PLAYLIST_SONGS into RemoteSongs
+ * the big playlists are split in chunks decoded in parallel (global QThreadPool)
+ * into preallocated slots, the first chunk being decoded by the calling thread.
+ * The lookup of the active song is done in the same pass.
+ */
+class SongsDecoder
+{
+public:
+    static const int sMinSongsPerChunk = 2000; //!< the UTF-8 to UTF-16 conversion of smaller chunks isn't worth a thread
+
+    typedef google::protobuf::RepeatedPtrField<pb::remote::SongMetadata> SongsMetadata;
+
+    //! nbChunks: 0 to use all the threads of the global QThreadPool
+    //! activeRow: row of the song with activeIndex (-1 if not found)
+    static QList<RemoteSong> decode(const SongsMetadata &songs, qint64 fieldsMask,
+                                    qint32 activeIndex, int &activeRow, int nbChunks = 0);
+
+    SongsDecoder() = delete;
+
+private:
+    //! decodes [first, last[ in songSlots, returns the active row (-1 if not in this chunk)
+    static int decodeChunk(const SongsMetadata &songs, qint64 fieldsMask, qint32 activeIndex,
+                           RemoteSong **songSlots, int first, int last);
+};
+
+#endif // SONGSDECODER_H
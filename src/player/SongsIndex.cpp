@@ -0,0 +1,89 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "SongsIndex.h"
+#include <algorithm>
+
+SongsIndex::SongsIndex():
+    _rowOfId(), _rowOfIndex(), _selectedRows(), _valid(false)
+{}
+
+int SongsIndex::rowOfIndex(const QList<RemoteSong> &songs, qint32 songIndex)
+{
+    // most of the time the index of a song is its row in the playlist
+    if (songIndex >= 0 && songIndex < songs.size() && songs.at(songIndex).index == songIndex)
+        return songIndex;
+    build(songs);
+    return _rowOfIndex.value(songIndex, -1);
+}
+
+int SongsIndex::rowOfId(const QList<RemoteSong> &songs, qint32 songId)
+{
+    build(songs);
+    return _rowOfId.value(songId, -1);
+}
+
+void SongsIndex::setSelected(int row, bool selected)
+{
+    if (!_valid)
+        return; // the build will read RemoteSong::selected
+    if (selected)
+        _selectedRows.insert(row);
+    else
+        _selectedRows.remove(row);
+}
+
+QList<int> SongsIndex::selectedRows(const QList<RemoteSong> &songs)
+{
+    build(songs);
+    QList<int> rows = _selectedRows.values();
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+qint64 SongsIndex::memoryUsage() const
+{
+    // a QHash node holds its key, its value and the next pointer
+    return static_cast<qint64>(_rowOfId.size() + _rowOfIndex.size() + _selectedRows.size())
+            * static_cast<qint64>(sizeof(void*) + 2 * sizeof(int))
+            + static_cast<qint64>(_rowOfId.capacity() + _rowOfIndex.capacity() + _selectedRows.capacity())
+            * static_cast<qint64>(sizeof(void*));
+}
+
+void SongsIndex::build(const QList<RemoteSong> &songs)
+{
+    if (_valid)
+        return;
+
+    int nbSongs = songs.size();
+    _rowOfId.clear();
+    _rowOfIndex.clear();
+    _selectedRows.clear();
+    _rowOfId.reserve(nbSongs);
+    _rowOfIndex.reserve(nbSongs);
+    for (int row = 0 ; row < nbSongs ; ++row)
+    {
+        const RemoteSong &song = songs.at(row);
+        _rowOfId.insert(song.id, row);
+        _rowOfIndex.insert(song.index, row);
+        if (song.selected)
+            _selectedRows.insert(row);
+    }
+    _valid = true;
+}
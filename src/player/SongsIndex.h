@@ -0,0 +1,68 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef SONGSINDEX_H
+#define SONGSINDEX_H
+#include "RemoteSong.h"
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+
+/*!
+ * \brief secondary indexes over the displayed songs (ClementineRemote::_songs)
+ * song id -> row, server index -> row and the selected rows
+ * so a track change or a selection request doesn't scan 100k songs.
+ * Invalidated on each structural change of the songs and rebuilt on the next lookup
+ * (the inserts, removals and moves of a PLAYLIST_DELTA renumber the rows anyway)
+ * (it's only used from the GUI Thread, no need to lock it)
+ */
+class SongsIndex
+{
+public:
+    SongsIndex();
+    ~SongsIndex() = default;
+
+    SongsIndex(const SongsIndex &) = delete;
+    SongsIndex &operator=(const SongsIndex &) = delete;
+
+    inline void invalidate(); //!< to call each time the songs are inserted, removed, moved or replaced
+    inline bool isValid() const;
+
+    int rowOfIndex(const QList<RemoteSong> &songs, qint32 songIndex); //!< -1 if not found
+    int rowOfId(const QList<RemoteSong> &songs, qint32 songId);       //!< -1 if not found
+
+    void setSelected(int row, bool selected); //!< to follow RemoteSong::selected
+    QList<int> selectedRows(const QList<RemoteSong> &songs); //!< sorted
+
+    qint64 memoryUsage() const;
+
+private:
+    void build(const QList<RemoteSong> &songs);
+
+    QHash<qint32, int> _rowOfId;
+    QHash<qint32, int> _rowOfIndex;
+    QSet<int>          _selectedRows;
+    bool               _valid;
+};
+
+void SongsIndex::invalidate() { _valid = false; }
+bool SongsIndex::isValid() const { return _valid; }
+
+#endif // SONGSINDEX_H
@@ -0,0 +1,221 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "SongsSorter.h"
+#include "utils/TraceRecorder.h"
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+//! runs job(0) in the calling thread and the other chunks on the global QThreadPool
+static void runChunks(int nbChunks, const std::function<void(int)> &job)
+{
+    QList<QFuture<void>> futures;
+    for (int chunk = 1 ; chunk < nbChunks ; ++chunk)
+        futures << QtConcurrent::run([&job, chunk](){ job(chunk); });
+    job(0);
+    for (QFuture<void> &future : futures)
+        future.waitForFinished();
+}
+
+static int nbChunksFor(int nbRows)
+{
+    return qBound(1, QThreadPool::globalInstance()->maxThreadCount(), nbRows / SongsSorter::sMinRowsPerThread);
+}
+
+SongsSorter::SongsSorter():
+    _collator(), _keys(), _ranks(), _valid(false), _keyColumns(), _collationKeys()
+{
+    _collator.setCaseSensitivity(Qt::CaseInsensitive);
+    _collator.setNumericMode(true); // "Track 2" before "Track 10"
+    _collator.setIgnorePunctuation(true);
+}
+
+void SongsSorter::sortBy(Column column)
+{
+    if (column == Column::none)
+    {
+        clear();
+        return;
+    }
+
+    if (!_keys.isEmpty() && _keys.first().column == column)
+        _keys.first().ascending = !_keys.first().ascending;
+    else
+    {
+        for (int i = 0 ; i < _keys.size() ; ++i)
+        {
+            if (_keys.at(i).column == column)
+            {
+                _keys.removeAt(i);
+                break;
+            }
+        }
+        _keys.prepend({column, true});
+        while (_keys.size() > sMaxKeys)
+            _keys.removeLast();
+    }
+    _valid = false; // the collation keys are still good
+}
+
+void SongsSorter::clear()
+{
+    _keys.clear();
+    _ranks.clear();
+    _ranks.squeeze();
+    invalidate();
+}
+
+qint64 SongsSorter::memoryUsage() const
+{
+    qint64 bytes = _ranks.capacity() * static_cast<qint64>(sizeof(int));
+    for (const std::vector<QCollatorSortKey> &keys : _collationKeys)
+        bytes += static_cast<qint64>(keys.capacity()) * (sizeof(QCollatorSortKey) + 64); // + the key itself
+    return bytes;
+}
+
+void SongsSorter::sort(const QList<RemoteSong> &songs)
+{
+    M_TRACE_SCOPE("SongsSorter::sort");
+    QElapsedTimer sortTime;
+    sortTime.start();
+
+    int nbSongs = songs.size(), nbKeys = _keys.size();
+    QVector<const std::vector<QCollatorSortKey>*> textKeys(nbKeys, nullptr);
+    for (int i = 0 ; i < nbKeys ; ++i)
+    {
+        if (isText(_keys.at(i).column))
+            textKeys[i] = &collationKeys(songs, _keys.at(i).column);
+    }
+    qint64 keysMs = sortTime.elapsed();
+
+    auto lessThan = [&](int a, int b){
+        for (int i = 0 ; i < nbKeys ; ++i)
+        {
+            const Key &key = _keys.at(i);
+            int cmp = 0;
+            if (textKeys.at(i))
+            {
+                const std::vector<QCollatorSortKey> &keys = *textKeys.at(i);
+                cmp = keys[static_cast<size_t>(a)].compare(keys[static_cast<size_t>(b)]);
+            }
+            else
+            {
+                qint64 x = number(songs.at(a), key.column), y = number(songs.at(b), key.column);
+                cmp = x < y ? -1 : (x > y ? 1 : 0);
+            }
+            if (cmp != 0)
+                return key.ascending ? cmp < 0 : cmp > 0;
+        }
+        return false; // equal: stable_sort keeps the playlist order
+    };
+
+    // stable sort of the chunks in parallel then merged two by two
+    QVector<int> permutation(nbSongs);
+    std::iota(permutation.begin(), permutation.end(), 0);
+    int nbChunks  = nbChunksFor(nbSongs);
+    int chunkSize = (nbSongs + nbChunks - 1) / nbChunks;
+    int *rows     = permutation.data();
+    runChunks(nbChunks, [&](int chunk){
+        int first = qMin(nbSongs, chunk * chunkSize), last = qMin(nbSongs, first + chunkSize);
+        std::stable_sort(rows + first, rows + last, lessThan);
+    });
+    for (int width = chunkSize ; width < nbSongs ; width *= 2)
+    {
+        int nbMerges = (nbSongs + 2 * width - 1) / (2 * width);
+        runChunks(nbMerges, [&](int merge){
+            int first = merge * 2 * width;
+            int middle = qMin(nbSongs, first + width), last = qMin(nbSongs, first + 2 * width);
+            if (middle < last)
+                std::inplace_merge(rows + first, rows + middle, rows + last, lessThan);
+        });
+    }
+
+    _ranks.resize(nbSongs);
+    for (int i = 0 ; i < nbSongs ; ++i)
+        _ranks[permutation.at(i)] = i;
+    _valid = true;
+
+    qDebug() << "[SongsSorter::sort] " << nbSongs << " songs sorted on " << nbKeys << " keys in "
+             << sortTime.elapsed() << " ms (collation keys: " << keysMs << " ms, " << nbChunks << " chunks)";
+}
+
+const std::vector<QCollatorSortKey> &SongsSorter::collationKeys(const QList<RemoteSong> &songs, Column column)
+{
+    int idx = _keyColumns.indexOf(column);
+    if (idx != -1)
+        return _collationKeys.at(idx);
+
+    // one QCollator per thread (they're not thread safe)
+    int nbSongs   = songs.size();
+    int nbChunks  = nbChunksFor(nbSongs);
+    int chunkSize = (nbSongs + nbChunks - 1) / nbChunks;
+    QVector<std::vector<QCollatorSortKey>> chunks(nbChunks);
+    runChunks(nbChunks, [&](int chunk){
+        QCollator collator(_collator.locale());
+        collator.setCaseSensitivity(_collator.caseSensitivity());
+        collator.setNumericMode(_collator.numericMode());
+        collator.setIgnorePunctuation(_collator.ignorePunctuation());
+        int first = qMin(nbSongs, chunk * chunkSize), last = qMin(nbSongs, first + chunkSize);
+        std::vector<QCollatorSortKey> &keys = chunks[chunk];
+        keys.reserve(static_cast<size_t>(last - first));
+        for (int row = first ; row < last ; ++row)
+            keys.push_back(collator.sortKey(text(songs.at(row), column)));
+    });
+
+    std::vector<QCollatorSortKey> keys;
+    keys.reserve(static_cast<size_t>(nbSongs));
+    for (std::vector<QCollatorSortKey> &chunk : chunks)
+        keys.insert(keys.end(), std::make_move_iterator(chunk.begin()), std::make_move_iterator(chunk.end()));
+
+    _keyColumns << column;
+    _collationKeys.append(std::vector<QCollatorSortKey>());
+    _collationKeys.last().swap(keys);
+    return _collationKeys.last();
+}
+
+const QString &SongsSorter::text(const RemoteSong &song, Column column)
+{
+    switch (column) {
+    case Column::artist:
+        return song.artist;
+    case Column::album:
+        return song.album;
+    default:
+        return song.title;
+    }
+}
+
+qint64 SongsSorter::number(const RemoteSong &song, Column column)
+{
+    switch (column) {
+    case Column::track:
+        return song.track;
+    case Column::length:
+        return song.length;
+    case Column::rating:
+        return qRound(song.rating * 100);
+    default:
+        return song.index;
+    }
+}
@@ -0,0 +1,113 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef SONGSSORTER_H
+#define SONGSSORTER_H
+#include "RemoteSong.h"
+
+#include <QCollator>
+#include <QList>
+#include <QVector>
+#include <vector>
+
+/*!
+ * \brief client side sort of the displayed songs (ClementineRemote::_songs) on up to sMaxKeys columns
+ * The QCollator sort keys of a column are computed once (in parallel) and kept until the songs change,
+ * then the rows are sorted (stable, parallel chunks merged) into a permutation.
+ * RemoteSongProxyModel only compares the ranks of the rows.
+ * (it's only used from the GUI Thread, no need to lock it)
+ */
+class SongsSorter
+{
+public:
+    enum class Column : ushort {none = 0, title, artist, album, track, length, rating, index};
+
+    typedef struct Key
+    {
+        Column column;
+        bool   ascending;
+    } Key;
+
+    static const int sMaxKeys          = 3;
+    static const int sMinRowsPerThread = 4096; //!< for the sort keys and the sort chunks
+
+    SongsSorter();
+    ~SongsSorter() = default;
+
+    SongsSorter(const SongsSorter &) = delete;
+    SongsSorter &operator=(const SongsSorter &) = delete;
+
+    inline void invalidate(); //!< to call each time the songs are inserted, removed, moved or replaced
+    inline void dropCollationKeys(); //!< memory pressure: the current ranks stay valid
+    inline bool isSorted() const;
+    inline const QList<Key> &keys() const;
+
+    //! the column becomes the primary key (the previous ones are kept as secondary keys)
+    //! the primary key is reversed if it was already it
+    void sortBy(Column column);
+    void clear();
+
+    inline int rank(const QList<RemoteSong> &songs, int row); //!< position of the row once sorted
+
+    qint64 memoryUsage() const;
+
+private:
+    void sort(const QList<RemoteSong> &songs);
+    const std::vector<QCollatorSortKey> &collationKeys(const QList<RemoteSong> &songs, Column column);
+    static const QString &text(const RemoteSong &song, Column column);
+    static qint64 number(const RemoteSong &song, Column column);
+    static inline bool isText(Column column);
+
+    QCollator                     _collator;
+    QList<Key>                    _keys;
+    QVector<int>                  _ranks;        //!< source row -> sorted row
+    bool                          _valid;
+    QList<Column>                 _keyColumns;   //!< columns of the cached collation keys
+    QList<std::vector<QCollatorSortKey>> _collationKeys;
+};
+
+void SongsSorter::invalidate()
+{
+    _valid = false;
+    _keyColumns.clear();
+    _collationKeys.clear();
+}
+void SongsSorter::dropCollationKeys()
+{
+    _keyColumns.clear();
+    _collationKeys.clear();
+}
+bool SongsSorter::isSorted() const { return !_keys.isEmpty(); }
+const QList<SongsSorter::Key> &SongsSorter::keys() const { return _keys; }
+
+int SongsSorter::rank(const QList<RemoteSong> &songs, int row)
+{
+    if (_keys.isEmpty())
+        return row;
+    if (!_valid)
+        sort(songs);
+    return row < _ranks.size() ? _ranks.at(row) : row;
+}
+
+bool SongsSorter::isText(Column column)
+{
+    return column == Column::title || column == Column::artist || column == Column::album;
+}
+
+#endif // SONGSSORTER_H
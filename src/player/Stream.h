@@ -20,6 +20,7 @@
 #ifndef STREAM_H
 #define STREAM_H
 
+#include "utils/Utf8.h"
 #include <QString>
 
 typedef struct Stream
@@ -30,7 +31,7 @@ typedef struct Stream
 
 public:
     Stream(const std::string &name_, const std::string &url_, const std::string &logoUrl_):
-        name(name_.c_str()), url(url_.c_str()), logoUrl(logoUrl_.c_str()){}
+        name(Utf8::toQString(name_)), url(Utf8::toQString(url_)), logoUrl(Utf8::toQString(logoUrl_)){}
 
     Stream():
         name(), url(), logoUrl(){}
@@ -24,91 +24,94 @@ Rectangle {
     radius: 10
     id: gsRect
 
-    property int qrBtcSize: 120
+    property int headerHeight : 50
+    property int lineHeigth   : 45
+    property int iconSize     : 24
 
     anchors.fill: parent.fill
 
-    Flickable {
-        id: flickable
-        clip: true
-        width: parent.width
-        height: parent.height
-        contentHeight: gsText.height + gsTitle.height + qrBtcSize + 60
-
-        ScrollIndicator.vertical: ScrollIndicator {
-            parent: gsRect
-            anchors.top: flickable.top
-            anchors.bottom: flickable.bottom
-            anchors.right: parent.right
+    Connections{
+        target: cppRemote
+        function onGlobalSearchStatus(searching){
+            searchIndicator.running = searching;
+            if (!searching && searchField.text.trim().length >= 2 && gsView.count === 0)
+                noResultLbl.visible = true;
         }
+    }
 
-        Text {
-            id: gsTitle
-            anchors{
-                horizontalCenter: parent.horizontalCenter
-                top: parent.top
-                topMargin: 20
-            }
-            text: '<h3>' + qsTr('Global Search not implemented') + '</h3'
-        }
+    Component.onCompleted: searchField.forceActiveFocus();
 
+    Rectangle {
+        id: header
+        width: parent.width
+        height: headerHeight
+        radius: gsRect.radius
+        color: "white"
 
-        Text {
-            id: gsText
-            anchors{
-                top: gsTitle.bottom;
+        SearchField {
+            id: searchField
+            anchors {
                 left: parent.left
-                topMargin: 30
-                leftMargin: 10
+                right: searchIndicator.left
+                leftMargin: 5
+                rightMargin: 5
+                verticalCenter: parent.verticalCenter
+            }
+            // each keystroke is sent: the results of the previous query are dropped by cppRemote
+            onTextChanged: {
+                noResultLbl.visible = false;
+                cppRemote.globalSearch(text);
             }
-            text: qsTr("As I don't use any Internet Storage, I've not implemented this part...")+
-                  '<br/><br/>' +
-                  qsTr("If you'd be interested in it, please open a request/issue on ") +
-                  '<a href="' + cppRemote.projectURL() +'/issues">Clementine Remote GitHub</a> ' +
-                  '<br/>' + qsTr('or drop me an email at Matthieu.Bruel@gmail.com') +
-                  '<br/><br/>' +
-                  qsTr('If you like the app and wish to reward the effort, feel free to donate what you can :)') +
-                  '<br/><br/>' + qsTr('Here is my btc address: ') + '<b>' + cppRemote.btcAddress() +'</b>'
-            width: parent.width - 10
-            wrapMode: Text.WordWrap
-            onLinkActivated: Qt.openUrlExternally(cppRemote.projectURL()+'/issues')
         }
-
-        Image {
-            id: btcImg
-            fillMode: Image.PreserveAspectFit;
+        BusyIndicator {
+            id: searchIndicator
+            running: cppRemote.isGlobalSearching()
+            width: headerHeight - 10
+            height: width
             anchors {
-                left: parent.left
-                leftMargin: 20
-                top: gsText.bottom
-                topMargin: 10
+                right: parent.right
+                rightMargin: 5
+                verticalCenter: parent.verticalCenter
             }
-            source: "btc_qr.gif"
-            width: qrBtcSize
-            height: qrBtcSize
         }
+    } // header
 
-        Rectangle {
-            height: donateImg.height
-            width: donateImg.width
-            color: "transparent"
-            anchors {
-                left: btcImg.right
-                verticalCenter: btcImg.verticalCenter
-                leftMargin: 20
-            }
+    Label {
+        id: noResultLbl
+        visible: false
+        text: qsTr("No result")
+        anchors.centerIn: gsView
+    }
+
+    ListView {
+        id: gsView
+        clip: true
+        anchors {
+            top: header.bottom
+            topMargin: 5
+            left: parent.left
+            right: parent.right
+            bottom: parent.bottom
+        }
+        model: cppRemote.modelGlobalSearch() // rows appended as each provider answers
+        ScrollBar.vertical: ScrollBar {}
+        delegate: ItemDelegate {
+            width: ListView.view.width
+            height: lineHeigth
+            leftPadding: iconSize + 10
+            text: "<b>" + title + "</b> - " + artist + "<br/><i>" + album + "</i>"
             Image {
-                id: donateImg
-                width: 147
-                height: 47
-                fillMode: Image.PreserveAspectFit;
-                anchors.fill: parent
-                source: "icons/donate.gif"
-            }
-            MouseArea {
-                anchors.fill: parent
-                onClicked: Qt.openUrlExternally(cppRemote.donateURL())
+                source: providerIcon
+                width: iconSize
+                height: iconSize
+                fillMode: Image.PreserveAspectFit
+                anchors {
+                    left: parent.left
+                    leftMargin: 5
+                    verticalCenter: parent.verticalCenter
+                }
             }
+            onClicked: cppRemote.appendGlobalSearchResult(index, "");
         }
-    }
+    } // gsView
 }
@@ -65,6 +65,10 @@ Rectangle {
         function onLibraryLoaded(){
             loadLibrary();
         }
+        function onLibraryShed(){ // memory pressure while displayed: reload it from the DB
+            loadLibrary();
+            requestLibraryTimer.start();
+        }
     }
 
     Timer {
@@ -90,7 +94,7 @@ Rectangle {
 
         SearchField {
             id: searchField
-            width: parent.width - headerButtonSize - 2*headerSpacing
+            width: parent.width - 2*headerButtonSize - 3*headerSpacing
             anchors {
                 left: parent.left
                 leftMargin: 5
@@ -99,6 +103,39 @@ Rectangle {
             onTextChanged: cppRemote.setLibraryFilter(text);
         }// searchField
 
+        ImageButton {
+            id:   hierarchyButton
+            size: headerButtonSize
+            anchors {
+                right: refreshLibButton.left
+                rightMargin: headerSpacing
+                verticalCenter: parent.verticalCenter
+            }
+            source: "icons/library.png";
+            onClicked: hierarchyMenu.open();
+
+            QQC.Menu {
+                id: hierarchyMenu
+                y: parent.height
+                property int current: cppRemote.libraryHierarchy()
+                onAboutToShow: current = cppRemote.libraryHierarchy();
+                // values of LibraryTable::Hierarchy
+                Repeater {
+                    model: [qsTr("Artist / Album"), qsTr("Album Artist / Album"),
+                        qsTr("Genre / Artist / Album"), qsTr("Year / Album")]
+                    QQC.MenuItem {
+                        text: modelData
+                        checkable: true
+                        checked: hierarchyMenu.current === index
+                        onTriggered: {
+                            cppRemote.setLibraryHierarchy(index);
+                            hierarchyMenu.close();
+                        }
+                    }
+                }
+            }
+        } // hierarchyButton
+
         ImageButton {
             id:   refreshLibButton
             size: headerButtonSize
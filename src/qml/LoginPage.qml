@@ -38,6 +38,7 @@ Page {
         let host = ipField.text;
         let port = parseInt(portField.text);
         let pass = parseInt(passField.text);
+        discoverButton.enabled = true; // the scan is stopped by the connection
         cppRemote.tryConnectToServer(sessions.currentIndex, host, port, pass);
     }
 
@@ -114,6 +115,15 @@ Page {
         function onConnectionError(err){
             errMsg.text = err;
         }
+        function onServerDiscovered(sessionIndex){
+            sessions.model = cppRemote.sessionNames();
+            sessions.currentIndex = sessionIndex;
+        }
+        function onDiscoveryFinished(nbServers){
+            discoverButton.enabled = true;
+            displayMessage(qsTr("%1 server(s) found").arg(nbServers));
+            cppRemote.saveSessions();
+        }
     }
 
     Component.onCompleted: {
@@ -121,6 +131,7 @@ Page {
         initialized = true;
         displaySession();
     }
+    Component.onDestruction: cppRemote.stopDiscovery();
 
     anchors {
         fill: parent.fil;
@@ -203,6 +214,18 @@ Page {
                 source: "icons/save.png";
                 onClicked: saveSessionDialog.open();
             }
+
+            ImageButton {
+                id:   discoverButton
+                size: parent.height
+                anchors.verticalCenter: parent.verticalCenter;
+                source: "icons/search.png";
+                onClicked: {
+                    enabled = false;
+                    displayMessage(qsTr("Looking for Clementine servers..."));
+                    cppRemote.discoverServers(portField.text.length === 0 ? 5500 : parseInt(portField.text));
+                }
+            }
         }
 
         Row {
@@ -207,6 +207,30 @@ Item {
         }
     } // function changeMainMenu
 
+    Connections{
+        target: Qt.application
+        function onStateChanged(){ updateTrackClock(); }
+    }
+
+    Timer { // refresh of the track position at display rate (extrapolated by cppRemote)
+        id: trackClock
+        interval: 16
+        repeat: true
+        running: false
+        onTriggered: {
+            if (trackSlider.pressed || trackLength <= 0)
+                return;
+            let pos = cppRemote.trackPositionMs() / 1000;
+            trackPosition.text = cppRemote.prettyLength(Math.floor(pos));
+            trackSlider.value  = pos / trackLength;
+        }
+    }
+
+    function updateTrackClock(){
+        // no wakeups when nothing is displayed
+        trackClock.running = cppRemote.isPlaying() && Qt.application.state === Qt.ApplicationActive;
+    }
+
     function updatePlayerState(){
         var enableStop = true;
         if (cppRemote.isPlaying())
@@ -219,6 +243,7 @@ Item {
         }
         stopSong.enabled = enableStop
         stopSong.opacity = enableStop ? 1 : 0.5
+        updateTrackClock();
     } // function updatePlayerState
 
     function useVolumeButtonWithVerticalSlider(useVolButton) {
@@ -785,6 +810,50 @@ You can change that in:<br/>Tools -> Preferences -> Network Remote"));
         } // cancelDownload
     } // downloadRect
 
+    Rectangle { // debug overlay of cppRemote.memoryReport()
+        id: memoryOverlay
+        anchors{
+            top: parent.top
+            right: parent.right
+            margins: toolBarMargin
+        }
+        width: memoryColumn.width + 2 * toolBarSpacing
+        height: memoryColumn.height + 2 * toolBarSpacing
+        radius: 10
+        color: "#c0000000"
+        visible: false
+        z: 10
+
+        property var accounts: []
+
+        Timer {
+            interval: 1000
+            running: memoryOverlay.visible
+            repeat: true
+            triggeredOnStart: true
+            onTriggered: memoryOverlay.accounts = cppRemote.memoryReport();
+        }
+
+        Column {
+            id: memoryColumn
+            anchors.centerIn: parent
+            Repeater {
+                model: memoryOverlay.accounts
+                Text {
+                    color: modelData.name === "total" ? "#17a81a" : "white"
+                    font.pointSize: 10
+                    text: modelData.count < 0 ? "%1: %2 kB".arg(modelData.name).arg(Math.round(modelData.bytes / 1024))
+                                              : "%1: %2 kB (%3)".arg(modelData.name).arg(Math.round(modelData.bytes / 1024)).arg(modelData.count)
+                }
+            }
+        }
+
+        MouseArea {
+            anchors.fill: parent
+            onClicked: memoryOverlay.visible = false;
+        }
+    } // memoryOverlay
+
 
 
     ////////////////////////////////////////
@@ -1045,6 +1114,32 @@ You can change that in:<br/>Tools -> Preferences -> Network Remote"));
                          +'<br/>'+qsTr("The download folder is: %1").arg(cppRemote.downloadPath()));
                 }
             } // downloads
+            Repeater {
+                id: rooms
+                model: cppRemote.sessionNames()
+                ItemDelegate {
+                    width: parent.width
+                    visible: index !== cppRemote.lastSessionIndex()
+                    height: visible ? implicitHeight : 0
+                    text : qsTr("Switch to %1").arg(modelData)
+                    icon.source: "icons/internet.png"
+                    onClicked: {
+                        drawer.close();
+                        drawer.switchSession = index;
+                    }
+                }
+            } // rooms
+            ItemDelegate {
+                id: memory
+                width: parent.width
+                visible: cppRemote.debugBuild() // developer tool, not for the release builds
+                text : memoryOverlay.visible ? qsTr("Hide memory usage") : qsTr("Show memory usage")
+                icon.source: "icons/nav_settings.png"
+                onClicked: {
+                    drawer.close();
+                    memoryOverlay.visible = !memoryOverlay.visible;
+                }
+            } // memory
             ItemDelegate {
                 id: about
                 width: parent.width
@@ -1070,11 +1165,16 @@ You can change that in:<br/>Tools -> Preferences -> Network Remote"));
         // otherwise the Overlay would stay
         property bool disconnect: false
         property bool goSettings: false
+        property int  switchSession: -1
         onClosed: {
             if (disconnect)
                 cppRemote.disconnectFromServer();
             else if (goSettings)
                 openSettings();
+            else if (switchSession !== -1) {
+                cppRemote.switchToSession(switchSession);
+                switchSession = -1;
+            }
         }
 
 //        Overlay.modal: Rectangle {
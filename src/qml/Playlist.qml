@@ -68,6 +68,11 @@ Rectangle {
             }
         } // onClosedPlaylistsReceived
 
+        function onShowSong(proxyRow) { // hit of the search across the playlists
+            songsView.positionViewAtIndex(proxyRow, ListView.Center);
+            songsView.currentIndex = proxyRow;
+        }
+
         function onAskPlaylistDestID() {
             playlistChoiceDialog.text = qsTr("Please select a destination Playlist");
             playlistChoiceDialog.combo.model  = cppRemote.modelOpenedPlaylists();
@@ -115,6 +120,15 @@ Rectangle {
             playlistCombo.currentIndex = idx;
     } // updateCurrentPlaylist
 
+    function sortSongs(column) {
+        if (column === 0)
+            cppRemote.clearSongsSort();
+        else
+            cppRemote.sortSongs(column);
+        updateActiveSong(cppRemote.getActiveSongIndex());
+        songsView.positionViewAtIndex(activeSongIdx, ListView.Center);
+    }
+
     function downloadPlaylist() {
         if (mainApp.downloadPossible()) {
             cppRemote.setIsDownloading(true);
@@ -195,6 +209,18 @@ Rectangle {
         boundsMovement    : Flickable.FollowBoundsBehavior
         ScrollBar.vertical: ScrollBar {}
 //        onCurrentItemChanged: print("songsView current index: "+songsView.currentIndex)
+
+        // paged playlists: only the pages of the visible rows are requested
+        onContentYChanged: fetchVisibleSongs();
+        onCountChanged   : fetchVisibleSongs();
+        onHeightChanged  : fetchVisibleSongs();
+        function fetchVisibleSongs() {
+            if (count === 0)
+                return;
+            let first = indexAt(width / 2, contentY);
+            let last  = indexAt(width / 2, contentY + height - 1);
+            cppRemote.fetchVisibleSongs(first === -1 ? 0 : first, last === -1 ? count - 1 : last);
+        }
     } // songsView
 
 
@@ -474,6 +500,49 @@ Rectangle {
         } // songDelegateRect
     } // Component songDelegate
 
+    Dialog {
+        id: playlistsSearchDialog
+
+        width : playlist.width * 9/10
+        height: playlist.height * 3/4
+        x: (playlist.width - width) / 2
+        y: (playlist.height - height) / 2
+        parent: Overlay.overlay
+
+        title: qsTr("Search all Playlists")
+        focus: true
+        modal: true
+        standardButtons: Dialog.Close
+
+        onOpened: playlistsSearchField.forceActiveFocus();
+
+        ColumnLayout {
+            spacing: 10
+            anchors.fill: parent
+            SearchField {
+                id: playlistsSearchField
+                Layout.fillWidth: true
+                onTextChanged: cppRemote.searchPlaylists(text); // the index answers in a few ms
+            }
+            ListView {
+                id: playlistsSearchView
+                Layout.fillWidth : true
+                Layout.fillHeight: true
+                clip: true
+                model: cppRemote.modelPlaylistsSearch() // hits fetched by pages while scrolling
+                ScrollBar.vertical: ScrollBar {}
+                delegate: ItemDelegate {
+                    width: ListView.view.width
+                    text: "<b>" + title + "</b> - " + artist + "<br/><i>" + playlistName + "</i>"
+                    onClicked: {
+                        cppRemote.showPlaylistsSearchHit(index);
+                        playlistsSearchDialog.close();
+                    }
+                }
+            }
+        }
+    } // playlistsSearchDialog
+
     Dialog {
         id: playlistDestructionConfirmationDialog
 
@@ -652,6 +721,22 @@ Are you sure you want to continue?")
             text: qsTr("Download Playlist")
             onTriggered: downloadPlaylist();
         }
+        Action {
+            icon.source: "icons/search.png"
+            text: qsTr("Search all Playlists")
+            onTriggered: playlistsSearchDialog.open();
+        }
+        Menu {
+            title: qsTr("Sort by")
+            // column values of SongsSorter::Column (a 2nd click on the same column reverses the order)
+            Action { text: qsTr("Artist");         onTriggered: sortSongs(2); }
+            Action { text: qsTr("Album");          onTriggered: sortSongs(3); }
+            Action { text: qsTr("Title");          onTriggered: sortSongs(1); }
+            Action { text: qsTr("Track");          onTriggered: sortSongs(4); }
+            Action { text: qsTr("Length");         onTriggered: sortSongs(5); }
+            Action { text: qsTr("Rating");         onTriggered: sortSongs(6); }
+            Action { text: qsTr("Playlist order"); onTriggered: sortSongs(0); }
+        }
         MenuSeparator {}
         Action {
             icon.source: "icons/open.png"
@@ -91,7 +91,7 @@ Page {
             Rectangle {
                 id: playerSettings
                 width: parent.width
-                height: playerTitle.height + 3*switchHeight + iconSizeSB.height + 10*sectionMargin
+                height: playerTitle.height + 4*switchHeight + iconSizeSB.height + memoryThresholdSB.height + 14*sectionMargin
                 color: "transparent"
 
                 radius: 10
@@ -210,6 +210,56 @@ Page {
                     onToggled: cppRemote.setDelayLibraryLoading(checked);
                 } // dispArtistNameSwitch
 
+                Text {
+                    id: speculativeConnectLbl
+                    anchors {
+                        left: parent.left
+                        verticalCenter: speculativeConnectSwitch.verticalCenter
+                        leftMargin: sectionMargin
+                    }
+                    text: qsTr("Connect to the last session at launch")
+                } // speculativeConnectLbl
+                SettingSwitch{
+                    id: speculativeConnectSwitch
+                    anchors {
+                        right: parent.right
+                        top: loadLibrarySwitch.bottom
+                        topMargin: sectionMargin
+                        rightMargin: sectionMargin
+                    }
+                    width: switchWidth
+                    sliderSize: switchHeight
+
+                    checked: cppRemote.speculativeConnect()
+                    onToggled: cppRemote.setSpeculativeConnect(checked);
+                } // speculativeConnectSwitch
+
+                Text {
+                    id: memoryThresholdLbl
+                    anchors {
+                        left: parent.left
+                        verticalCenter: memoryThresholdSB.verticalCenter
+                        leftMargin: sectionMargin
+                    }
+                    text: qsTr("Free caches above (MB, 0: never)")
+                } // memoryThresholdLbl
+                SpinBox {
+                    id: memoryThresholdSB
+                    height: switchHeight+10
+                    anchors {
+                        right: parent.right
+                        top: speculativeConnectSwitch.bottom
+                        topMargin: sectionMargin
+                        rightMargin: sectionMargin
+                    }
+                    from: 0
+                    to:   4096
+                    stepSize: 64
+                    editable: true
+                    value: cppRemote.memoryThresholdMB()
+                    onValueModified: cppRemote.setMemoryThresholdMB(value);
+                } // memoryThresholdSB
+
             } // playerSettings
 
 //            MenuSeparator{ width: parent.width;}
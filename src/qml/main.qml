@@ -72,7 +72,10 @@ Window {
     }
 
 //    Component.onCompleted:  mainArea.sourceComponent = mainApp;
-    Component.onCompleted:  mainArea.sourceComponent = loginPage;
+    Component.onCompleted: {
+        mainArea.sourceComponent = loginPage;
+        cppRemote.attachUI(); // we may be already connected (speculative connection)
+    }
 
 
     Connections {
@@ -0,0 +1,398 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+
+#include "ClementineTests.h"
+#include "protobuf/remotecontrolmessages.pb.h"
+#include "utils/ServerDiscovery.h"
+#include "utils/PendingOperations.h"
+#include "player/PlaybackClock.h"
+#include "model/UpdateScheduler.h"
+#include <QtTest>
+#include <QDataStream>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QAbstractListModel>
+
+//! fake Clementine: answers the CONNECT of the probes with an INFO (or a DISCONNECT if authRequired)
+static void answerProbes(QTcpServer &server, bool authRequired)
+{
+    QObject::connect(&server, &QTcpServer::newConnection, &server, [&server, authRequired](){
+        QTcpSocket *client = server.nextPendingConnection();
+        QObject::connect(client, &QIODevice::readyRead, client, [client, authRequired](){
+            if (client->bytesAvailable() < 4)
+                return;
+            client->readAll(); // the CONNECT
+
+            pb::remote::Message msg;
+            if (authRequired)
+            {
+                msg.set_type(pb::remote::DISCONNECT);
+                msg.mutable_response_disconnect()->set_reason_disconnect(pb::remote::Wrong_Auth_Code);
+            }
+            else
+            {
+                msg.set_type(pb::remote::INFO);
+                msg.mutable_response_clementine_info()->set_version("Clementine 1.4.0");
+            }
+            std::string data = msg.SerializeAsString();
+            QDataStream s(client);
+            s << qint32(data.length());
+            s.writeRawData(data.data(), static_cast<int>(data.length()));
+        });
+    });
+}
+
+//! list of rows that can be inserted, removed and moved (for the UpdateScheduler)
+class RowsModel : public QAbstractListModel
+{
+public:
+    RowsModel(int nbRows) : QAbstractListModel(), _nbRows(nbRows) {}
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override { return parent.isValid() ? 0 : _nbRows; }
+    QVariant data(const QModelIndex &index, int) const override { return index.row(); }
+
+    void insert(int first, int nbRows)
+    {
+        beginInsertRows(QModelIndex(), first, first + nbRows - 1);
+        _nbRows += nbRows;
+        endInsertRows();
+    }
+    void remove(int first, int nbRows)
+    {
+        beginRemoveRows(QModelIndex(), first, first + nbRows - 1);
+        _nbRows -= nbRows;
+        endRemoveRows();
+    }
+    bool move(int first, int last, int destinationRow)
+    {
+        if (!beginMoveRows(QModelIndex(), first, last, QModelIndex(), destinationRow))
+            return false;
+        endMoveRows();
+        return true;
+    }
+
+private:
+    int _nbRows;
+};
+
+//! flushes the scheduler and returns the rows of the dataChanged emitted for the model
+static QList<QPair<int, int>> flushedRanges(UpdateScheduler &scheduler, QAbstractItemModel &model)
+{
+    QList<QPair<int, int>> ranges;
+    QMetaObject::Connection con = QObject::connect(&model, &QAbstractItemModel::dataChanged,
+                                                   [&ranges](const QModelIndex &topLeft, const QModelIndex &bottomRight){
+        ranges << qMakePair(topLeft.row(), bottomRight.row());
+    });
+    scheduler.flush();
+    QObject::disconnect(con);
+    return ranges;
+}
+
+ClementineTests::ClementineTests(QObject *parent):
+    QObject(parent)
+{}
+
+void ClementineTests::discoveryFindsServers_data()
+{
+    QTest::addColumn<bool>("authRequired");
+
+    QTest::newRow("no auth code") << false;
+    QTest::newRow("auth code")    << true;
+}
+
+void ClementineTests::discoveryFindsServers()
+{
+    QFETCH(bool, authRequired);
+
+    QTcpServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    answerProbes(server, authRequired);
+
+    ServerDiscovery discovery;
+    QSignalSpy found(&discovery, &ServerDiscovery::serverFound);
+    QSignalSpy finished(&discovery, &ServerDiscovery::finished);
+    // only 127.0.0.1 listens, the other loopback addresses refuse
+    discovery.scan(ServerDiscovery::hostRange(QHostAddress::LocalHost, 4), server.serverPort());
+
+    QTRY_COMPARE_WITH_TIMEOUT(finished.size(), 1, 5000);
+    QCOMPARE(found.size(), 1);
+    QCOMPARE(found.at(0).at(0).toString(), QString("127.0.0.1"));
+    QCOMPARE(found.at(0).at(1).value<ushort>(), server.serverPort());
+    QCOMPARE(found.at(0).at(3).toBool(), authRequired);
+    if (!authRequired)
+        QCOMPARE(found.at(0).at(2).toString(), QString("Clementine 1.4.0"));
+    QCOMPARE(finished.at(0).at(0).toInt(), 1);
+    QVERIFY(!discovery.isRunning());
+
+    QTest::qWait(ServerDiscovery::sHandshakeTimeoutMs + 100); // the timers of the probes
+    QCOMPARE(finished.size(), 1);
+}
+
+void ClementineTests::discoveryFinishedOnce()
+{
+    // a free port: every probe is refused, some of them synchronously within launchProbes
+    quint16 port = 0;
+    {
+        QTcpServer server;
+        QVERIFY(server.listen(QHostAddress::LocalHost));
+        port = server.serverPort();
+    }
+
+    ServerDiscovery discovery;
+    QSignalSpy found(&discovery, &ServerDiscovery::serverFound);
+    QSignalSpy finished(&discovery, &ServerDiscovery::finished);
+    int nbHosts = ServerDiscovery::sMaxConcurrentProbes + 44; // more than one wave of probes
+    discovery.scan(ServerDiscovery::hostRange(QHostAddress::LocalHost, nbHosts), port);
+
+    QTRY_COMPARE_WITH_TIMEOUT(finished.size(), 1, 5000);
+    QTest::qWait(ServerDiscovery::sConnectTimeoutMs + 100);
+    QCOMPARE(finished.size(), 1);
+    QCOMPARE(found.size(), 0);
+    QVERIFY(!discovery.isRunning());
+}
+
+void ClementineTests::pendingOperationsReconcile()
+{
+    typedef PendingOperations::Type Type;
+    typedef PendingOperations::Echo Echo;
+    PendingOperations ops;
+
+    // nothing sent: change from Clementine or another remote
+    QCOMPARE(ops.reconcile(Type::volume, 70), Echo::unsolicited);
+
+    // two quick changes: the echo of the first one mustn't bring the UI back
+    ops.add(Type::volume, 50, 40);
+    ops.add(Type::volume, 60, 50);
+    QCOMPARE(ops.reconcile(Type::volume, 50), Echo::superseded);
+    QCOMPARE(ops.reconcile(Type::volume, 60), Echo::confirmed);
+    QVERIFY(ops.isEmpty());
+
+    // the echo of the last one also drops the older ones
+    ops.add(Type::volume, 50, 40);
+    ops.add(Type::volume, 60, 50);
+    QCOMPARE(ops.reconcile(Type::volume, 60), Echo::confirmed);
+    QVERIFY(ops.isEmpty());
+
+    // the server answered something else: it wins, the whole chain is dropped
+    ops.add(Type::volume, 80, 70);
+    ops.add(Type::volume, 90, 80);
+    QCOMPARE(ops.reconcile(Type::volume, 75), Echo::diverged);
+    QVERIFY(ops.isEmpty());
+
+    // the types don't interfere
+    ops.add(Type::shuffle, 1, 0);
+    QCOMPARE(ops.reconcile(Type::repeat, 1), Echo::unsolicited);
+    QCOMPARE(ops.reconcile(Type::shuffle, 1), Echo::confirmed);
+    QVERIFY(ops.isEmpty());
+}
+
+void ClementineTests::pendingOperationsKeys()
+{
+    typedef PendingOperations::Type Type;
+    typedef PendingOperations::Echo Echo;
+    PendingOperations ops;
+
+    // removeSongs: the key is the playlist ID, the value the number of songs
+    ops.add(Type::removeSongs, 10, 12, 1);
+    ops.add(Type::removeSongs, 5, 12, 2);
+    QCOMPARE(ops.reconcile(Type::removeSongs, 5, 2), Echo::confirmed);
+    QVERIFY(!ops.isEmpty());
+    QCOMPARE(ops.reconcile(Type::removeSongs, 7, 3), Echo::unsolicited);
+    QCOMPARE(ops.reconcile(Type::removeSongs, 9, 1), Echo::diverged);
+    QVERIFY(ops.isEmpty());
+}
+
+void ClementineTests::pendingOperationsExpired()
+{
+    typedef PendingOperations::Type Type;
+    PendingOperations ops;
+
+    ops.add(Type::shuffle, 1, 0);
+    ops.add(Type::shuffle, 0, 1);
+    ops.add(Type::volume, 50, 40);
+    QVERIFY(ops.expired().isEmpty());
+
+    QTest::qWait(PendingOperations::sTimeoutMs + 100);
+    ops.add(Type::repeat, 1, 0); // still fresh
+    QList<PendingOperations::Operation> rollbacks = ops.expired();
+    QCOMPARE(rollbacks.size(), 2);
+    for (const PendingOperations::Operation &op : rollbacks)
+    {
+        if (op.type == Type::shuffle)
+            QCOMPARE(op.previous, 0); // the value before the chain
+        else
+            QCOMPARE(op.previous, 40);
+    }
+    QCOMPARE(ops.reconcile(Type::shuffle, 0), PendingOperations::Echo::unsolicited);
+    QCOMPARE(ops.reconcile(Type::repeat, 1), PendingOperations::Echo::confirmed);
+    QVERIFY(ops.isEmpty());
+}
+
+void ClementineTests::playbackClockPaused()
+{
+    PlaybackClock clock;
+    QVERIFY(!clock.isPlaying());
+    clock.addSample(42);
+    QCOMPARE(clock.positionMs(), qint64(42000));
+    QTest::qWait(50);
+    QCOMPARE(clock.positionMs(), qint64(42000));
+    QCOMPARE(clock.nbSamples(), 0); // no origin while paused
+
+    clock.setPlaying(true);
+    QTest::qWait(50);
+    clock.setPlaying(false); // freezes where we are
+    qint64 pausedMs = clock.positionMs();
+    QVERIFY(pausedMs >= 42050);
+    QTest::qWait(50);
+    QCOMPARE(clock.positionMs(), pausedMs);
+}
+
+void ClementineTests::playbackClockExtrapolates()
+{
+    PlaybackClock clock;
+    clock.setPlaying(true);
+    clock.reset(10000);
+    QTest::qWait(300);
+    qint64 posMs = clock.positionMs();
+    QVERIFY2(posMs >= 10300 && posMs < 11000, qPrintable(QString::number(posMs)));
+
+    clock.addSample(10); // the server is a bit behind (truncated): no jump back
+    QVERIFY(clock.positionMs() >= posMs);
+    QCOMPARE(clock.nbSamples(), 1);
+}
+
+void ClementineTests::playbackClockNeverGoesBack()
+{
+    PlaybackClock clock;
+    clock.setPlaying(true);
+    clock.reset(5700);
+    clock.addSample(5); // estimated origin 700 ms later than the displayed one
+
+    qint64 prevMs = clock.positionMs();
+    for (int i = 0; i < 20; ++i)
+    {
+        QTest::qWait(10);
+        qint64 posMs = clock.positionMs();
+        QVERIFY2(posMs >= prevMs, qPrintable(QString("%1 < %2").arg(posMs).arg(prevMs)));
+        prevMs = posMs;
+    }
+    QVERIFY(prevMs > 5700); // at least (100 - sMaxSlewPercent)% of the elapsed time
+}
+
+void ClementineTests::playbackClockSnaps()
+{
+    PlaybackClock clock;
+    clock.setPlaying(true);
+    clock.reset(0);
+    clock.addSample(0);
+    QCOMPARE(clock.nbSamples(), 1);
+
+    clock.addSample(60); // seek
+    QCOMPARE(clock.nbSamples(), 1); // the history of the previous position is useless
+    qint64 posMs = clock.positionMs();
+    QVERIFY2(posMs >= 60000 && posMs < 61000, qPrintable(QString::number(posMs)));
+    QCOMPARE(clock.jitterMs(), qint64(0));
+}
+
+void ClementineTests::updateSchedulerMerges()
+{
+    typedef QList<QPair<int, int>> Ranges;
+    RowsModel model(20);
+    UpdateScheduler scheduler;
+
+    scheduler.dataChanged(&model, 2, 4);
+    scheduler.dataChanged(&model, 5, 6); // adjacent
+    scheduler.dataChanged(&model, 3, 3); // inside
+    scheduler.dataChanged(&model, 10, 12);
+    scheduler.dataChanged(&model, 9, 9);
+    scheduler.dataChanged(&model, 15, 25); // partly beyond the rows
+    QCOMPARE(flushedRanges(scheduler, model), Ranges({{2, 6}, {9, 12}, {15, 19}}));
+    QCOMPARE(scheduler.nbRequested(), 6);
+    QCOMPARE(scheduler.nbEmitted(), 3);
+
+    QCOMPARE(flushedRanges(scheduler, model), Ranges()); // nothing pending anymore
+}
+
+void ClementineTests::updateSchedulerInsert()
+{
+    typedef QList<QPair<int, int>> Ranges;
+    RowsModel model(10);
+    UpdateScheduler scheduler;
+
+    scheduler.dataChanged(&model, 2, 4);
+    scheduler.dataChanged(&model, 8, 8);
+    model.insert(3, 2); // inside the first range: it covers the new rows
+    QCOMPARE(flushedRanges(scheduler, model), Ranges({{2, 6}, {10, 10}}));
+
+    scheduler.dataChanged(&model, 2, 4);
+    model.insert(0, 3); // before: shifted
+    model.insert(8, 1); // just after: untouched
+    QCOMPARE(flushedRanges(scheduler, model), Ranges({{5, 7}}));
+
+    scheduler.dataChanged(&model, 2, 4);
+    model.insert(2, 1); // on the first row: shifted
+    QCOMPARE(flushedRanges(scheduler, model), Ranges({{3, 5}}));
+}
+
+void ClementineTests::updateSchedulerRemove()
+{
+    typedef QList<QPair<int, int>> Ranges;
+    RowsModel model(20);
+    UpdateScheduler scheduler;
+
+    scheduler.dataChanged(&model, 2, 4);
+    scheduler.dataChanged(&model, 8, 9);
+    model.remove(3, 3); // rows 3 to 5: cuts the first range, shifts the second
+    QCOMPARE(flushedRanges(scheduler, model), Ranges({{2, 2}, {5, 6}}));
+
+    scheduler.dataChanged(&model, 1, 2);
+    scheduler.dataChanged(&model, 5, 6);
+    model.remove(3, 2); // the ranges become adjacent: merged
+    QCOMPARE(flushedRanges(scheduler, model), Ranges({{1, 4}}));
+
+    scheduler.dataChanged(&model, 1, 1);
+    scheduler.dataChanged(&model, 6, 7);
+    model.remove(6, 2); // the whole second range
+    QCOMPARE(flushedRanges(scheduler, model), Ranges({{1, 1}}));
+}
+
+void ClementineTests::updateSchedulerMove()
+{
+    typedef QList<QPair<int, int>> Ranges;
+    RowsModel model(12);
+    UpdateScheduler scheduler;
+
+    scheduler.dataChanged(&model, 0, 0);
+    scheduler.dataChanged(&model, 3, 3);
+    scheduler.dataChanged(&model, 9, 9);
+    QVERIFY(model.move(2, 3, 7)); // rows 2 and 3 after row 6: rows 2 to 6 move
+    QCOMPARE(flushedRanges(scheduler, model), Ranges({{0, 0}, {2, 6}, {9, 9}}));
+
+    scheduler.dataChanged(&model, 1, 1);
+    scheduler.dataChanged(&model, 8, 8);
+    QVERIFY(model.move(7, 8, 1)); // backward: rows 1 to 8 move
+    QCOMPARE(flushedRanges(scheduler, model), Ranges({{1, 8}}));
+
+    scheduler.dataChanged(&model, 10, 11);
+    QVERIFY(model.move(2, 3, 5)); // rows 2 to 4 move, not the pending ones
+    QCOMPARE(flushedRanges(scheduler, model), Ranges({{10, 11}}));
+}
+
+QTEST_GUILESS_MAIN(ClementineTests)
@@ -0,0 +1,59 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+
+#ifndef CLEMENTINETESTS_H
+#define CLEMENTINETESTS_H
+#include <QObject>
+
+/*!
+ * \brief QtTest unit tests of the core behaviours that the bench can't check
+ * (no server needed: the network ones use a loopback listener)
+ *
+ * ./clemremote-tests (or make check)
+ */
+class ClementineTests : public QObject
+{
+    Q_OBJECT
+
+public:
+    ClementineTests(QObject *parent = nullptr);
+    ~ClementineTests() = default;
+
+private slots:
+    void discoveryFindsServers_data();
+    void discoveryFindsServers(); //!< ServerDiscovery probe + CONNECT / INFO handshake on 127.0.0.x
+    void discoveryFinishedOnce(); //!< all the probes refused: a single finished
+
+    void pendingOperationsReconcile(); //!< echoes confirmed, superseded, diverged or unsolicited
+    void pendingOperationsKeys();      //!< the chains of removeSongs are per playlist
+    void pendingOperationsExpired();   //!< rollback to the value before the chain
+
+    void playbackClockPaused();       //!< the position of the samples, frozen
+    void playbackClockExtrapolates(); //!< moves with the local time between the samples
+    void playbackClockNeverGoesBack(); //!< slews toward a later origin (truncated samples)
+    void playbackClockSnaps();        //!< seek: jumps to the new position
+
+    void updateSchedulerMerges();   //!< adjacent and overlapping ranges emitted once
+    void updateSchedulerInsert();   //!< pending ranges shifted (or widened) by an insertion
+    void updateSchedulerRemove();   //!< pending ranges cut and shifted by a removal
+    void updateSchedulerMove();     //!< pending ranges widened to the moved span
+};
+
+#endif // CLEMENTINETESTS_H
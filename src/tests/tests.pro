@@ -0,0 +1,33 @@
+# clemremote-tests: QtTest unit tests of the core (no server needed)
+#   ./clemremote-tests
+QT += core network sql gui testlib
+QT -= quick
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TARGET = clemremote-tests
+
+# only for the DEFINES and INCLUDEPATH, the sources come from the core library
+include(../core.pri)
+
+LIBS += -L$$OUT_PWD/../core/ -lclemremotecore
+win32: PRE_TARGETDEPS += $$OUT_PWD/../core/clemremotecore.lib
+else:  PRE_TARGETDEPS += $$OUT_PWD/../core/libclemremotecore.a
+
+linux {
+    LIBS += -L$$PWD/../../protobuf-3.13.0/lib/x86_64/ -lprotobuf
+}
+macx{
+    LIBS += -L$$PWD/../../protobuf-3.13.0/lib/macx/ -lprotobuf
+    PRE_TARGETDEPS += $$PWD/../../protobuf-3.13.0/lib/macx/libprotobuf.a
+}
+win32{
+    LIBS += -L$$PWD/../../protobuf-3.13.0/lib/win64/ -lprotobuf
+}
+
+SOURCES += \
+        ClementineTests.cpp
+
+HEADERS += \
+    ClementineTests.h
@@ -0,0 +1,109 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "MemoryPressure.h"
+#include <QFile>
+#include <QDebug>
+#if defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+#include <unistd.h>
+#endif
+
+AtomicBool MemoryPressure::sLowMemoryRequested = 0x0;
+
+MemoryPressure::MemoryPressure(QObject *parent) :
+    QObject(parent),
+    _pollTimer(), _thresholdMB(0), _tier(Tier::none)
+{
+    _pollTimer.setInterval(sPollPeriodMs);
+    connect(&_pollTimer, &QTimer::timeout, this, &MemoryPressure::onPoll);
+}
+
+void MemoryPressure::setThresholdMB(int thresholdMB)
+{
+    _thresholdMB = thresholdMB;
+    bool poll = _thresholdMB > 0 && residentBytes() != -1;
+#if defined(Q_OS_ANDROID)
+    poll = true; // for the requestLowMemory of onTrimMemory
+#endif
+    if (poll)
+        _pollTimer.start();
+    else
+        _pollTimer.stop();
+    qDebug() << "[MemoryPressure::setThresholdMB] " << _thresholdMB << " MB (polling: " << _pollTimer.isActive() << ")";
+}
+
+qint64 MemoryPressure::residentBytes()
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly))
+        return -1;
+    // size resident shared text lib data dt (in pages)
+    QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2)
+        return -1;
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return -1;
+#endif
+}
+
+void MemoryPressure::notifyLowMemory()
+{
+    qDebug() << "[MemoryPressure::notifyLowMemory]";
+    _tier = Tier::library;
+    emit shed(_tier);
+}
+
+void MemoryPressure::requestLowMemory() { sLowMemoryRequested = 0x1; }
+
+void MemoryPressure::simulate(Tier tier)
+{
+    qDebug() << "[MemoryPressure::simulate] tier " << static_cast<ushort>(tier);
+    _tier = tier;
+    if (tier != Tier::none)
+        emit shed(tier);
+}
+
+void MemoryPressure::onPoll()
+{
+    if (sLowMemoryRequested.testAndSetRelaxed(0x1, 0x0))
+    {
+        notifyLowMemory();
+        return;
+    }
+    if (_thresholdMB <= 0)
+        return;
+
+    qint64 rssMB = residentBytes() / (1024 * 1024);
+    if (rssMB > _thresholdMB)
+    {
+        if (_tier == Tier::library)
+            return; // nothing more to drop
+        _tier = static_cast<Tier>(static_cast<ushort>(_tier) + 1);
+        qDebug() << "[MemoryPressure::onPoll] RSS: " << rssMB << " MB > " << _thresholdMB
+                 << " MB => dropping tier " << static_cast<ushort>(_tier);
+        emit shed(_tier);
+    }
+    else if (_tier != Tier::none && rssMB * 100 < _thresholdMB * sReleasePct)
+    {
+        qDebug() << "[MemoryPressure::onPoll] RSS: " << rssMB << " MB, pressure released";
+        _tier = Tier::none;
+    }
+}
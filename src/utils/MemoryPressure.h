@@ -0,0 +1,74 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef MEMORYPRESSURE_H
+#define MEMORYPRESSURE_H
+#include "Macro.h"
+#include <QObject>
+#include <QTimer>
+
+/*!
+ * \brief decides which caches should be dropped when memory gets scarce
+ * either on a low memory notification of the OS (notifyLowMemory, or requestLowMemory from its threads)
+ * or when the resident memory goes above a threshold (polled on Linux and Android)
+ * The tiers are dropped in order, one more at each poll while we stay above the threshold.
+ * They're rebuilt by their owner on the next access.
+ */
+class MemoryPressure : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Tier : ushort {none = 0, sortKeys, offscreenPlaylists, library};
+
+    static const int sPollPeriodMs = 5000;
+    static const int sReleasePct   = 80; //!< back to Tier::none below that percentage of the threshold
+
+    explicit MemoryPressure(QObject *parent = nullptr);
+    ~MemoryPressure() = default;
+
+    void setThresholdMB(int thresholdMB); //!< 0 to stop polling
+    inline int thresholdMB() const;
+    inline Tier tier() const;
+
+    static qint64 residentBytes(); //!< -1 if not available on this platform
+
+    void notifyLowMemory();   //!< drops all the tiers
+    //! from any thread (Android onTrimMemory): only sets a flag, handled at the next poll (always polling on Android)
+    static void requestLowMemory();
+    void simulate(Tier tier); //!< test hook: as if we reached that tier
+
+signals:
+    void shed(MemoryPressure::Tier tier); //!< drop the tiers up to this one (included)
+
+private slots:
+    void onPoll();
+
+private:
+    static AtomicBool sLowMemoryRequested;
+
+    QTimer _pollTimer;
+    int    _thresholdMB;
+    Tier   _tier; //!< last tier dropped since we went above the threshold
+};
+
+int MemoryPressure::thresholdMB() const { return _thresholdMB; }
+MemoryPressure::Tier MemoryPressure::tier() const { return _tier; }
+
+#endif // MEMORYPRESSURE_H
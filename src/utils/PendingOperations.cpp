@@ -0,0 +1,156 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "PendingOperations.h"
+#ifdef __USE_CONNECTION_THREAD__
+#include <QMutexLocker>
+#endif
+
+static const char *sTypeNames[] = {"engineState", "volume", "shuffle", "repeat", "activeSong", "removeSongs"};
+
+PendingOperations::PendingOperations():
+#ifdef __USE_CONNECTION_THREAD__
+    _mutex(),
+#endif
+    _clock(), _lastId(0),
+    _pending(static_cast<int>(Type::nbTypes)),
+    _nbConfirmed(0), _nbDiverged(0), _nbTimedOut(0), _nbUnsolicited(0),
+    _sumConfirmationMs(0),
+    _nbDivergedByType(static_cast<int>(Type::nbTypes), 0)
+{
+    _clock.start();
+}
+
+quint32 PendingOperations::add(Type type, qint32 expected, qint32 previous, qint32 key)
+{
+#ifdef __USE_CONNECTION_THREAD__
+    QMutexLocker lock(&_mutex);
+#endif
+    _pending[static_cast<int>(type)] << Operation{++_lastId, type, key, expected, previous, _clock.elapsed()};
+    return _lastId;
+}
+
+PendingOperations::Echo PendingOperations::reconcile(Type type, qint32 value, qint32 key)
+{
+#ifdef __USE_CONNECTION_THREAD__
+    QMutexLocker lock(&_mutex);
+#endif
+    QList<Operation> &ops = _pending[static_cast<int>(type)];
+    int nbOps = 0, matchIdx = -1;
+    for (int i = 0; i < ops.size(); ++i)
+    {
+        if (ops.at(i).key != key)
+            continue;
+        ++nbOps;
+        if (ops.at(i).expected == value)
+        {
+            matchIdx = i;
+            break;
+        }
+    }
+
+    if (nbOps == 0)
+    {
+        ++_nbUnsolicited;
+        return Echo::unsolicited;
+    }
+
+    if (matchIdx == -1)
+    {
+        // the server state wins, drop the whole chain
+        for (auto it = ops.begin(); it != ops.end(); )
+            it = it->key == key ? ops.erase(it) : it + 1;
+        ++_nbDiverged;
+        ++_nbDivergedByType[static_cast<int>(type)];
+        return Echo::diverged;
+    }
+
+    _sumConfirmationMs += _clock.elapsed() - ops.at(matchIdx).sentMs;
+    ++_nbConfirmed;
+    for (int i = matchIdx; i >= 0; --i)
+    {
+        if (ops.at(i).key == key)
+            ops.removeAt(i);
+    }
+    for (const Operation &op : ops)
+    {
+        if (op.key == key)
+            return Echo::superseded;
+    }
+    return Echo::confirmed;
+}
+
+QList<PendingOperations::Operation> PendingOperations::expired()
+{
+#ifdef __USE_CONNECTION_THREAD__
+    QMutexLocker lock(&_mutex);
+#endif
+    QList<Operation> rollbacks;
+    qint64 now = _clock.elapsed();
+    for (QList<Operation> &ops : _pending)
+    {
+        while (!ops.isEmpty() && now - ops.first().sentMs > sTimeoutMs)
+        {
+            Operation first = ops.takeFirst();
+            for (auto it = ops.begin(); it != ops.end(); )
+                it = it->key == first.key ? ops.erase(it) : it + 1;
+            rollbacks << first;
+            ++_nbTimedOut;
+        }
+    }
+    return rollbacks;
+}
+
+bool PendingOperations::isEmpty() const
+{
+#ifdef __USE_CONNECTION_THREAD__
+    QMutexLocker lock(&_mutex);
+#endif
+    for (const QList<Operation> &ops : _pending)
+    {
+        if (!ops.isEmpty())
+            return false;
+    }
+    return true;
+}
+
+void PendingOperations::clear()
+{
+#ifdef __USE_CONNECTION_THREAD__
+    QMutexLocker lock(&_mutex);
+#endif
+    for (QList<Operation> &ops : _pending)
+        ops.clear();
+}
+
+QString PendingOperations::stats() const
+{
+#ifdef __USE_CONNECTION_THREAD__
+    QMutexLocker lock(&_mutex);
+#endif
+    QString str = QString("confirmed: %1 (avg %2 ms), diverged: %3, timed out: %4, unsolicited: %5").arg(
+                _nbConfirmed).arg(_nbConfirmed ? _sumConfirmationMs / _nbConfirmed : 0).arg(
+                _nbDiverged).arg(_nbTimedOut).arg(_nbUnsolicited);
+    for (int t = 0; t < _nbDivergedByType.size(); ++t)
+    {
+        if (_nbDivergedByType.at(t))
+            str += QString(", %1 diverged: %2").arg(sTypeNames[t]).arg(_nbDivergedByType.at(t));
+    }
+    return str;
+}
@@ -0,0 +1,95 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef PENDINGOPERATIONS_H
+#define PENDINGOPERATIONS_H
+#include <QList>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QString>
+#ifdef __USE_CONNECTION_THREAD__
+#include <QMutex>
+#endif
+
+/*!
+ * \brief Bookkeeping of the user requests already applied locally (optimistic UI)
+ * but not yet echoed by the server.
+ * Each request gets an id, the value expected in the echo and the one to restore on rollback.
+ * The echoes are reconciled in FIFO order per type of operation:
+ *   - confirmed: the echo matches a pending value (the older ones are dropped as well)
+ *   - superseded: idem but newer requests are still pending (the UI shouldn't go back to the echo)
+ *   - diverged: the server answered something else, it wins
+ *   - unsolicited: nothing was pending (change from Clementine or another remote)
+ * The echoes are received by the ConnectionWorker thread so it is protected by a mutex.
+ */
+class PendingOperations
+{
+public:
+    enum class Type : ushort {engineState = 0, volume, shuffle, repeat, activeSong, removeSongs, nbTypes};
+    enum class Echo : ushort {unsolicited = 0, confirmed, superseded, diverged};
+
+    typedef struct Operation
+    {
+        quint32 id;
+        Type    type;
+        qint32  key;      //!< to distinguish operations of the same type (playlist ID for removeSongs)
+        qint32  expected; //!< value expected in the echo of the server
+        qint32  previous; //!< value to restore on rollback
+        qint64  sentMs;
+    } Operation;
+
+    static const int sTimeoutMs = 2000; //!< no echo after that: rollback
+
+    PendingOperations();
+    ~PendingOperations() = default;
+
+    PendingOperations(const PendingOperations &) = delete;
+    PendingOperations &operator=(const PendingOperations &) = delete;
+
+    quint32 add(Type type, qint32 expected, qint32 previous, qint32 key = -1);
+
+    Echo reconcile(Type type, qint32 value, qint32 key = -1);
+
+    //! removes the chains of operations that are waiting for too long
+    //! and returns their first operation (holding the value before the chain)
+    QList<Operation> expired();
+
+    bool isEmpty() const;
+    void clear(); //!< (keeps the statistics)
+
+    QString stats() const;
+
+private:
+#ifdef __USE_CONNECTION_THREAD__
+    mutable QMutex _mutex;
+#endif
+    QElapsedTimer _clock;
+    quint32       _lastId;
+
+    QVector<QList<Operation>> _pending; //!< by Type, oldest first
+
+    quint32 _nbConfirmed;
+    quint32 _nbDiverged;
+    quint32 _nbTimedOut;
+    quint32 _nbUnsolicited;
+    qint64  _sumConfirmationMs;
+    QVector<quint32> _nbDivergedByType;
+};
+
+#endif // PENDINGOPERATIONS_H
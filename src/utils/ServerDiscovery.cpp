@@ -0,0 +1,223 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "ServerDiscovery.h"
+#include "Utf8.h"
+#include "protobuf/remotecontrolmessages.pb.h"
+#include <QTcpSocket>
+#include <QNetworkInterface>
+#include <QDataStream>
+#include <QTimer>
+#include <QDebug>
+
+ServerDiscovery::ServerDiscovery(QObject *parent) :
+    QObject(parent),
+    _hosts(), _nextHost(0), _port(0),
+    _probes(),
+    _nbServers(0), _scanTime(),
+    _launching(false), _finished(true)
+{}
+
+ServerDiscovery::~ServerDiscovery()
+{
+    stop();
+}
+
+void ServerDiscovery::start(ushort port)
+{
+    scan(localSubnetHosts(), port);
+}
+
+void ServerDiscovery::scan(const QList<QHostAddress> &hosts, ushort port)
+{
+    stop();
+
+    _hosts     = hosts;
+    _nextHost  = 0;
+    _port      = port;
+    _nbServers = 0;
+    _finished  = false;
+    _scanTime.start();
+    qDebug() << "[ServerDiscovery::scan] " << hosts.size() << " hosts on port " << port;
+
+    if (_hosts.isEmpty())
+    {
+        _finished = true;
+        emit finished(0, 0);
+    }
+    else
+        launchProbes();
+}
+
+void ServerDiscovery::stop()
+{
+    _finished = true; // aborted: no finished signal
+    _nextHost = _hosts.size();
+    const QList<QTcpSocket*> probes = _probes.keys();
+    _probes.clear();
+    for (QTcpSocket *probe : probes)
+    {
+        probe->disconnect(this);
+        probe->abort();
+        probe->deleteLater();
+    }
+}
+
+QList<QHostAddress> ServerDiscovery::localSubnetHosts()
+{
+    QList<QHostAddress> hosts;
+    for (const QNetworkInterface &itf : QNetworkInterface::allInterfaces())
+    {
+        QNetworkInterface::InterfaceFlags flags = itf.flags();
+        if (!flags.testFlag(QNetworkInterface::IsUp) || !flags.testFlag(QNetworkInterface::IsRunning)
+                || flags.testFlag(QNetworkInterface::IsLoopBack))
+            continue;
+
+        for (const QNetworkAddressEntry &entry : itf.addressEntries())
+        {
+            if (entry.ip().protocol() != QAbstractSocket::IPv4Protocol)
+                continue;
+
+            int prefix = qMax(entry.prefixLength(), 24); // bigger subnets are limited to our /24
+            if (prefix > 30)
+                continue;
+
+            quint32 ip   = entry.ip().toIPv4Address();
+            quint32 base = ip & (0xFFFFFFFF << (32 - prefix));
+            quint32 nbHosts = (1u << (32 - prefix)) - 2; // without network and broadcast addresses
+            for (quint32 host = base + 1; host <= base + nbHosts; ++host)
+            {
+                if (host != ip)
+                    hosts << QHostAddress(host);
+            }
+        }
+    }
+    return hosts;
+}
+
+QList<QHostAddress> ServerDiscovery::hostRange(const QHostAddress &first, int nbHosts)
+{
+    QList<QHostAddress> hosts;
+    quint32 ip = first.toIPv4Address();
+    for (int i = 0; i < nbHosts; ++i)
+        hosts << QHostAddress(ip + static_cast<quint32>(i));
+    return hosts;
+}
+
+void ServerDiscovery::launchProbes()
+{
+    _launching = true;
+    while (_probes.size() < sMaxConcurrentProbes && _nextHost < _hosts.size())
+    {
+        QTcpSocket *probe = new QTcpSocket(this);
+        _probes.insert(probe, QByteArray());
+
+        connect(probe, &QAbstractSocket::connected, this, [this, probe](){ onProbeConnected(probe); });
+        connect(probe, &QIODevice::readyRead,       this, [this, probe](){ onProbeReadyRead(probe); });
+        // covers the errors (refused, unreachable...) and the disconnections
+        connect(probe, &QAbstractSocket::stateChanged, this, [this, probe](QAbstractSocket::SocketState state){
+            if (state == QAbstractSocket::UnconnectedState)
+                closeProbe(probe);
+        });
+        QTimer::singleShot(sConnectTimeoutMs, probe, [this, probe](){
+            if (probe->state() != QAbstractSocket::ConnectedState)
+                closeProbe(probe);
+        });
+
+        probe->connectToHost(_hosts.at(_nextHost++), _port);
+    }
+    _launching = false;
+}
+
+void ServerDiscovery::onProbeConnected(QTcpSocket *probe)
+{
+    QTimer::singleShot(sHandshakeTimeoutMs, probe, [this, probe](){ closeProbe(probe); });
+
+    pb::remote::Message msg;
+    msg.set_type(pb::remote::CONNECT);
+    msg.set_version(msg.default_instance().version());
+    msg.mutable_request_connect()->set_send_playlist_songs(false);
+
+    std::string data = msg.SerializeAsString();
+    QDataStream s(probe);
+    s << qint32(data.length());
+    s.writeRawData(data.data(), static_cast<int>(data.length()));
+}
+
+void ServerDiscovery::onProbeReadyRead(QTcpSocket *probe)
+{
+    auto it = _probes.find(probe);
+    if (it == _probes.end())
+        return;
+
+    QByteArray &buffer = it.value();
+    buffer.append(probe->readAll());
+    if (buffer.size() < 4)
+        return;
+
+    qint32 length = 0;
+    QDataStream s(buffer);
+    s >> length;
+    if (length <= 0 || length > sMaxHandshakeSize)
+    {
+        closeProbe(probe); // not a Clementine
+        return;
+    }
+    if (buffer.size() < 4 + length)
+        return;
+
+    pb::remote::Message msg;
+    if (msg.ParseFromArray(buffer.constData() + 4, length))
+    {
+        QString host = probe->peerAddress().toString();
+        if (msg.type() == pb::remote::INFO)
+        {
+            ++_nbServers;
+            emit serverFound(host, _port, Utf8::toQString(msg.response_clementine_info().version()), false);
+        }
+        else if (msg.type() == pb::remote::DISCONNECT)
+        {
+            ++_nbServers;
+            emit serverFound(host, _port, QString(), true);
+        }
+        qDebug() << "[ServerDiscovery::onProbeReadyRead] " << host << " answered msg type: " << msg.type()
+                 << " after " << _scanTime.elapsed() << " ms";
+    }
+    closeProbe(probe);
+}
+
+void ServerDiscovery::closeProbe(QTcpSocket *probe)
+{
+    if (!_probes.remove(probe))
+        return; // already closed
+
+    probe->disconnect(this);
+    probe->abort();
+    probe->deleteLater();
+
+    if (!_launching)
+        launchProbes();
+    if (!isRunning() && !_finished)
+    {
+        _finished = true;
+        qDebug() << "[ServerDiscovery::closeProbe] scan finished: " << _nbServers << " server(s) in "
+                 << _scanTime.elapsed() << " ms";
+        emit finished(_nbServers, _scanTime.elapsed());
+    }
+}
@@ -0,0 +1,86 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef SERVERDISCOVERY_H
+#define SERVERDISCOVERY_H
+#include <QObject>
+#include <QHostAddress>
+#include <QHash>
+#include <QList>
+#include <QByteArray>
+#include <QElapsedTimer>
+class QTcpSocket;
+
+/*!
+ * \brief Finds the Clementine servers of the LAN
+ * by probing each host with a non blocking connect (hundreds at once, short timeouts).
+ * The hosts that accept the connection are fingerprinted with the CONNECT / INFO handshake:
+ *   - INFO: Clementine without auth code (we get its version)
+ *   - DISCONNECT: Clementine with an auth code
+ * The servers are signaled as soon as they're identified.
+ */
+class ServerDiscovery : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int sMaxConcurrentProbes = 256;
+    static const int sConnectTimeoutMs    = 250; //!< we're on the LAN...
+    static const int sHandshakeTimeoutMs  = 750;
+    static const int sMaxHandshakeSize    = 65536; //!< the INFO is small, it's not a Clementine otherwise
+
+    explicit ServerDiscovery(QObject *parent = nullptr);
+    ~ServerDiscovery();
+
+    void start(ushort port); //!< scan the local subnets
+    void scan(const QList<QHostAddress> &hosts, ushort port);
+    void stop();
+
+    inline bool isRunning() const;
+
+    //! the /24 of each IPv4 interface (except our own address)
+    static QList<QHostAddress> localSubnetHosts();
+    //! consecutive IPv4 addresses (handy to use loopback aliases 127.0.0.x)
+    static QList<QHostAddress> hostRange(const QHostAddress &first, int nbHosts);
+
+signals:
+    void serverFound(const QString &host, ushort port, const QString &version, bool authRequired);
+    void finished(int nbServers, qint64 elapsedMs);
+
+private:
+    void launchProbes();
+    void onProbeConnected(QTcpSocket *probe);
+    void onProbeReadyRead(QTcpSocket *probe);
+    void closeProbe(QTcpSocket *probe);
+
+    QList<QHostAddress> _hosts;
+    int                 _nextHost;
+    ushort              _port;
+
+    QHash<QTcpSocket*, QByteArray> _probes; //!< with the data received
+
+    int           _nbServers;
+    QElapsedTimer _scanTime;
+    bool          _launching; //!< a failing connectToHost can close its probe synchronously (no relaunch then)
+    bool          _finished;  //!< finished is emitted only once per scan
+};
+
+bool ServerDiscovery::isRunning() const { return _probes.size() || _nextHost < _hosts.size(); }
+
+#endif // SERVERDISCOVERY_H
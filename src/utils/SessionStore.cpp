@@ -0,0 +1,175 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "SessionStore.h"
+
+const QList<pb::remote::MsgType> SessionStore::sReplayOrder = {
+    pb::remote::INFO,
+    pb::remote::CURRENT_METAINFO,
+    pb::remote::PLAY, // engine state
+    pb::remote::SET_VOLUME,
+    pb::remote::PLAYLISTS,
+    pb::remote::ACTIVE_PLAYLIST_CHANGED,
+    pb::remote::SHUFFLE,
+    pb::remote::REPEAT,
+    pb::remote::UPDATE_TRACK_POSITION
+};
+
+SessionStore::SessionStore() :
+#ifdef __USE_CONNECTION_THREAD__
+    _mutex(),
+#endif
+    _states(), _playlistSongs(), _playlistSongsOrder(), _playlistSongsBytes(0), _activePlaylistID(-1)
+{}
+
+void SessionStore::record(const pb::remote::Message &msg, const QByteArray &frame)
+{
+#ifdef __USE_CONNECTION_THREAD__
+    QMutexLocker lock(&_mutex);
+#endif
+    switch (msg.type()) {
+    case pb::remote::INFO:
+    case pb::remote::CURRENT_METAINFO:
+    case pb::remote::SET_VOLUME:
+    case pb::remote::SHUFFLE:
+    case pb::remote::REPEAT:
+    case pb::remote::UPDATE_TRACK_POSITION:
+        _states[msg.type()] = frame;
+        break;
+
+    case pb::remote::PLAY:
+    case pb::remote::PAUSE:
+    case pb::remote::STOP:
+        _states[pb::remote::PLAY] = frame;
+        break;
+
+    case pb::remote::PLAYLISTS:
+        if (msg.response_playlists().has_include_closed() && msg.response_playlists().include_closed())
+            break; // asked by the user, not a state
+        _states[pb::remote::PLAYLISTS] = frame;
+        for (const auto &playlist : msg.response_playlists().playlist())
+        {
+            if (playlist.active())
+                _activePlaylistID = playlist.id();
+        }
+        break;
+
+    case pb::remote::ACTIVE_PLAYLIST_CHANGED:
+        _states[pb::remote::ACTIVE_PLAYLIST_CHANGED] = frame;
+        _activePlaylistID = msg.response_active_changed().id();
+        break;
+
+    case pb::remote::PLAYLIST_SONGS:
+    {
+        if (msg.response_playlist_songs().has_offset()) // pages and song details are not kept
+            break;
+        qint32 playlistID = msg.response_playlist_songs().requested_playlist().id();
+        removePlaylistSongs(playlistID);
+        _playlistSongs.insert(playlistID, frame);
+        _playlistSongsOrder << playlistID;
+        _playlistSongsBytes += frame.size();
+        const qint64 maxBytes = sMaxPlaylistSongsMB * 1024LL * 1024LL;
+        for (int i = 0 ; _playlistSongsBytes > maxBytes && i < _playlistSongsOrder.size() ; )
+        {
+            qint32 oldestID = _playlistSongsOrder.at(i);
+            if (oldestID == _activePlaylistID || oldestID == playlistID)
+                ++i;
+            else
+                removePlaylistSongs(oldestID);
+        }
+        break;
+    }
+
+    case pb::remote::PLAYLIST_DELTA:
+        removePlaylistSongs(msg.response_playlist_delta().playlist_id());
+        break;
+
+    default:
+        break;
+    }
+}
+
+void SessionStore::clear()
+{
+#ifdef __USE_CONNECTION_THREAD__
+    QMutexLocker lock(&_mutex);
+#endif
+    _states.clear();
+    _playlistSongs.clear();
+    _playlistSongsOrder.clear();
+    _playlistSongsBytes = 0;
+    _activePlaylistID = -1;
+}
+
+void SessionStore::retainPlaylistSongs(const QSet<qint32> &playlistIDs)
+{
+#ifdef __USE_CONNECTION_THREAD__
+    QMutexLocker lock(&_mutex);
+#endif
+    const QList<qint32> storedIDs = _playlistSongsOrder;
+    for (qint32 playlistID : storedIDs)
+    {
+        if (playlistID != _activePlaylistID && !playlistIDs.contains(playlistID))
+            removePlaylistSongs(playlistID);
+    }
+}
+
+void SessionStore::removePlaylistSongs(qint32 playlistID)
+{
+    auto it = _playlistSongs.find(playlistID);
+    if (it == _playlistSongs.end())
+        return;
+    _playlistSongsBytes -= it.value().size();
+    _playlistSongs.erase(it);
+    _playlistSongsOrder.removeOne(playlistID);
+}
+
+QList<QByteArray> SessionStore::frames() const
+{
+#ifdef __USE_CONNECTION_THREAD__
+    QMutexLocker lock(&_mutex);
+#endif
+    QList<QByteArray> frames;
+    for (pb::remote::MsgType msgType : sReplayOrder)
+    {
+        auto it = _states.constFind(msgType);
+        if (it != _states.cend())
+            frames << it.value();
+    }
+    for (auto it = _playlistSongs.cbegin(); it != _playlistSongs.cend(); ++it)
+    {
+        if (it.key() != _activePlaylistID)
+            frames << it.value();
+    }
+    auto itActive = _playlistSongs.constFind(_activePlaylistID);
+    if (itActive != _playlistSongs.cend())
+        frames << itActive.value();
+    return frames;
+}
+
+qint64 SessionStore::memoryUsage() const
+{
+#ifdef __USE_CONNECTION_THREAD__
+    QMutexLocker lock(&_mutex);
+#endif
+    qint64 size = 0;
+    for (const QByteArray &frame : _states)
+        size += frame.size();
+    return size + _playlistSongsBytes;
+}
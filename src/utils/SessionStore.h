@@ -0,0 +1,78 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef SESSIONSTORE_H
+#define SESSIONSTORE_H
+#include "protobuf/remotecontrolmessages.pb.h"
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#ifdef __USE_CONNECTION_THREAD__
+#include <QMutex>
+#endif
+
+/*!
+ * \brief Latest state of a Clementine server as the raw frames received
+ * (implicitly shared with the reception buffer, so recording is almost free)
+ * Only the messages that describe the state are kept (the last one of each type)
+ * and the PLAYLIST_SONGS of each playlist (dropped when a PLAYLIST_DELTA makes it outdated).
+ * Those are bounded to sMaxPlaylistSongsMB and follow the PlaylistSongsCache (retainPlaylistSongs)
+ * Replaying the frames() through ClementineRemote::parseMessage rebuilds the whole state
+ * without any request to the server (switch between the sessions of the multi-room)
+ * It is fed by the ConnectionWorker thread so it is protected by a mutex.
+ */
+class SessionStore
+{
+public:
+    static const int sMaxPlaylistSongsMB = 16; //!< the oldest frames are dropped (never the active playlist)
+
+    SessionStore();
+    ~SessionStore() = default;
+
+    SessionStore(const SessionStore &) = delete;
+    SessionStore &operator=(const SessionStore &) = delete;
+
+    void record(const pb::remote::Message &msg, const QByteArray &frame);
+    void clear();
+    //! drops the PLAYLIST_SONGS of the playlists that are not given (evicted from the cache)
+    void retainPlaylistSongs(const QSet<qint32> &playlistIDs);
+
+    //! in the order of the initial data of a connection, the active playlist songs last
+    QList<QByteArray> frames() const;
+
+    qint64 memoryUsage() const; //!< in bytes
+
+private:
+#ifdef __USE_CONNECTION_THREAD__
+    mutable QMutex _mutex;
+#endif
+    QHash<int, QByteArray>    _states;        //!< by MsgType (PLAY for the engine state)
+    QHash<qint32, QByteArray> _playlistSongs; //!< by playlist ID
+    QList<qint32>             _playlistSongsOrder; //!< oldest first
+    qint64                    _playlistSongsBytes;
+    qint32                    _activePlaylistID;
+
+    static const QList<pb::remote::MsgType> sReplayOrder;
+
+private:
+    void removePlaylistSongs(qint32 playlistID); //!< _mutex must be locked
+};
+
+#endif // SESSIONSTORE_H
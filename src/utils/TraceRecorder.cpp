@@ -0,0 +1,174 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "TraceRecorder.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QFile>
+#include <QByteArrayList>
+#include <QDebug>
+#include <atomic>
+
+//! an Event behind a sequence number (odd while it is written)
+typedef struct TraceSlot
+{
+    QAtomicInteger<quint32>    seq;
+    QAtomicPointer<const char> name;
+    QAtomicInteger<qint64>     startUs;
+    QAtomicInteger<qint64>     durationUs;
+} TraceSlot;
+
+struct TraceRecorder::Ring
+{
+    qint64  tid;
+    QString threadName;
+    AtomicBool              inUse; //!< false once its thread is finished
+    QAtomicInteger<quint32> head;  //!< number of events written (wraps around)
+    TraceSlot eventSlots[sRingSize];
+};
+
+struct TraceRecorder::RingHandle
+{
+    Ring *ring = nullptr;
+    ~RingHandle()
+    {
+        if (ring)
+            ring->inUse.storeRelease(0x0);
+    }
+};
+
+static QElapsedTimer startedClock()
+{
+    QElapsedTimer clock;
+    clock.start();
+    return clock;
+}
+
+AtomicBool                   TraceRecorder::sEnabled = 0x0;
+QAtomicInteger<qint64>       TraceRecorder::sEnabledSinceUs = 0;
+const QElapsedTimer          TraceRecorder::sClock = startedClock();
+QMutex                       TraceRecorder::sRingsMutex;
+QList<TraceRecorder::Ring*>  TraceRecorder::sRings;
+qint64                       TraceRecorder::sNextTid = 1;
+thread_local TraceRecorder::RingHandle TraceRecorder::tRing;
+
+void TraceRecorder::setEnabled(bool enabled)
+{
+    if (enabled)
+        sEnabledSinceUs.storeRelease(nowUs());
+    sEnabled = enabled ? 0x1 : 0x0;
+    qDebug() << "[TraceRecorder::setEnabled] " << enabled;
+}
+
+TraceRecorder::Ring *TraceRecorder::newRing()
+{
+    QThread *thread = QThread::currentThread();
+    QString threadName;
+    if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+        threadName = "GUI";
+    else
+        threadName = thread->objectName();
+
+    QMutexLocker lock(&sRingsMutex); // also held by chromeTrace: no export while we reset a ring
+    Ring *ring = nullptr;
+    for (Ring *released : qAsConst(sRings))
+    {
+        if (!released->inUse.loadAcquire())
+        {
+            ring = released; // its events are dropped (the thread of the pool is gone)
+            break;
+        }
+    }
+    if (!ring)
+    {
+        ring = new Ring;
+        sRings << ring;
+    }
+    ring->tid        = sNextTid++;
+    ring->threadName = threadName.isEmpty() ? QString("thread %1").arg(ring->tid) : threadName;
+    ring->inUse      = 0x1;
+    ring->head       = 0;
+    return ring;
+}
+
+void TraceRecorder::record(const char *name, qint64 startUs)
+{
+    Ring *ring = tRing.ring;
+    if (!ring)
+        ring = tRing.ring = newRing();
+
+    quint32 head = M_LoadAtomic(ring->head);
+    TraceSlot &slot = ring->eventSlots[head & (sRingSize - 1)];
+    quint32 seq = M_LoadAtomic(slot.seq);
+    slot.seq.storeRelaxed(seq + 1); // odd: being written
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.storeRelaxed(name);
+    slot.startUs.storeRelaxed(startUs);
+    slot.durationUs.storeRelaxed(nowUs() - startUs);
+    slot.seq.storeRelease(seq + 2);
+    ring->head.storeRelease(head + 1);
+}
+
+QByteArray TraceRecorder::chromeTrace()
+{
+    qint64 sinceUs = sEnabledSinceUs.loadAcquire();
+    QByteArrayList events;
+
+    QMutexLocker lock(&sRingsMutex);
+    for (Ring *ring : sRings)
+    {
+        QString threadName(ring->threadName);
+        events << QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%1,\"args\":{\"name\":\"%2\"}}").arg(
+                      ring->tid).arg(threadName.replace('"', '\'')).toUtf8();
+
+        quint32 head = ring->head.loadAcquire();
+        quint32 nb   = qMin(head, sRingSize);
+        for (quint32 i = head - nb ; i != head ; ++i)
+        {
+            // seqlock read: skipped if the producer is writing it or wrote it meanwhile
+            const TraceSlot &slot = ring->eventSlots[i & (sRingSize - 1)];
+            quint32 seq = slot.seq.loadAcquire();
+            if (seq & 1)
+                continue;
+            Event event{M_LoadAtomic(slot.name), M_LoadAtomic(slot.startUs), M_LoadAtomic(slot.durationUs)};
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (M_LoadAtomic(slot.seq) != seq || !event.name || event.startUs < sinceUs)
+                continue;
+            events << QByteArray("{\"name\":\"") + event.name
+                      + QString("\",\"ph\":\"X\",\"pid\":1,\"tid\":%1,\"ts\":%2,\"dur\":%3}").arg(
+                          ring->tid).arg(event.startUs).arg(event.durationUs).toUtf8();
+        }
+    }
+
+    qDebug() << "[TraceRecorder::chromeTrace] " << events.size() - sRings.size()
+             << " events of " << sRings.size() << " threads";
+    return "{\"traceEvents\":[\n" + events.join(",\n") + "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+bool TraceRecorder::exportChromeTrace(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qCritical() << "[TraceRecorder::exportChromeTrace] can't write " << filePath << ": " << file.errorString();
+        return false;
+    }
+    file.write(chromeTrace());
+    return true;
+}
@@ -0,0 +1,109 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+#include "Macro.h"
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QList>
+#include <QString>
+
+/*!
+ * \brief timeline of the client activity (GUI and ConnectionWorker threads)
+ * to attribute the hitches between the network, protobuf and the models.
+ * Each thread writes its scopes in its own ring buffer (single producer, no lock)
+ * so a disabled recorder only costs an atomic load per trace point.
+ * Each slot is a seqlock: the export skips the events being written instead of reading them torn.
+ * The ring of a finished thread is reused by the next thread that traces something.
+ * Exported in the Chrome trace-event format (chrome://tracing or https://ui.perfetto.dev)
+ */
+class TraceRecorder
+{
+public:
+    typedef struct Event
+    {
+        const char *name; //!< string literal (only the pointer is stored)
+        qint64 startUs;
+        qint64 durationUs;
+    } Event;
+
+    static const quint32 sRingSize = 16384; //!< events kept per thread (power of 2)
+
+    static inline bool isEnabled();
+    static void setEnabled(bool enabled); //!< the events before the last activation are not exported
+    static inline qint64 nowUs();
+
+    static void record(const char *name, qint64 startUs);
+
+    //! snapshot of all the rings (the events overwritten while exporting are skipped)
+    static QByteArray chromeTrace();
+    static bool exportChromeTrace(const QString &filePath);
+
+    TraceRecorder() = delete;
+
+private:
+    struct Ring;
+    struct RingHandle; //!< releases the ring of a thread when it finishes
+    static Ring *newRing(); //!< for the current thread (a released one if any)
+
+    static AtomicBool             sEnabled;
+    static QAtomicInteger<qint64> sEnabledSinceUs;
+    static const QElapsedTimer    sClock;
+
+    static QMutex       sRingsMutex;
+    static QList<Ring*> sRings; //!< one per thread tracing at the same time (reused, kept until the end)
+    static qint64       sNextTid;
+    static thread_local RingHandle tRing;
+};
+
+/*!
+ * \brief records the duration of its scope when the TraceRecorder is enabled
+ */
+class TraceScope
+{
+public:
+    inline TraceScope(const char *name);
+    inline ~TraceScope();
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *_name; //!< nullptr when not recording
+    qint64      _startUs;
+};
+
+#define M_TRACE_SCOPE(name) TraceScope traceScope(name)
+
+bool TraceRecorder::isEnabled() { return M_LoadAtomic(sEnabled); }
+qint64 TraceRecorder::nowUs() { return sClock.nsecsElapsed() / 1000; }
+
+TraceScope::TraceScope(const char *name):
+    _name(TraceRecorder::isEnabled() ? name : nullptr),
+    _startUs(_name ? TraceRecorder::nowUs() : 0)
+{}
+
+TraceScope::~TraceScope()
+{
+    if (_name)
+        TraceRecorder::record(_name, _startUs);
+}
+
+#endif // TRACERECORDER_H
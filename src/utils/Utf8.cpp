@@ -0,0 +1,111 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#include "Utf8.h"
+#include <cstring>
+
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#  define __UTF8_AVX2__
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define __UTF8_SSE2__
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define __UTF8_NEON__
+#endif
+
+QString Utf8::toQString(const char *str, int size)
+{
+    if (size <= 0)
+        return QString();
+    if (static_cast<uchar>(*str) & 0x80)
+        return QString::fromUtf8(str, size); // no ASCII prefix: no need of our buffer
+
+    QString qstr(size, Qt::Uninitialized); // UTF-16 never needs more code units than UTF-8 bytes
+    ushort *dst = reinterpret_cast<ushort*>(qstr.data());
+    int nbAscii = widenAscii(str, size, dst);
+    if (nbAscii == size)
+        return qstr;
+
+    // an ASCII byte can't be part of a multibyte sequence: we can cut there
+    QString tail = QString::fromUtf8(str + nbAscii, size - nbAscii);
+    std::memcpy(dst + nbAscii, tail.constData(), static_cast<size_t>(tail.size()) * sizeof(ushort));
+    qstr.resize(nbAscii + tail.size());
+    qstr.squeeze(); // the multibyte sequences took less code units than bytes: release the extra capacity
+    return qstr;
+}
+
+int Utf8::widenAscii(const char *src, int size, ushort *dst)
+{
+    int i = 0;
+#if defined(__UTF8_AVX2__)
+    for ( ; i + 32 <= size ; i += 32)
+    {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        if (_mm256_movemask_epi8(bytes))
+            break;
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                            _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 16),
+                            _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1)));
+    }
+#endif
+#if defined(__UTF8_SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for ( ; i + 16 <= size ; i += 16)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        if (_mm_movemask_epi8(bytes))
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),     _mm_unpacklo_epi8(bytes, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpackhi_epi8(bytes, zero));
+    }
+#elif defined(__UTF8_NEON__)
+    for ( ; i + 16 <= size ; i += 16)
+    {
+        uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+        uint64x2_t high  = vreinterpretq_u64_u8(vandq_u8(bytes, vdupq_n_u8(0x80)));
+        if (vgetq_lane_u64(high, 0) | vgetq_lane_u64(high, 1))
+            break;
+        vst1q_u16(dst + i,     vmovl_u8(vget_low_u8(bytes)));
+        vst1q_u16(dst + i + 8, vmovl_u8(vget_high_u8(bytes)));
+    }
+#endif
+    // scalar fallback (and remaining bytes), 8 at a time
+    for ( ; i + 8 <= size ; i += 8)
+    {
+        quint64 word;
+        std::memcpy(&word, src + i, sizeof(word));
+        if (word & Q_UINT64_C(0x8080808080808080))
+            break;
+        for (int j = 0 ; j < 8 ; ++j)
+            dst[i + j] = static_cast<uchar>(src[i + j]);
+    }
+    for ( ; i < size ; ++i)
+    {
+        uchar c = static_cast<uchar>(src[i]);
+        if (c & 0x80)
+            break;
+        dst[i] = c;
+    }
+    return i;
+}
@@ -0,0 +1,46 @@
+//========================================================================
+//
+// Copyright (C) 2020 Matthieu Bruel <Matthieu.Bruel@gmail.com>
+// This file is a part of ClementineRemote : https://github.com/mbruel/ClementineRemote
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3..
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>
+//
+//========================================================================
+
+#ifndef UTF8_H
+#define UTF8_H
+#include <QString>
+#include <string>
+
+/*!
+ * \brief conversion of the protobuf strings (UTF-8 std::string) into QString
+ * using their known length (no strlen, embedded NULs kept).
+ * The ASCII prefix (most of the metadata) is widened to UTF-16 with SIMD
+ * (AVX2 / SSE2 / NEON, scalar fallback), the rest is decoded by QString::fromUtf8
+ */
+class Utf8
+{
+public:
+    static QString toQString(const char *str, int size);
+    static inline QString toQString(const std::string &str);
+
+    //! widens the ASCII bytes of src in dst until the first non ASCII one
+    //! returns the number of bytes converted
+    static int widenAscii(const char *src, int size, ushort *dst);
+
+    Utf8() = delete;
+};
+
+QString Utf8::toQString(const std::string &str) { return toQString(str.data(), static_cast<int>(str.size())); }
+
+#endif // UTF8_H